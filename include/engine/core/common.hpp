@@ -41,6 +41,7 @@ using uint64 = uint64_t;
 using secT   = float;
 using milliT = int32_t;
 using microT = int64_t;
+using nanoT  = int64_t;
 
 using byte = uint8_t;
 
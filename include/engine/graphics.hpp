@@ -25,7 +25,23 @@
 
 #include <core/config.hpp>
 
+#include <graphics/glState.hpp>
 #include <graphics/shader.hpp>
+#include <graphics/shaderLibrary.hpp>
+#include <graphics/shaderPreprocessor.hpp>
+#include <graphics/uniformId.hpp>
+#include <graphics/uniformBlock.hpp>
 #include <graphics/gUtils.hpp>
 #include <graphics/mesh.hpp>
 #include <graphics/model.hpp>
+#include <graphics/renderQueue.hpp>
+#include <graphics/instanceBuffer.hpp>
+#include <graphics/streamBuffer.hpp>
+#include <graphics/commandList.hpp>
+#include <graphics/renderThread.hpp>
+#include <graphics/frameGraph.hpp>
+#include <graphics/lightGrid.hpp>
+#include <graphics/gpuProfiler.hpp>
+#include <graphics/bufferAllocator.hpp>
+#include <graphics/geometryPool.hpp>
+#include <graphics/atlasBuilder.hpp>
@@ -0,0 +1,179 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/dstr/vector.hpp>
+
+#include <vector>
+
+#define CURLY_INVALID_ATLAS_REGION 0xFFFFFFFFu
+
+namespace gfx
+{
+/**
+ * @brief Region of an atlas expressed in UV space, uv' = offset + uv * scale
+ * 
+ */
+struct AtlasRegion
+{
+    glm::vec2 offset;
+    glm::vec2 scale;
+};
+
+/**
+ * @brief Remap the UVs of an interleaved vertex buffer (position, normal, uv) into an atlas region
+ * UVs are expected to be in the [0, 1] range, repeating UVs can't be remapped into an atlas
+ * 
+ * @param vertexData 
+ * @param region 
+ */
+CURLY_API void remapUVs(sys::Vector<float>& vertexData, const AtlasRegion& region);
+
+/**
+ * @brief AtlasBuilder Class that packs many small textures into a single one
+ * using a skyline packer, so models using them can share one texture bind
+ * 
+ */
+class CURLY_API AtlasBuilder
+{
+public:
+    /**
+     * @brief Construct a new AtlasBuilder object
+     * 
+     * @param t_width 
+     * @param t_height 
+     * @param t_padding Gutter in texels kept around each texture at the smallest mip level
+     * @param t_mipLevels Number of mip levels the atlas will have (at least 1)
+     */
+    explicit AtlasBuilder(const cfg::uint32 t_width = 2048u, const cfg::uint32 t_height = 2048u, const cfg::uint32 t_padding = 1u, const cfg::uint32 t_mipLevels = 4u);
+    /**
+     * @brief Destroy the AtlasBuilder object and the texture it owns
+     * 
+     */
+    virtual ~AtlasBuilder();
+
+    /**
+     * @brief Add a texture from a path to be packed, returns its region ID
+     * 
+     * @param path 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 addTexture(const char* path);
+    /**
+     * @brief Add a texture from raw pixels to be packed, returns its region ID
+     * 
+     * @param pixels 
+     * @param width 
+     * @param height 
+     * @param nrComponents 
+     * @return cfg::uint32 Region ID or CURLY_INVALID_ATLAS_REGION if the image is empty
+     */
+    cfg::uint32 addTexture(const cfg::uint8* pixels, const cfg::uint32 width, const cfg::uint32 height, const cfg::uint32 nrComponents);
+
+    /**
+     * @brief Pack all the added textures and compose the atlas pixels
+     * 
+     * @return true if every texture fit into the atlas
+     * @return false if not
+     */
+    bool build();
+    /**
+     * @brief Upload the composed atlas to OpenGL and return the texture object
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 upload();
+
+    /**
+     * @brief Get the Region of a packed texture given its ID
+     * 
+     * @param id 
+     * @return const AtlasRegion& 
+     */
+    const AtlasRegion& getRegion(const cfg::uint32 id) const;
+    /**
+     * @brief Get the Texture object created on upload
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getTexture() const;
+    /**
+     * @brief Get the amount of textures added to the atlas
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getTextureCount() const;
+
+private:
+    struct Image
+    {
+        cfg::uint32 width;
+        cfg::uint32 height;
+        cfg::uint32 x;
+        cfg::uint32 y;
+        std::vector<cfg::uint8> pixels;
+    };
+
+    struct SkylineNode
+    {
+        cfg::uint32 x;
+        cfg::uint32 y;
+        cfg::uint32 width;
+    };
+
+    /**
+     * @brief Find the lowest place to put a rect in the skyline, returns false if it doesn't fit
+     * 
+     */
+    bool findPosition(const cfg::uint32 width, const cfg::uint32 height, cfg::uint32& bestIndex, cfg::uint32& bestX, cfg::uint32& bestY) const;
+    /**
+     * @brief Insert a placed rect in the skyline and merge the levels
+     * 
+     */
+    void addSkylineLevel(const cfg::uint32 index, const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 width, const cfg::uint32 height);
+    /**
+     * @brief Copy an image into the atlas extruding its borders into the gutter
+     * 
+     */
+    void blitImage(const Image& image);
+
+    cfg::uint32 m_width;
+    cfg::uint32 m_height;
+    cfg::uint32 m_gutter;
+    cfg::uint32 m_alignment;
+    cfg::uint32 m_mipLevels;
+    cfg::uint32 m_texture;
+
+    std::vector<Image> m_images;
+    std::vector<AtlasRegion> m_regions;
+    std::vector<SkylineNode> m_skyline;
+    std::vector<cfg::uint8> m_pixels;
+};
+
+} // namespace gfx
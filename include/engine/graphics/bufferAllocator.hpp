@@ -0,0 +1,209 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <vector>
+
+#define CURLY_INVALID_ALLOCATION 0xFFFFFFFFu
+
+#define CURLY_TLSF_SL_LOG2 4
+#define CURLY_TLSF_SL_COUNT (1u << CURLY_TLSF_SL_LOG2)
+#define CURLY_TLSF_FL_COUNT (32 - CURLY_TLSF_SL_LOG2 + 1)
+
+#define CURLY_BUFFER_COMPACT_VISIT_COST 16u
+
+namespace gfx
+{
+/**
+ * @brief Range handed out by a BufferAllocator, in the units the allocator was built with
+ * 
+ */
+struct BufferAllocation
+{
+    cfg::uint32 handle;
+    cfg::uint32 offset;
+    cfg::uint32 size;
+};
+
+/**
+ * @brief Relocation produced by a compaction step, to be replayed on the GPU in order
+ * 
+ */
+struct BufferMove
+{
+    cfg::uint32 handle;
+    cfg::uint32 srcOffset;
+    cfg::uint32 dstOffset;
+    cfg::uint32 size;
+};
+
+/**
+ * @brief Occupancy snapshot of a BufferAllocator
+ * 
+ */
+struct BufferAllocatorStats
+{
+    cfg::uint32 totalSize;
+    cfg::uint32 usedSize;
+    cfg::uint32 freeSize;
+    cfg::uint32 largestFreeBlock;
+    cfg::uint32 freeBlockCount;
+    cfg::uint32 allocationCount;
+    /**
+     * @brief 0 when all free space is contiguous, close to 1 when it is scattered
+     * 
+     */
+    float fragmentation;
+};
+
+/**
+ * @brief BufferAllocator Class that manages ranges inside a large buffer with a
+ * two-level segregated fit (TLSF) scheme, so alloc and free are O(1)
+ * It doesn't touch GL at all, relocations are returned as BufferMove lists
+ * 
+ */
+class CURLY_API BufferAllocator
+{
+public:
+    /**
+     * @brief Construct a new BufferAllocator object
+     * 
+     * @param t_size Size of the managed range
+     */
+    explicit BufferAllocator(const cfg::uint32 t_size);
+    /**
+     * @brief Destroy the BufferAllocator object
+     * 
+     */
+    virtual ~BufferAllocator();
+
+    /**
+     * @brief Allocate a range, its handle is CURLY_INVALID_ALLOCATION if it doesn't fit
+     * 
+     * @param size 
+     * @param alignment Power of two the offset must be a multiple of
+     * @return BufferAllocation 
+     */
+    BufferAllocation allocate(const cfg::uint32 size, const cfg::uint32 alignment = 1);
+    /**
+     * @brief Release a range and merge it with its free neighbours
+     * 
+     * @param handle 
+     */
+    void free(const cfg::uint32 handle);
+
+    /**
+     * @brief Run a compaction step, moving allocations from the end of the range into lower holes
+     * A cursor walks down from the end across calls, each allocation it meets looks for a hole
+     * below it through the free lists, so a step never rescans the range
+     * Every move targets free space, so replaying them in order never overlaps
+     * 
+     * @param moves Output list, cleared first
+     * @param maxSize Budget of the step, moved size plus CURLY_BUFFER_COMPACT_VISIT_COST per node
+     * inspected, at least one node is handled per step, 0 means unbounded
+     * @return cfg::uint32 Moved size
+     */
+    cfg::uint32 compact(std::vector<BufferMove>& moves, const cfg::uint32 maxSize = 0);
+    /**
+     * @brief Check whether compaction is done, it is reset by every allocate and free
+     * 
+     * @return true once a full pass found nothing to move or the free space is contiguous
+     */
+    bool isCompacted() const;
+
+    /**
+     * @brief Get the current Offset of an allocation
+     * 
+     * @param handle 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getOffset(const cfg::uint32 handle) const;
+    /**
+     * @brief Get the Size of an allocation
+     * 
+     * @param handle 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getSize(const cfg::uint32 handle) const;
+    /**
+     * @brief Get the Stats of the allocator
+     * 
+     * @return BufferAllocatorStats 
+     */
+    BufferAllocatorStats getStats() const;
+
+private:
+    struct Node
+    {
+        cfg::uint32 offset;
+        cfg::uint32 size;
+        cfg::uint32 alignment;
+        cfg::uint32 handle;
+        cfg::uint32 prevPhys;
+        cfg::uint32 nextPhys;
+        cfg::uint32 prevFree;
+        cfg::uint32 nextFree;
+        bool used;
+    };
+
+    cfg::uint32 newNode();
+    void releaseNode(const cfg::uint32 index);
+
+    void insertFree(const cfg::uint32 index);
+    void removeFree(const cfg::uint32 index);
+    cfg::uint32 findFree(const cfg::uint32 size) const;
+    cfg::uint32 findHoleBelow(const cfg::uint32 index, cfg::uint64& work) const;
+    bool isPacked() const;
+    void advanceCursor();
+
+    cfg::uint32 carve(const cfg::uint32 index, const cfg::uint32 size, const cfg::uint32 alignment);
+    void release(cfg::uint32 index);
+
+    static void mapping(const cfg::uint32 size, cfg::uint32& fl, cfg::uint32& sl);
+    static bool searchMapping(const cfg::uint32 size, cfg::uint32& fl, cfg::uint32& sl);
+
+    cfg::uint32 m_size;
+    cfg::uint32 m_usedSize;
+    cfg::uint32 m_freeBlockCount;
+    cfg::uint32 m_firstNode;
+    cfg::uint32 m_lastNode;
+
+    cfg::uint32 m_compactCursor;
+    bool m_compactPassMoved;
+    bool m_compacted;
+
+    cfg::uint32 m_flBitmap;
+    cfg::uint32 m_slBitmaps[CURLY_TLSF_FL_COUNT];
+    cfg::uint32 m_heads[CURLY_TLSF_FL_COUNT][CURLY_TLSF_SL_COUNT];
+
+    std::vector<Node> m_nodes;
+    std::vector<cfg::uint32> m_freeNodes;
+    std::vector<cfg::uint32> m_handles;
+    std::vector<cfg::uint32> m_freeHandles;
+};
+
+} // namespace gfx
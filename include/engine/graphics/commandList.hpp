@@ -0,0 +1,317 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <graphics/uniformId.hpp>
+
+#include <span>
+#include <memory>
+#include <vector>
+
+#define CURLY_COMMAND_ARENA_BLOCK_SIZE (64u * 1024u)
+#define CURLY_DRAW_MAX_TEXTURES 8u
+
+namespace gfx
+{
+class Mesh;
+class Shader;
+
+/**
+ * @brief Opcode of a recorded command, it tells which payload struct follows it
+ * 
+ */
+enum class CommandType : cfg::uint8
+{
+    USE_PROGRAM,
+    BIND_TEXTURE,
+    SET_INT,
+    SET_FLOAT,
+    SET_VEC3,
+    SET_MAT4,
+    DRAW
+};
+
+struct UseProgramCommand
+{
+    cfg::uint32 program;
+};
+
+struct BindTextureCommand
+{
+    cfg::uint32 unit;
+    cfg::uint32 texture;
+};
+
+struct SetIntCommand
+{
+    cfg::uint32 program;
+    cfg::int32 location;
+    cfg::int32 value;
+};
+
+struct SetFloatCommand
+{
+    cfg::uint32 program;
+    cfg::int32 location;
+    float value;
+};
+
+struct SetVec3Command
+{
+    cfg::uint32 program;
+    cfg::int32 location;
+    float value[3];
+};
+
+struct SetMat4Command
+{
+    cfg::uint32 program;
+    cfg::int32 location;
+    float value[16];
+};
+
+enum class DrawUniformType : cfg::uint8
+{
+    INT,
+    FLOAT,
+    VEC3,
+    MAT4
+};
+
+/**
+ * @brief Uniform value carried by a draw packet, made with CommandList::makeUniform
+ * 
+ */
+struct DrawUniform
+{
+    cfg::int32 location;
+    DrawUniformType type;
+    union
+    {
+        cfg::int32 intValue;
+        float floatValues[16];
+    };
+};
+
+/**
+ * @brief Self-contained draw packet, it binds its own program, textures and uniforms
+ * so it renders the same wherever a key sort moves it
+ * 
+ */
+struct DrawCommand
+{
+    cfg::uint32 program;
+    cfg::uint32 vertexArray;
+    cfg::uint32 indexCount;
+    cfg::int32 modelLocation;
+    float model[16];
+    cfg::uint32 textureCount;
+    cfg::uint32 textures[CURLY_DRAW_MAX_TEXTURES];
+    cfg::uint32 uniformCount;
+    /**
+     * @brief Uniform values stored in the same arena as the packet
+     * 
+     */
+    const DrawUniform* uniforms;
+};
+
+/**
+ * @brief A recorded command, the payload lives in the arena of the list that owns it
+ * 
+ */
+struct Command
+{
+    CommandType type;
+    const void* payload;
+    cfg::uint64 key;
+};
+
+/**
+ * @brief CommandList Class that records platform-neutral commands into a linear arena
+ * to replay them later, possibly on another thread that owns the GL context
+ * Commands are plain data, an opcode and a payload of GL object names and uniform locations
+ * resolved while recording, so no engine object is referenced once a command is recorded,
+ * the objects those names belong to only need to outlive the frame
+ * A list is not thread-safe, but every worker can record its own list and the
+ * results are merged in a deterministic order on the submitting thread
+ * State commands affect everything replayed after them, so only lists made of draw
+ * packets alone can be sorted by key when merged
+ * 
+ */
+class CURLY_API CommandList
+{
+public:
+    /**
+     * @brief Construct a new CommandList object
+     * 
+     * @param t_blockSize Size of every arena block in bytes
+     */
+    explicit CommandList(const cfg::uint64 t_blockSize = CURLY_COMMAND_ARENA_BLOCK_SIZE);
+    /**
+     * @brief Destroy the CommandList object
+     * 
+     */
+    virtual ~CommandList();
+
+    /**
+     * @brief Record a shader bind
+     * 
+     * @param shader 
+     */
+    void useShader(const Shader& shader);
+    /**
+     * @brief Record a 2D texture bind
+     * 
+     * @param unit 
+     * @param texture 
+     */
+    void bindTexture(const cfg::uint32 unit, const cfg::uint32 texture);
+    /**
+     * @brief Record an int uniform update
+     * 
+     * @param shader 
+     * @param id 
+     * @param value 
+     */
+    void setInt(const Shader& shader, const UniformId id, const cfg::int32 value);
+    /**
+     * @brief Record a float uniform update
+     * 
+     * @param shader 
+     * @param id 
+     * @param value 
+     */
+    void setFloat(const Shader& shader, const UniformId id, const float value);
+    /**
+     * @brief Record a vec3 uniform update
+     * 
+     * @param shader 
+     * @param id 
+     * @param value 
+     */
+    void setVec3(const Shader& shader, const UniformId id, const glm::vec3& value);
+    /**
+     * @brief Record a mat4 uniform update
+     * 
+     * @param shader 
+     * @param id 
+     * @param value 
+     */
+    void setMat4(const Shader& shader, const UniformId id, const glm::mat4& value);
+    /**
+     * @brief Record a self-contained draw packet of a mesh
+     * The packet binds its shader and its textures to units 0 to N - 1 and sets its uniforms
+     * and model matrix, uniforms it doesn't set keep the last value set on that program
+     * 
+     * @param mesh 
+     * @param shader 
+     * @param transform 
+     * @param key Sort key used when merging with sortByKey, e.g. a RenderQueue key
+     * @param textures At most CURLY_DRAW_MAX_TEXTURES texture names
+     * @param uniforms 
+     */
+    void draw(const Mesh& mesh, const Shader& shader, const glm::mat4& transform, const cfg::uint64 key = 0,
+              std::span<const cfg::uint32> textures = {}, std::span<const DrawUniform> uniforms = {});
+
+    /**
+     * @brief Make a uniform value for a draw packet
+     * 
+     * @param shader 
+     * @param id 
+     * @param value 
+     * @return DrawUniform 
+     */
+    static DrawUniform makeUniform(const Shader& shader, const UniformId id, const cfg::int32 value);
+    static DrawUniform makeUniform(const Shader& shader, const UniformId id, const float value);
+    static DrawUniform makeUniform(const Shader& shader, const UniformId id, const glm::vec3& value);
+    static DrawUniform makeUniform(const Shader& shader, const UniformId id, const glm::mat4& value);
+
+    /**
+     * @brief Append the commands of other lists, in the given order, taking over their arenas
+     * The sources are left empty and get this list's spare arena blocks in exchange,
+     * so memory is recycled frame to frame instead of reallocated
+     * 
+     * @param lists Lists to merge, typically one per worker ordered by visible-set slice
+     * @param sortByKey Stable sort of the whole list by key after merging, it is refused
+     * (keeping the merge order) if the list holds anything but draw packets
+     */
+    void merge(std::span<CommandList* const> lists, const bool sortByKey = false);
+
+    /**
+     * @brief Drop the recorded commands and rewind the arena, keeping its memory
+     * 
+     */
+    void clear();
+
+    /**
+     * @brief Get the recorded Commands in replay order
+     * 
+     * @return std::span<const Command> 
+     */
+    std::span<const Command> getCommands() const;
+    /**
+     * @brief Get the Command Count
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getCommandCount() const;
+    /**
+     * @brief Check if nothing was recorded
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isEmpty() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<cfg::byte[]> data;
+        cfg::uint64 size;
+    };
+
+    template <typename T>
+    void push(const CommandType type, const T& payload, const cfg::uint64 key);
+
+    void* allocate(const cfg::uint64 size, const cfg::uint64 alignment);
+
+    cfg::uint64 m_blockSize;
+    cfg::uint64 m_block;
+    cfg::uint64 m_head;
+
+    std::vector<Block> m_blocks;
+    std::vector<Command> m_commands;
+
+    CommandList(const CommandList&) = delete;
+    CommandList& operator=(const CommandList&) = delete;
+};
+
+} // namespace gfx
+
+#include <graphics/commandList.inl>
@@ -0,0 +1,39 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <cstring>
+#include <type_traits>
+
+namespace gfx
+{
+template <typename T>
+inline void CommandList::push(const CommandType type, const T& payload, const cfg::uint64 key)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Command payloads must be plain data");
+
+    void* storage {allocate(sizeof(T), alignof(T))};
+    std::memcpy(storage, &payload, sizeof(T));
+    m_commands.push_back({type, storage, key});
+}
+
+} // namespace gfx
@@ -0,0 +1,283 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#define CURLY_INVALID_FRAME_GRAPH_RESOURCE 0xFFFFFFFFu
+#define CURLY_FRAME_GRAPH_POOL_FRAMES 3u
+#define CURLY_FRAME_GRAPH_MAX_COLOR_ATTACHMENTS 8u
+
+namespace gfx
+{
+class FrameGraph;
+class GpuProfiler;
+
+using FrameGraphResource = cfg::uint32;
+
+/**
+ * @brief Description of a render target, format is a sized GL internal format (GL_RGBA16F, GL_DEPTH24_STENCIL8, ...)
+ * 
+ */
+struct FrameGraphTextureDesc
+{
+    cfg::uint32 width;
+    cfg::uint32 height;
+    cfg::uint32 format;
+};
+
+/**
+ * @brief Counters of the last compiled frame
+ * 
+ */
+struct FrameGraphStats
+{
+    cfg::uint32 passCount;
+    cfg::uint32 culledPassCount;
+    cfg::uint32 transientTextureCount;
+    cfg::uint32 physicalTextureCount;
+    cfg::uint32 pooledTextureCount;
+};
+
+/**
+ * @brief FrameGraphBuilder Class handed to pass setup functions to declare their resources
+ * 
+ */
+class CURLY_API FrameGraphBuilder
+{
+public:
+    /**
+     * @brief Declare a transient render target, its memory is owned and aliased by the graph
+     * 
+     * @param name 
+     * @param desc 
+     * @return FrameGraphResource 
+     */
+    FrameGraphResource create(const char* name, const FrameGraphTextureDesc& desc);
+    /**
+     * @brief Declare that the pass reads a resource
+     * 
+     * @param resource 
+     * @return FrameGraphResource 
+     */
+    FrameGraphResource read(const FrameGraphResource resource);
+    /**
+     * @brief Declare that the pass writes a resource, written textures become its attachments
+     * 
+     * @param resource 
+     * @return FrameGraphResource 
+     */
+    FrameGraphResource write(const FrameGraphResource resource);
+    /**
+     * @brief Keep the pass even if nothing reads what it writes
+     * 
+     */
+    void setSideEffect();
+
+private:
+    friend class FrameGraph;
+
+    FrameGraphBuilder(FrameGraph& t_graph, const cfg::uint32 t_pass);
+
+    FrameGraph& m_graph;
+    const cfg::uint32 m_pass;
+};
+
+/**
+ * @brief FrameGraph Class that schedules the render passes of a frame
+ * Passes declare what they read and write, passes whose results are never consumed are culled,
+ * and transient render targets whose lifetimes don't overlap share pooled textures, so
+ * render target memory stays bounded by the peak of simultaneously live targets
+ * Surviving passes run in declaration order, which is the dependency order the builder records
+ * 
+ */
+class CURLY_API FrameGraph
+{
+public:
+    using SetupFunction = std::function<void(FrameGraphBuilder&)>;
+    using ExecuteFunction = std::function<void(const FrameGraph&)>;
+
+    /**
+     * @brief Construct a new FrameGraph object
+     * 
+     */
+    FrameGraph();
+    /**
+     * @brief Destroy the FrameGraph object and its pooled textures and framebuffers
+     * 
+     */
+    virtual ~FrameGraph();
+
+    /**
+     * @brief Import an externally owned texture, texture 0 stands for the default framebuffer
+     * Passes writing imported resources are never culled
+     * 
+     * @param name 
+     * @param texture 
+     * @param desc 
+     * @return FrameGraphResource 
+     */
+    FrameGraphResource importTexture(const char* name, const cfg::uint32 texture, const FrameGraphTextureDesc& desc);
+    /**
+     * @brief Import an externally owned buffer, used for dependency tracking only
+     * 
+     * @param name 
+     * @param buffer 
+     * @return FrameGraphResource 
+     */
+    FrameGraphResource importBuffer(const char* name, const cfg::uint32 buffer);
+
+    /**
+     * @brief Add a pass, the setup function is called right away
+     * 
+     * @param name 
+     * @param setup 
+     * @param execute Called with the pass attachments bound and the viewport set
+     */
+    void addPass(const char* name, const SetupFunction& setup, ExecuteFunction execute);
+
+    /**
+     * @brief Cull unused passes, compute lifetimes and assign pooled textures to transient targets
+     * 
+     */
+    void compile();
+    /**
+     * @brief Run the surviving passes, then recycle pool entries unused for a few frames
+     * 
+     */
+    void execute();
+    /**
+     * @brief Forget the passes and resources to start declaring a new frame, pools are kept
+     * 
+     */
+    void reset();
+
+    /**
+     * @brief Get the GL Texture of a texture resource, valid while executing
+     * 
+     * @param resource 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getTexture(const FrameGraphResource resource) const;
+    /**
+     * @brief Get the GL Buffer of a buffer resource
+     * 
+     * @param resource 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getBuffer(const FrameGraphResource resource) const;
+    /**
+     * @brief Get the Desc of a texture resource
+     * 
+     * @param resource 
+     * @return const FrameGraphTextureDesc& 
+     */
+    const FrameGraphTextureDesc& getDesc(const FrameGraphResource resource) const;
+    /**
+     * @brief Get the Stats of the last compiled frame
+     * 
+     * @return FrameGraphStats 
+     */
+    FrameGraphStats getStats() const;
+    /**
+     * @brief Time every executed pass as a GPU zone named after it
+     * 
+     * @param profiler nullptr to stop timing
+     */
+    void setGpuProfiler(GpuProfiler* profiler);
+
+private:
+    friend class FrameGraphBuilder;
+
+    enum ResourceKind : cfg::uint8
+    {
+        TRANSIENT_TEXTURE,
+        IMPORTED_TEXTURE,
+        IMPORTED_BUFFER
+    };
+
+    struct Resource
+    {
+        std::string name;
+        ResourceKind kind;
+        FrameGraphTextureDesc desc;
+        cfg::uint32 handle;
+        std::vector<cfg::uint32> writers;
+        cfg::uint32 refCount;
+        cfg::uint32 firstUse;
+        cfg::uint32 lastUse;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<FrameGraphResource> reads;
+        std::vector<FrameGraphResource> writes;
+        cfg::uint32 refCount;
+        bool sideEffect;
+    };
+
+    struct PooledTexture
+    {
+        FrameGraphTextureDesc desc;
+        cfg::uint32 texture;
+        cfg::uint64 lastFrame;
+        bool taken;
+    };
+
+    struct Framebuffer
+    {
+        std::vector<cfg::uint32> attachments;
+        cfg::uint32 fbo;
+        cfg::uint64 lastFrame;
+    };
+
+    FrameGraphResource addResource(const char* name, const ResourceKind kind, const FrameGraphTextureDesc& desc, const cfg::uint32 handle);
+
+    cfg::uint32 acquireTexture(const FrameGraphTextureDesc& desc);
+    cfg::uint32 getFramebuffer(const std::vector<cfg::uint32>& attachments, const std::vector<cfg::uint32>& formats);
+    void trimPools();
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<cfg::uint32> m_order;
+
+    std::vector<PooledTexture> m_texturePool;
+    std::vector<Framebuffer> m_framebuffers;
+
+    cfg::uint64 m_frame;
+    FrameGraphStats m_stats;
+    GpuProfiler* m_gpuProfiler;
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+};
+
+} // namespace gfx
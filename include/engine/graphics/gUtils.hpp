@@ -31,6 +31,7 @@
 #include <system/dstr/vector.hpp>
 
 #include <graphics/shader.hpp>
+#include <graphics/uniformBlock.hpp>
 
 namespace gfx
 {
@@ -62,4 +63,17 @@ CURLY_API cfg::uint32 loadTexture(const char* path);
  */
 CURLY_API void setupDefaultLights(Shader& shader, const glm::vec3& viewPos = {2.0f, 4.0f, 2.0f});
 
+/**
+ * @brief Get the Default Lights as the data of a LightsBlock
+ * 
+ * @return LightsData 
+ */
+CURLY_API LightsData getDefaultLights();
+/**
+ * @brief Setup the Default Lights once into the shared LightsBlock read by every shader
+ * 
+ * @param lightsBlock 
+ */
+CURLY_API void setupDefaultLights(UniformBlock& lightsBlock);
+
 } // namespace gfx
@@ -0,0 +1,213 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/dstr/vector.hpp>
+
+#include <graphics/shader.hpp>
+#include <graphics/instanceBuffer.hpp>
+#include <graphics/bufferAllocator.hpp>
+
+#include <vector>
+
+#define CURLY_INVALID_GEOMETRY 0xFFFFFFFFu
+
+namespace gfx
+{
+/**
+ * @brief Location of a mesh inside the shared buffers of a GeometryPool
+ * 
+ */
+struct GeometryRange
+{
+    cfg::uint32 baseVertex;
+    cfg::uint32 vertexCount;
+    cfg::uint32 firstIndex;
+    cfg::uint32 indexCount;
+};
+
+/**
+ * @brief Command layout consumed by glMultiDrawElementsIndirect
+ * 
+ */
+struct DrawElementsIndirectCommand
+{
+    cfg::uint32 count;
+    cfg::uint32 instanceCount;
+    cfg::uint32 firstIndex;
+    cfg::int32  baseVertex;
+    cfg::uint32 baseInstance;
+};
+
+/**
+ * @brief GeometryPool Class that sub-allocates static meshes of the engine vertex format
+ * (position, normal, uv) into shared vertex and index buffers behind a single VAO,
+ * and submits the visible ones with one glMultiDrawElementsIndirect
+ * 
+ */
+class CURLY_API GeometryPool
+{
+public:
+    /**
+     * @brief Construct a new GeometryPool object
+     * 
+     * @param t_vertexCapacity Number of vertices the pool can hold
+     * @param t_indexCapacity Number of indices the pool can hold
+     */
+    GeometryPool(const cfg::uint32 t_vertexCapacity = 1u << 20, const cfg::uint32 t_indexCapacity = 1u << 22);
+    /**
+     * @brief Destroy the GeometryPool object
+     * 
+     */
+    virtual ~GeometryPool();
+
+    /**
+     * @brief Add a mesh to the pool from interleaved vertex data and indices
+     * 
+     * @param vertexData 
+     * @param indices 
+     * @return cfg::uint32 Geometry ID or CURLY_INVALID_GEOMETRY if the pool is full
+     */
+    cfg::uint32 add(const sys::Vector<float>& vertexData, const sys::Vector<cfg::uint32>& indices);
+    /**
+     * @brief Add a mesh to the pool from an OBJ file path
+     * 
+     * @param path 
+     * @param hasNormals 
+     * @param hasUVs 
+     * @return cfg::uint32 Geometry ID or CURLY_INVALID_GEOMETRY if the pool is full
+     */
+    cfg::uint32 add(const char* path, bool hasNormals = true, bool hasUVs = true);
+    /**
+     * @brief Remove a mesh from the pool, its ID may be reused by later adds
+     * 
+     * @param geometryID 
+     */
+    void remove(const cfg::uint32 geometryID);
+    /**
+     * @brief Run an incremental compaction step over both shared buffers
+     * Moved ranges are copied on the GPU and the geometry ranges are updated
+     * 
+     * @param maxVertices Budget of moved vertices for this step, 0 means unbounded
+     * @param maxIndices Budget of moved indices for this step, 0 derives it from maxVertices
+     */
+    void compact(const cfg::uint32 maxVertices = 0, const cfg::uint32 maxIndices = 0);
+
+    /**
+     * @brief Record a visible instance of a geometry for the next submit
+     * Invalid or removed IDs are rejected
+     * 
+     * @param geometryID 
+     * @param transform 
+     */
+    void draw(const cfg::uint32 geometryID, const glm::mat4& transform);
+    /**
+     * @brief Build the indirect commands of the recorded draws and issue them in a single call
+     * Instances of the same geometry are merged into one command, the shader reads
+     * the transform from the instanceModel attribute and textures must be already bound
+     * 
+     * @param shader 
+     * @param instances 
+     */
+    void submit(const Shader& shader, InstanceBuffer& instances);
+
+    /**
+     * @brief Get the Range of a geometry
+     * 
+     * @param geometryID 
+     * @return const GeometryRange& 
+     */
+    const GeometryRange& getRange(const cfg::uint32 geometryID) const;
+    /**
+     * @brief Get the Vertex Stats of the pool
+     * 
+     * @return BufferAllocatorStats 
+     */
+    BufferAllocatorStats getVertexStats() const;
+    /**
+     * @brief Get the Index Stats of the pool
+     * 
+     * @return BufferAllocatorStats 
+     */
+    BufferAllocatorStats getIndexStats() const;
+    /**
+     * @brief Check whether an ID refers to a geometry currently in the pool
+     * 
+     * @param geometryID 
+     * @return true 
+     * @return false 
+     */
+    bool isValid(const cfg::uint32 geometryID) const;
+
+private:
+    /**
+     * @brief Replay compaction moves on a GL buffer with glCopyBufferSubData
+     * 
+     * @param buffer GL buffer name
+     * @param moves 
+     * @param unitSize Size in bytes of one allocator unit
+     */
+    static void applyBufferMoves(const cfg::uint32 buffer, const std::vector<BufferMove>& moves, const cfg::uint32 unitSize);
+
+    struct Slot
+    {
+        cfg::uint32 vertexHandle;
+        cfg::uint32 indexHandle;
+    };
+
+    struct DrawRecord
+    {
+        cfg::uint32 geometryID;
+        cfg::uint32 transformIndex;
+    };
+
+    cfg::uint32 m_VAO;
+    cfg::uint32 m_VBO;
+    cfg::uint32 m_EBO;
+    cfg::uint32 m_indirectBuffer;
+
+    BufferAllocator m_vertexAllocator;
+    BufferAllocator m_indexAllocator;
+
+    std::vector<GeometryRange> m_ranges;
+    std::vector<Slot> m_slots;
+    std::vector<cfg::uint32> m_freeIDs;
+    std::vector<cfg::uint32> m_vertexOwners;
+    std::vector<cfg::uint32> m_indexOwners;
+    std::vector<BufferMove> m_moves;
+    std::vector<DrawRecord> m_draws;
+    std::vector<glm::mat4> m_transforms;
+    std::vector<glm::mat4> m_instanceTransforms;
+    std::vector<DrawElementsIndirectCommand> m_commands;
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+};
+
+} // namespace gfx
@@ -0,0 +1,129 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#define CURLY_MAX_TEXTURE_UNITS 32
+#define CURLY_TRACKED_TEXTURE_TARGETS 5
+
+namespace gfx
+{
+/**
+ * @brief Counters of the state changes requested through GLState
+ * 
+ */
+struct GLStateStats
+{
+    cfg::uint64 requested;
+    cfg::uint64 skipped;
+};
+
+/**
+ * @brief GLState Class that shadows the OpenGL state of the current context
+ * and filters redundant state changes before they reach the driver
+ * Any code touching the tracked state directly must call invalidate afterwards
+ * 
+ */
+class CURLY_API GLState final
+{
+public:
+    static void useProgram(const cfg::uint32 program);
+    static void bindVertexArray(const cfg::uint32 vertexArray);
+    static void activeTexture(const cfg::uint32 unit);
+    static void bindTexture(const cfg::uint32 target, const cfg::uint32 texture);
+    static void bindTexture(const cfg::uint32 unit, const cfg::uint32 target, const cfg::uint32 texture);
+
+    static void setBlend(const bool enabled);
+    static void setBlendFunc(const cfg::uint32 srcFactor, const cfg::uint32 dstFactor);
+    static void setDepthTest(const bool enabled);
+    static void setDepthMask(const bool enabled);
+    static void setDepthFunc(const cfg::uint32 func);
+
+    /**
+     * @brief Must be called when a program is deleted, so a new one reusing its name is not skipped
+     * 
+     * @param program 
+     */
+    static void releaseProgram(const cfg::uint32 program);
+    /**
+     * @brief Must be called when a vertex array is deleted, GL unbinds it if it was bound
+     * 
+     * @param vertexArray 
+     */
+    static void releaseVertexArray(const cfg::uint32 vertexArray);
+    /**
+     * @brief Must be called when a texture is deleted, GL unbinds it from every unit
+     * 
+     * @param texture 
+     */
+    static void releaseTexture(const cfg::uint32 texture);
+
+    /**
+     * @brief Forget the whole shadow state, the next request of each state will reach the driver
+     * Needed after switching contexts or after calling GL directly
+     * 
+     */
+    static void invalidate();
+
+    /**
+     * @brief Get the Stats of requested and skipped state changes
+     * 
+     * @return GLStateStats 
+     */
+    static GLStateStats getStats();
+    /**
+     * @brief Reset the Stats counters
+     * 
+     */
+    static void resetStats();
+
+private:
+    /**
+     * @brief Check if a cached value already matches, otherwise update it
+     * 
+     * @return true if the change must be issued
+     */
+    static bool change(cfg::uint32& cached, const cfg::uint32 value);
+    static cfg::int32 getTargetIndex(const cfg::uint32 target);
+
+    static cfg::uint32 s_program;
+    static cfg::uint32 s_vertexArray;
+    static cfg::uint32 s_activeUnit;
+    static cfg::uint32 s_textures[CURLY_MAX_TEXTURE_UNITS][CURLY_TRACKED_TEXTURE_TARGETS];
+
+    static cfg::uint32 s_blend;
+    static cfg::uint32 s_blendSrc;
+    static cfg::uint32 s_blendDst;
+    static cfg::uint32 s_depthTest;
+    static cfg::uint32 s_depthMask;
+    static cfg::uint32 s_depthFunc;
+
+    static GLStateStats s_stats;
+
+    GLState() = delete;
+};
+
+} // namespace gfx
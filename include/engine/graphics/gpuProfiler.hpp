@@ -0,0 +1,224 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/profiler.hpp>
+#include <system/frameStats.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#define CURLY_GPU_PROFILER_LATENCY 3u
+
+#if defined(C__CURLY_PROFILER)
+    #define CURLY_GPU_PROFILE_SCOPE(profiler, name) const ::gfx::GpuProfileZone CURLY_PROFILE_CONCAT(curlyGpuProfileZone, __LINE__) {profiler, name}
+#else
+    #define CURLY_GPU_PROFILE_SCOPE(profiler, name) static_cast<void>(0)
+#endif
+
+namespace gfx
+{
+/**
+ * @brief A resolved GPU zone, times are on the sys::Clock timeline
+ * 
+ */
+struct GpuZoneResult
+{
+    const char* name;
+    cfg::nanoT begin;
+    cfg::nanoT end;
+    cfg::uint32 depth;
+};
+
+/**
+ * @brief A GPU zone still waiting for its queries
+ * 
+ */
+struct GpuQueryZone
+{
+    const char* name;
+    cfg::uint32 beginQuery;
+    cfg::uint32 endQuery;
+    cfg::uint32 depth;
+};
+
+/**
+ * @brief The queries of one frame in flight
+ * 
+ */
+struct GpuQueryFrame
+{
+    std::vector<cfg::uint32> queries;
+    std::vector<GpuQueryZone> zones;
+    cfg::uint32 usedQueries;
+    cfg::int64 clockOffset;
+    cfg::uint64 statsFrame;
+    bool pending;
+};
+
+/**
+ * @brief GpuProfiler Class that times passes and draws with GL_TIMESTAMP queries
+ * Each zone writes a timestamp when it opens and another when it closes, so zones nest freely
+ * The queries of a frame are read CURLY_GPU_PROFILER_LATENCY frames later, when the GPU is
+ * long done with them, and the pools are reused, so profiling never stalls the pipeline
+ * Every frame the GL clock is sampled next to sys::Clock, which moves the results onto the
+ * CPU timeline: they show up as a "GPU" track in the sys::Profiler trace and as the GPU time of
+ * the matching frame in sys::FrameStats
+ * Timer queries are core since GL 3.3, which Mesa llvmpipe and softpipe implement
+ * 
+ */
+class CURLY_API GpuProfiler
+{
+public:
+    /**
+     * @brief Construct a new GpuProfiler object
+     * 
+     * @param t_latency Frames between submitting a query and reading it back
+     */
+    explicit GpuProfiler(const cfg::uint32 t_latency = CURLY_GPU_PROFILER_LATENCY);
+    /**
+     * @brief Destroy the GpuProfiler object
+     * 
+     */
+    virtual ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /**
+     * @brief Resolve the oldest frame in flight if its queries are ready and open a new one
+     * 
+     */
+    void beginFrame();
+    /**
+     * @brief Close the current frame
+     * 
+     */
+    void endFrame();
+
+    /**
+     * @brief Open a zone, it must be closed before the frame ends
+     * 
+     * @param t_name must outlive the profiler, string literals are the expected use
+     */
+    void beginZone(const char* t_name);
+    /**
+     * @brief Open a zone with a runtime name, the name is interned once
+     * 
+     * @param t_name 
+     */
+    void beginZone(const std::string& t_name);
+    /**
+     * @brief Close the innermost open zone
+     * 
+     */
+    void endZone();
+
+    /**
+     * @brief Report the GPU frame times to a FrameStats
+     * Each GPU frame is matched with the last frame recorded when it began
+     * 
+     * @param t_frameStats 
+     */
+    void setFrameStats(sys::FrameStats& t_frameStats);
+
+    /**
+     * @brief Get the zones of the last resolved frame, the whole frame comes first
+     * 
+     * @return const std::vector<GpuZoneResult>& 
+     */
+    const std::vector<GpuZoneResult>& getResults() const;
+    /**
+     * @brief Get the GPU time of the last resolved frame
+     * 
+     * @return cfg::nanoT 
+     */
+    cfg::nanoT getFrameTime() const;
+    /**
+     * @brief Get the number of frames dropped because their queries were not ready when read back
+     * Those frames are never waited on, raise the latency if the count keeps growing
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getStallCount() const;
+    /**
+     * @brief Check whether the context can time queries
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isSupported() const;
+
+private:
+    cfg::uint32 acquireQuery(GpuQueryFrame& t_frame);
+    void resolve(GpuQueryFrame& t_frame);
+
+    std::vector<GpuQueryFrame> m_frames;
+    std::vector<cfg::uint32> m_zoneStack;
+    std::vector<GpuZoneResult> m_results;
+    std::unordered_set<std::string> m_names;
+    cfg::uint64 m_frameIndex;
+    cfg::nanoT m_frameTime;
+    cfg::uint64 m_stallCount;
+
+    sys::FrameStats* m_frameStats;
+    cfg::uint32 m_track;
+    bool m_supported;
+    bool m_inFrame;
+};
+
+/**
+ * @brief RAII GPU zone, use it through CURLY_GPU_PROFILE_SCOPE
+ * 
+ */
+class GpuProfileZone final
+{
+public:
+    /**
+     * @brief Open the zone
+     * 
+     * @param t_profiler 
+     * @param t_name 
+     */
+    GpuProfileZone(GpuProfiler& t_profiler, const char* t_name);
+    /**
+     * @brief Close the zone
+     * 
+     */
+    ~GpuProfileZone();
+
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+};
+
+} // namespace gfx
+
+#include <graphics/gpuProfiler.inl>
@@ -0,0 +1,85 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <span>
+
+#define CURLY_INSTANCE_ATTRIB_LOCATION 3
+#define CURLY_INSTANCE_BUFFER_BINDING 8
+
+namespace gfx
+{
+/**
+ * @brief InstanceBuffer Class that streams per-instance transforms through a ring-buffered VBO
+ * Shaders read them as "layout(location = 3) in mat4 instanceModel;"
+ * 
+ */
+class CURLY_API InstanceBuffer
+{
+public:
+    /**
+     * @brief Construct a new InstanceBuffer object
+     * 
+     * @param t_capacity Number of transforms the ring can hold
+     */
+    explicit InstanceBuffer(const cfg::uint32 t_capacity = 16384u);
+    /**
+     * @brief Destroy the InstanceBuffer object
+     * 
+     */
+    virtual ~InstanceBuffer();
+
+    /**
+     * @brief Write transforms at the head of the ring and return their byte offset
+     * When the ring wraps the storage is orphaned, so the GPU never stalls on data in use
+     * 
+     * @param transforms 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 upload(std::span<const glm::mat4> transforms);
+
+    /**
+     * @brief Get the Buffer object name
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getBuffer() const;
+
+private:
+    void allocate(const cfg::uint32 capacity);
+
+    cfg::uint32 m_VBO;
+    cfg::uint32 m_capacity;
+    cfg::uint32 m_head;
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+};
+
+} // namespace gfx
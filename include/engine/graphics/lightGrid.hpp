@@ -0,0 +1,261 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <graphics/uniformBlock.hpp>
+
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#define CURLY_CLUSTER_GRID_X 16u
+#define CURLY_CLUSTER_GRID_Y 9u
+#define CURLY_CLUSTER_GRID_Z 24u
+#define CURLY_CLUSTER_COUNT (CURLY_CLUSTER_GRID_X * CURLY_CLUSTER_GRID_Y * CURLY_CLUSTER_GRID_Z)
+
+#define CURLY_CLUSTER_LIGHTS_BINDING 2
+#define CURLY_CLUSTER_GRID_BINDING 3
+#define CURLY_CLUSTER_INDICES_BINDING 4
+
+#define CURLY_LIGHT_INTENSITY_CUTOFF 256.0f
+
+namespace gfx
+{
+class Shader;
+
+/**
+ * @brief View space bounds of a cluster
+ * 
+ */
+struct ClusterAABB
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+/**
+ * @brief Slice of the light index list that affects a cluster
+ * 
+ */
+struct ClusterRange
+{
+    cfg::uint32 offset;
+    cfg::uint32 count;
+};
+
+/**
+ * @brief Point light as laid out in the lights storage buffer (std430)
+ * 
+ */
+struct GpuPointLight
+{
+    glm::vec4 positionRadius;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;
+};
+
+/**
+ * @brief LightGrid Class that bins point lights into a view frustum cluster grid for clustered forward shading
+ * Binning runs on the CPU with 4-wide sphere/AABB tests and doesn't touch GL, so it can run
+ * and be measured headless; upload(), bind() and setupShader() live in lightGridBuffers.cpp
+ * 
+ * layout(std430, binding = 2) readonly buffer ClusterLights  { PointLight clusterLights[]; };
+ * layout(std430, binding = 3) readonly buffer ClusterGrid    { uvec2 clusterRanges[]; };
+ * layout(std430, binding = 4) readonly buffer ClusterIndices { uint clusterIndices[]; };
+ * 
+ * uvec3 cell = uvec3(gl_FragCoord.xy * clusterScale, log(-viewPos.z) * clusterDepth.x + clusterDepth.y);
+ * uint cluster = cell.x + CLUSTER_X * (cell.y + CLUSTER_Y * cell.z);
+ */
+class CURLY_API LightGrid
+{
+public:
+    /**
+     * @brief Construct a new LightGrid object
+     * 
+     */
+    LightGrid();
+    /**
+     * @brief Destroy the LightGrid object
+     * 
+     */
+    virtual ~LightGrid();
+
+    /**
+     * @brief Rebuild the cluster bounds for a perspective projection
+     * 
+     * @param fovY Vertical field of view in radians
+     * @param aspect 
+     * @param zNear 
+     * @param zFar 
+     */
+    void setProjection(const float fovY, const float aspect, const float zNear, const float zFar);
+    /**
+     * @brief Set the lights of the frame, they are moved to view space and given a cutoff radius
+     * Lights whose radius is zero never reach the cutoff and are dropped
+     * 
+     * @param lights 
+     * @param view 
+     */
+    void setLights(std::span<const PointLightData> lights, const glm::mat4& view);
+
+    /**
+     * @brief Bin every light into the grid, splitting the depth slices across threads
+     * The calling thread works too, the other threadCount - 1 are persistent workers owned
+     * by the grid, spawned on first use and parked between calls
+     * 
+     * @param threadCount 
+     */
+    void assign(const cfg::uint32 threadCount = 1u);
+    /**
+     * @brief Bin the lights of a range of depth slices, the entry point for jobs
+     * Disjoint ranges can run concurrently, finalize() must follow once all of them are done
+     * 
+     * @param firstSlice 
+     * @param sliceCount 
+     */
+    void assignSlices(const cfg::uint32 firstSlice, const cfg::uint32 sliceCount);
+    /**
+     * @brief Join the per slice index lists in slice order
+     * 
+     */
+    void finalize();
+
+    /**
+     * @brief Upload lights, cluster ranges and light indices to their storage buffers
+     * 
+     */
+    void upload();
+    /**
+     * @brief Bind the storage buffers to their binding points
+     * 
+     */
+    void bind() const;
+    /**
+     * @brief Set the clusterScale and clusterDepth uniforms used to find the cluster of a fragment
+     * 
+     * @param shader 
+     * @param viewportWidth 
+     * @param viewportHeight 
+     */
+    void setupShader(Shader& shader, const cfg::uint32 viewportWidth, const cfg::uint32 viewportHeight) const;
+
+    /**
+     * @brief Get the Range of lights of a cluster
+     * 
+     * @param x 
+     * @param y 
+     * @param z 
+     * @return const ClusterRange& 
+     */
+    const ClusterRange& getClusterRange(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z) const;
+    /**
+     * @brief Get the Bounds of a cluster
+     * 
+     * @param x 
+     * @param y 
+     * @param z 
+     * @return const ClusterAABB& 
+     */
+    const ClusterAABB& getClusterAABB(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z) const;
+    /**
+     * @brief Get the Light Indices list, valid after finalize()
+     * 
+     * @return const std::vector<cfg::uint32>& 
+     */
+    const std::vector<cfg::uint32>& getLightIndices() const;
+    /**
+     * @brief Get the Light Count
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getLightCount() const;
+
+    /**
+     * @brief Get the distance past which a light contributes less than 1 / CURLY_LIGHT_INTENSITY_CUTOFF
+     * 
+     * @param light 
+     * @return float 
+     */
+    static float getLightRadius(const PointLightData& light);
+
+private:
+    struct SphereSet
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> r;
+        std::vector<cfg::uint32> index;
+
+        void clear();
+        void push(const float t_x, const float t_y, const float t_z, const float t_r, const cfg::uint32 t_index);
+        cfg::uint32 size() const;
+    };
+
+    void runWorker(const cfg::uint32 workerIndex, cfg::uint64 generation);
+    void assignPendingSlices();
+
+    static cfg::uint32 getClusterIndex(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z);
+    static void filter(const SphereSet& in, const ClusterAABB& box, SphereSet& out);
+
+    float m_near;
+    float m_far;
+
+    std::vector<ClusterAABB> m_clusters;
+    std::vector<ClusterRange> m_ranges;
+
+    SphereSet m_lights;
+    std::vector<GpuPointLight> m_gpuLights;
+    std::vector<std::vector<cfg::uint32>> m_sliceIndices;
+    std::vector<cfg::uint32> m_indices;
+
+    cfg::uint32 m_lightBuffer;
+    cfg::uint32 m_gridBuffer;
+    cfg::uint32 m_indexBuffer;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_workerMutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    std::atomic<cfg::uint32> m_nextSlice;
+    cfg::uint64 m_generation;
+    cfg::uint32 m_activeWorkers;
+    cfg::uint32 m_busyWorkers;
+    bool m_stopWorkers;
+
+    LightGrid(const LightGrid&) = delete;
+    LightGrid& operator=(const LightGrid&) = delete;
+};
+
+} // namespace gfx
@@ -29,6 +29,8 @@
 #include <system/dstr/vector.hpp>
 
 #include <graphics/shader.hpp>
+#include <graphics/atlasBuilder.hpp>
+#include <graphics/instanceBuffer.hpp>
 
 namespace gfx
 {
@@ -52,6 +54,15 @@ public:
      * @param hasUVs 
      */
     Mesh(const char* path, bool hasNormals = true, bool hasUVs = true);
+    /**
+     * @brief Construct a new Mesh object from a path to the OBJ file remapping its UVs into an atlas region
+     * 
+     * @param path 
+     * @param uvRegion 
+     * @param hasNormals 
+     * @param hasUVs 
+     */
+    Mesh(const char* path, const AtlasRegion& uvRegion, bool hasNormals = true, bool hasUVs = true);
     /**
      * @brief Destroy the Mesh object
      * 
@@ -64,6 +75,28 @@ public:
      * @param shader 
      */
     virtual void draw(const Shader& shader);
+    /**
+     * @brief Draw many instances of the Mesh object in one call, reading their transforms from an instance buffer
+     * 
+     * @param shader 
+     * @param instances 
+     * @param offset Byte offset of the first transform returned by InstanceBuffer::upload
+     * @param count 
+     */
+    virtual void drawInstanced(const Shader& shader, const InstanceBuffer& instances, const cfg::uint64 offset, const cfg::uint32 count);
+
+    /**
+     * @brief Get the Vertex Array object name
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getVertexArray() const;
+    /**
+     * @brief Get the Index Count
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getIndexCount() const;
 
 protected:
     /**
@@ -75,6 +108,7 @@ protected:
     cfg::uint32 m_VAO;
     cfg::uint32 m_VBO;
     cfg::uint32 m_EBO;
+    bool m_instancingEnabled;
 
     sys::Vector<cfg::uint32>* m_indices;
     sys::Vector<float>* m_vertexData;
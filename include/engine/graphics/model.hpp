@@ -28,6 +28,8 @@
 
 #include <graphics/mesh.hpp>
 #include <graphics/shader.hpp>
+#include <graphics/atlasBuilder.hpp>
+#include <graphics/renderQueue.hpp>
 
 namespace gfx
 {
@@ -52,6 +54,17 @@ public:
      * @param hasUVs 
      */
     Model(const char* path, const char* texturePath = nullptr, bool hasNormals = true, bool hasUVs = true);
+    /**
+     * @brief Construct a new Model object from an OBJ file path sharing the texture of an atlas
+     * The atlas must be already built and uploaded, and it keeps the ownership of the texture
+     * 
+     * @param path 
+     * @param atlas 
+     * @param regionID 
+     * @param hasNormals 
+     * @param hasUVs 
+     */
+    Model(const char* path, const AtlasBuilder& atlas, const cfg::uint32 regionID, bool hasNormals = true, bool hasUVs = true);
     /**
      * @brief Destroy the Model object
      * 
@@ -64,10 +77,30 @@ public:
      * @param shader 
      */
     void draw(Shader& shader);
+    /**
+     * @brief Draw many instances of the Model object in one call
+     * The shader must read the transform from the instanceModel attribute
+     * 
+     * @param shader 
+     * @param transforms 
+     * @param instances Ring buffer the transforms are streamed through
+     */
+    void drawInstanced(Shader& shader, std::span<const glm::mat4> transforms, InstanceBuffer& instances);
+    /**
+     * @brief Record the Model object into a render queue instead of drawing it right away
+     * 
+     * @param queue 
+     * @param shader 
+     * @param transform 
+     * @param layer 
+     * @param bucket 
+     */
+    void submit(RenderQueue& queue, Shader& shader, const glm::mat4& transform, const cfg::uint32 layer = 0u, const RenderBucket bucket = OPAQUE_BUCKET);
 
 protected:
     Mesh m_mesh;
     cfg::uint32 m_diffuseMap;
+    bool m_ownsDiffuseMap;
 };
 
 } // namespace gfx
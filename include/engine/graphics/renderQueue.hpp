@@ -0,0 +1,177 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <graphics/mesh.hpp>
+#include <graphics/shader.hpp>
+#include <graphics/instanceBuffer.hpp>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+namespace gfx
+{
+/**
+ * @brief Buckets of a layer, opaque draws are sorted front-to-back and go first,
+ * transparent draws are sorted back-to-front and go after them
+ * 
+ */
+enum RenderBucket : cfg::uint32
+{
+    OPAQUE_BUCKET      = 0,
+    TRANSPARENT_BUCKET = 1
+};
+
+/**
+ * @brief Compact record of a single draw
+ * 
+ */
+struct DrawPacket
+{
+    cfg::uint64 key;
+    Mesh* mesh;
+    Shader* shader;
+    cfg::uint32 texture;
+    cfg::uint32 transformIndex;
+};
+
+/**
+ * @brief RenderQueue Class that records draws as packets with a 64-bit sort key
+ * and submits them sorted so state changes are minimal
+ * 
+ * Key layout, from the most significant bit:
+ * Opaque:      layer(4) | bucket(1) | shader(12) | material(12) | mesh(12) | depth(23)
+ * Transparent: layer(4) | bucket(1) | ~depth(23) | shader(12) | material(12) | mesh(12)
+ */
+class CURLY_API RenderQueue
+{
+public:
+    /**
+     * @brief Construct a new RenderQueue object
+     * 
+     */
+    RenderQueue();
+    /**
+     * @brief Destroy the RenderQueue object
+     * 
+     */
+    virtual ~RenderQueue();
+
+    /**
+     * @brief Start recording a frame seen from some view position
+     * 
+     * @param viewPos 
+     * @param farPlane Distance used to quantize the depth of the draws
+     */
+    void begin(const glm::vec3& viewPos, const float farPlane);
+    /**
+     * @brief Record a draw
+     * 
+     * @param mesh 
+     * @param shader 
+     * @param texture Diffuse map bound to unit 0
+     * @param transform Model matrix, uploaded to the "model" uniform
+     * @param layer 
+     * @param bucket 
+     */
+    void submit(Mesh& mesh, Shader& shader, const cfg::uint32 texture, const glm::mat4& transform, const cfg::uint32 layer = 0u, const RenderBucket bucket = OPAQUE_BUCKET);
+    /**
+     * @brief Radix-sort the recorded packets by key
+     * 
+     */
+    void sort();
+    /**
+     * @brief Register the instanced variant of a shader, consecutive opaque draws of the same
+     * mesh and material with that shader are then merged into one instanced draw
+     * 
+     * @param shader 
+     * @param instancedShader Variant reading the transform from the instanceModel attribute
+     */
+    void setInstancedVariant(const Shader& shader, Shader& instancedShader);
+    /**
+     * @brief Sort and issue every recorded draw, then clear the queue
+     * 
+     */
+    void flush();
+    /**
+     * @brief Drop every recorded draw
+     * 
+     */
+    void clear();
+
+    /**
+     * @brief Get the recorded packets, sorted if sort was called
+     * 
+     * @return const std::vector<DrawPacket>& 
+     */
+    const std::vector<DrawPacket>& getPackets() const;
+    /**
+     * @brief Get the Transform of a packet
+     * 
+     * @param packet 
+     * @return const glm::mat4& 
+     */
+    const glm::mat4& getTransform(const DrawPacket& packet) const;
+
+    /**
+     * @brief Build a sort key
+     * 
+     * @param layer 
+     * @param bucket 
+     * @param shader 
+     * @param material 
+     * @param mesh 
+     * @param depth Normalized depth in [0, 1]
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 makeKey(const cfg::uint32 layer, const RenderBucket bucket, const cfg::uint32 shader, const cfg::uint32 material, const cfg::uint32 mesh, const float depth);
+
+private:
+    /**
+     * @brief Draw a run of packets sharing shader, material and mesh as a single instanced draw
+     * 
+     * @return true if the run was drawn
+     * @return false if the shader has no instanced variant
+     */
+    bool drawInstancedRun(const DrawPacket* run, const size_t count, Shader*& currentShader);
+
+    glm::vec3 m_viewPos;
+    float m_invFarPlane;
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<DrawPacket> m_sortBuffer;
+    std::vector<glm::mat4> m_transforms;
+
+    std::unique_ptr<InstanceBuffer> m_instances;
+    std::vector<glm::mat4> m_instanceTransforms;
+    std::unordered_map<cfg::uint32, Shader*> m_instancedVariants;
+};
+
+} // namespace gfx
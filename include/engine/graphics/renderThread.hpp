@@ -0,0 +1,137 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <graphics/commandList.hpp>
+
+#include <window/renderingWindow.hpp>
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#define CURLY_RENDER_THREAD_MAX_LATENCY 2u
+
+namespace gfx
+{
+/**
+ * @brief RenderThread Class that moves the GL context of a window to a dedicated thread
+ * The game thread records frame N into a CommandList while the render thread translates
+ * frame N - 1 into GL calls and swaps, and beginFrame() blocks once the game is more than the
+ * configured latency (1 or 2 frames) ahead
+ * Until start() is called, or after stop(), frames are replayed inline on endFrame()
+ * 
+ */
+class CURLY_API RenderThread
+{
+public:
+    /**
+     * @brief Construct a new RenderThread object
+     * 
+     * @param t_window Window whose context and swap chain the thread takes over
+     * @param t_latency Frames the game thread may run ahead of the render thread
+     */
+    explicit RenderThread(wnd::RenderingWindow& t_window, const cfg::uint32 t_latency = 1u);
+    /**
+     * @brief Destroy the RenderThread object, stopping the thread first
+     * 
+     */
+    virtual ~RenderThread();
+
+    /**
+     * @brief Release the context from the calling thread and spawn the render thread
+     * 
+     */
+    void start();
+    /**
+     * @brief Replay the pending frames, join the render thread and take the context back
+     * It must be called before the window is closed
+     * 
+     */
+    void stop();
+
+    /**
+     * @brief Get the CommandList of the next frame, waiting for a free one if needed
+     * 
+     * @return CommandList& 
+     */
+    CommandList& beginFrame();
+    /**
+     * @brief Hand the recorded frame over to the render thread
+     * 
+     */
+    void endFrame();
+    /**
+     * @brief Block until every submitted frame was replayed and swapped
+     * 
+     */
+    void waitIdle();
+
+    /**
+     * @brief Check if the render thread is running
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isRunning() const;
+    /**
+     * @brief Get the Latency in frames
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getLatency() const;
+
+private:
+    void run();
+
+    /**
+     * @brief Translate the commands of a list into GL calls on the calling thread
+     * 
+     * @param list 
+     */
+    static void replay(const CommandList& list);
+
+    wnd::RenderingWindow& m_window;
+    const cfg::uint32 m_latency;
+
+    CommandList m_lists[CURLY_RENDER_THREAD_MAX_LATENCY + 1];
+    cfg::uint64 m_submitted;
+    cfg::uint64 m_completed;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_submitCondition;
+    std::condition_variable m_completeCondition;
+
+    bool m_running;
+    bool m_stopRequested;
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+};
+
+} // namespace gfx
@@ -33,7 +33,14 @@
 #include <math/vec3.hpp>
 #include <math/vec4.hpp>
 
+#include <graphics/uniformId.hpp>
+#include <graphics/shaderPreprocessor.hpp>
+
 #include <string>
+#include <unordered_map>
+
+#define CURLY_PROGRAM_BINARY_MAGIC 0x594C5243u
+#define CURLY_GL_COMPLETION_STATUS_KHR 0x91B1
 
 namespace gfx
 {
@@ -57,6 +64,15 @@ public:
      * @param name 
      */
     Shader(const std::string& name);
+    /**
+     * @brief Construct a new Shader permutation object from its name and a set of defines
+     * Sources are preprocessed resolving #include directives relative to the shaders folder
+     * 
+     * @param name 
+     * @param defines 
+     * @param deferred If true compile and link are only submitted, see isReady and finish
+     */
+    Shader(const std::string& name, const ShaderDefines& defines, const bool deferred = false);
     /**
      * @brief Construct a new Shader object from string source
      * 
@@ -70,11 +86,62 @@ public:
      */
     virtual ~Shader();
 
+    /**
+     * @brief Set the directory where linked program binaries are cached, an empty path disables the cache
+     * 
+     * @param directory 
+     */
+    static void setBinaryCacheDirectory(const std::string& directory);
+
+    /**
+     * @brief Check without blocking if a deferred shader finished compiling
+     * Always true if GL_KHR_parallel_shader_compile is not available
+     * 
+     * @return true if finish won't stall
+     * @return false if not
+     */
+    bool isReady() const;
+    /**
+     * @brief Check the compile status of a deferred shader and make it usable
+     * It must be called before using a deferred shader
+     * 
+     */
+    void finish();
+
     /**
      * @brief Binds the current context to this shader
      * 
      */
     void use() const;
+    /**
+     * @brief Get the Program object name
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getProgram() const;
+
+    /**
+     * @brief Get the Location of a uniform from the reflected uniform table
+     * 
+     * @param name 
+     * @return cfg::int32 -1 if the uniform is not active
+     */
+    cfg::int32 getUniformLocation(const std::string& name) const;
+    /**
+     * @brief Get the Location of a uniform from the reflected uniform table
+     * 
+     * @param id 
+     * @return cfg::int32 -1 if the uniform is not active
+     */
+    cfg::int32 getUniformLocation(const UniformId id) const;
+    /**
+     * @brief Bind a uniform block of this shader to a binding point, does nothing if the block is not active
+     * CameraBlock and LightsBlock are bound to their fixed binding points on link
+     * 
+     * @param blockName 
+     * @param bindingPoint 
+     */
+    void bindUniformBlock(const std::string& blockName, const cfg::uint32 bindingPoint);
 
     /**
      * @brief Set the Bool object
@@ -83,6 +150,20 @@ public:
      * @param v0 
      */
     void setBool(const std::string& name, bool v0);
+    /**
+     * @brief Set the Bool object
+     * 
+     * @param id 
+     * @param v0 
+     */
+    void setBool(const UniformId id, bool v0);
+    /**
+     * @brief Set the Bool object
+     * 
+     * @param location 
+     * @param v0 
+     */
+    void setBool(const cfg::int32 location, bool v0);
     /**
      * @brief Set the Int object
      * 
@@ -90,6 +171,20 @@ public:
      * @param v0 
      */
     void setInt(const std::string& name, int v0);
+    /**
+     * @brief Set the Int object
+     * 
+     * @param id 
+     * @param v0 
+     */
+    void setInt(const UniformId id, int v0);
+    /**
+     * @brief Set the Int object
+     * 
+     * @param location 
+     * @param v0 
+     */
+    void setInt(const cfg::int32 location, int v0);
     /**
      * @brief Set the Float object
      * 
@@ -97,6 +192,20 @@ public:
      * @param v0 
      */
     void setFloat(const std::string& name, float v0);
+    /**
+     * @brief Set the Float object
+     * 
+     * @param id 
+     * @param v0 
+     */
+    void setFloat(const UniformId id, float v0);
+    /**
+     * @brief Set the Float object
+     * 
+     * @param location 
+     * @param v0 
+     */
+    void setFloat(const cfg::int32 location, float v0);
 
     /**
      * @brief Set the Vec2 object
@@ -106,6 +215,22 @@ public:
      * @param v1 
      */
     void setVec2(const std::string& name, float v0, float v1);
+    /**
+     * @brief Set the Vec2 object
+     * 
+     * @param id 
+     * @param v0 
+     * @param v1 
+     */
+    void setVec2(const UniformId id, float v0, float v1);
+    /**
+     * @brief Set the Vec2 object
+     * 
+     * @param location 
+     * @param v0 
+     * @param v1 
+     */
+    void setVec2(const cfg::int32 location, float v0, float v1);
     /**
      * @brief Set the Vec3 object
      * 
@@ -115,6 +240,24 @@ public:
      * @param v2 
      */
     void setVec3(const std::string& name, float v0, float v1, float v2);
+    /**
+     * @brief Set the Vec3 object
+     * 
+     * @param id 
+     * @param v0 
+     * @param v1 
+     * @param v2 
+     */
+    void setVec3(const UniformId id, float v0, float v1, float v2);
+    /**
+     * @brief Set the Vec3 object
+     * 
+     * @param location 
+     * @param v0 
+     * @param v1 
+     * @param v2 
+     */
+    void setVec3(const cfg::int32 location, float v0, float v1, float v2);
     /**
      * @brief Set the Vec4 object
      * 
@@ -125,6 +268,26 @@ public:
      * @param v3 
      */
     void setVec4(const std::string& name, float v0, float v1, float v2, float v3);
+    /**
+     * @brief Set the Vec4 object
+     * 
+     * @param id 
+     * @param v0 
+     * @param v1 
+     * @param v2 
+     * @param v3 
+     */
+    void setVec4(const UniformId id, float v0, float v1, float v2, float v3);
+    /**
+     * @brief Set the Vec4 object
+     * 
+     * @param location 
+     * @param v0 
+     * @param v1 
+     * @param v2 
+     * @param v3 
+     */
+    void setVec4(const cfg::int32 location, float v0, float v1, float v2, float v3);
 
     /**
      * @brief Set the Vec2 object
@@ -133,6 +296,20 @@ public:
      * @param v 
      */
     void setVec2(const std::string& name, const math::Vec2& v);
+    /**
+     * @brief Set the Vec2 object
+     * 
+     * @param id 
+     * @param v 
+     */
+    void setVec2(const UniformId id, const math::Vec2& v);
+    /**
+     * @brief Set the Vec2 object
+     * 
+     * @param location 
+     * @param v 
+     */
+    void setVec2(const cfg::int32 location, const math::Vec2& v);
     /**
      * @brief Set the Vec3 object
      * 
@@ -140,6 +317,20 @@ public:
      * @param v 
      */
     void setVec3(const std::string& name, const math::Vec3& v);
+    /**
+     * @brief Set the Vec3 object
+     * 
+     * @param id 
+     * @param v 
+     */
+    void setVec3(const UniformId id, const math::Vec3& v);
+    /**
+     * @brief Set the Vec3 object
+     * 
+     * @param location 
+     * @param v 
+     */
+    void setVec3(const cfg::int32 location, const math::Vec3& v);
     /**
      * @brief Set the Vec4 object
      * 
@@ -147,6 +338,20 @@ public:
      * @param v 
      */
     void setVec4(const std::string& name, const math::Vec4& v);
+    /**
+     * @brief Set the Vec4 object
+     * 
+     * @param id 
+     * @param v 
+     */
+    void setVec4(const UniformId id, const math::Vec4& v);
+    /**
+     * @brief Set the Vec4 object
+     * 
+     * @param location 
+     * @param v 
+     */
+    void setVec4(const cfg::int32 location, const math::Vec4& v);
 
     /**
      * @brief Set the Mat3 object
@@ -155,6 +360,20 @@ public:
      * @param m0 
      */
     void setMat3(const std::string& name, const glm::mat3& m0);
+    /**
+     * @brief Set the Mat3 object
+     * 
+     * @param id 
+     * @param m0 
+     */
+    void setMat3(const UniformId id, const glm::mat3& m0);
+    /**
+     * @brief Set the Mat3 object
+     * 
+     * @param location 
+     * @param m0 
+     */
+    void setMat3(const cfg::int32 location, const glm::mat3& m0);
     /**
      * @brief Set the Mat4 object
      * 
@@ -162,8 +381,39 @@ public:
      * @param m0 
      */
     void setMat4(const std::string& name, const glm::mat4& m0);
+    /**
+     * @brief Set the Mat4 object
+     * 
+     * @param id 
+     * @param m0 
+     */
+    void setMat4(const UniformId id, const glm::mat4& m0);
+    /**
+     * @brief Set the Mat4 object
+     * 
+     * @param location 
+     * @param m0 
+     */
+    void setMat4(const cfg::int32 location, const glm::mat4& m0);
+
+private:
+    struct ProgramBinaryHeader
+    {
+        cfg::uint32 magic;
+        cfg::uint32 format;
+        cfg::uint32 length;
+        cfg::uint64 key;
+    };
 
 private:
+    /**
+     * @brief Create the program from sources, or from the binary cache if there's a valid entry
+     * 
+     * @param vsSrc 
+     * @param fsSrc 
+     * @param deferred 
+     */
+    void createProgram(const std::string& vsSrc, const std::string& fsSrc, const bool deferred);
     /**
      * @brief Create a Shader object
      * 
@@ -185,11 +435,62 @@ private:
      * 
      * @param target 
      * @param isProgram 
+     * @return true if compilation or link succeeded
+     * @return false if not
      */
-    void checkErrors(const cfg::uint32 target, const bool isProgram);
+    bool checkErrors(const cfg::uint32 target, const bool isProgram);
+    /**
+     * @brief Query every active uniform once after link and fill the location table
+     * 
+     */
+    void reflectUniforms();
+
+    /**
+     * @brief Check once if the driver compiles shaders in background threads
+     * 
+     * @return true if GL_KHR_parallel_shader_compile is supported
+     * @return false if not
+     */
+    static bool isParallelCompileSupported();
+    /**
+     * @brief Hash the sources together with the driver strings to key the binary cache
+     * 
+     * @param vsSrc 
+     * @param fsSrc 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 hashProgram(const std::string& vsSrc, const std::string& fsSrc);
+    /**
+     * @brief Get the path of the binary cache entry of a program
+     * 
+     * @param programKey 
+     * @return std::string 
+     */
+    static std::string getBinaryCachePath(const cfg::uint64 programKey);
+    /**
+     * @brief Try to load the program from the binary cache
+     * 
+     * @param programKey 
+     * @return true if the cached binary was accepted by the driver
+     * @return false if it must be compiled from sources
+     */
+    bool loadProgramBinary(const cfg::uint64 programKey);
+    /**
+     * @brief Store the linked program into the binary cache
+     * 
+     * @param programKey 
+     */
+    void storeProgramBinary(const cfg::uint64 programKey);
 
 private:
     cfg::uint32 m_program;
+    cfg::uint32 m_vertexShader;
+    cfg::uint32 m_fragmentShader;
+    cfg::uint64 m_programKey;
+    bool m_pending;
+    std::unordered_map<cfg::uint32, cfg::int32> m_uniformLocations;
+
+    static std::string s_binaryCacheDirectory;
 };
 
 } // namespace gfx
@@ -0,0 +1,94 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <graphics/shader.hpp>
+#include <graphics/shaderPreprocessor.hpp>
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+namespace gfx
+{
+/**
+ * @brief ShaderLibrary Class that owns shader permutations by variant key
+ * and compiles them concurrently, polling completion instead of blocking
+ * 
+ */
+class CURLY_API ShaderLibrary
+{
+public:
+    /**
+     * @brief Construct a new ShaderLibrary object
+     * 
+     */
+    ShaderLibrary();
+    /**
+     * @brief Destroy the ShaderLibrary object
+     * 
+     */
+    virtual ~ShaderLibrary();
+
+    /**
+     * @brief Request a shader permutation, its compilation starts right away
+     * Requesting an already known permutation does nothing
+     * 
+     * @param name 
+     * @param defines 
+     * @return cfg::uint64 Variant key of the permutation
+     */
+    cfg::uint64 request(const std::string& name, const ShaderDefines& defines = {});
+    /**
+     * @brief Finish every pending permutation that completed compiling without blocking
+     * 
+     * @return cfg::uint32 Number of permutations still pending
+     */
+    cfg::uint32 poll();
+    /**
+     * @brief Finish every pending permutation, blocking if needed
+     * 
+     */
+    void finishAll();
+
+    /**
+     * @brief Get a permutation given its variant key
+     * 
+     * @param variantKey 
+     * @return Shader* nullptr if it's unknown or still compiling
+     */
+    Shader* get(const cfg::uint64 variantKey);
+
+private:
+    std::unordered_map<cfg::uint64, std::unique_ptr<Shader>> m_variants;
+    std::vector<cfg::uint64> m_pending;
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+};
+
+} // namespace gfx
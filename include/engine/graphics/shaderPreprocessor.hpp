@@ -0,0 +1,103 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+#define CURLY_MAX_INCLUDE_DEPTH 32
+
+namespace gfx
+{
+/**
+ * @brief Set of #define NAME VALUE pairs that selects a shader permutation
+ * It's ordered so the same set always produces the same variant key
+ * 
+ */
+using ShaderDefines = std::map<std::string, std::string>;
+
+/**
+ * @brief ShaderPreprocessor Class that resolves #include directives,
+ * injects permutation defines and fixes the #version of GLSL sources
+ * 
+ */
+class CURLY_API ShaderPreprocessor
+{
+public:
+    /**
+     * @brief Construct a new ShaderPreprocessor object
+     * 
+     * @param t_includeDirectory Directory #include paths are relative to
+     */
+    explicit ShaderPreprocessor(const std::string& t_includeDirectory = "shaders/");
+    /**
+     * @brief Destroy the ShaderPreprocessor object
+     * 
+     */
+    virtual ~ShaderPreprocessor();
+
+    /**
+     * @brief Process a GLSL source and return the code ready to compile
+     * 
+     * @param src 
+     * @param defines 
+     * @return std::string 
+     */
+    std::string process(const std::string& src, const ShaderDefines& defines);
+
+    /**
+     * @brief Get the Variant Key of a shader permutation
+     * 
+     * @param name 
+     * @param defines 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 getVariantKey(const std::string& name, const ShaderDefines& defines);
+
+private:
+    /**
+     * @brief Replace every #include line with the file content, each file is included once
+     * 
+     */
+    std::string resolveIncludes(const std::string& src, const cfg::uint32 depth);
+    /**
+     * @brief Insert the defines right after the #version line
+     * 
+     */
+    void injectDefines(std::string& src, const ShaderDefines& defines);
+    /**
+     * @brief Replace the #version number by the forced GLX context version
+     * 
+     */
+    void replaceVersion(std::string& src, const int major, const int minor);
+
+    std::string m_includeDirectory;
+    std::set<std::string> m_includedFiles;
+};
+
+} // namespace gfx
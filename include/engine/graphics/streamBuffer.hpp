@@ -0,0 +1,139 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#define CURLY_STREAM_BUFFER_REGIONS 3
+#define CURLY_STREAM_BUFFER_INVALID_OFFSET 0xFFFFFFFFFFFFFFFFull
+
+namespace gfx
+{
+/**
+ * @brief StreamBuffer Class for data rewritten every frame (per-frame uniforms, instance data, debug geometry)
+ * It keeps a persistent coherent mapping split in CURLY_STREAM_BUFFER_REGIONS regions, one per frame in flight,
+ * each guarded by a fence, so writes never wait on the driver implicitly
+ * Without buffer storage it falls back to orphaning the buffer every frame and glBufferSubData
+ * 
+ */
+class CURLY_API StreamBuffer
+{
+public:
+    /**
+     * @brief Construct a new StreamBuffer object
+     * 
+     * @param t_regionSize Bytes available for a single frame
+     * @param t_allowPersistent Use the persistent mapping when it is supported
+     */
+    explicit StreamBuffer(const cfg::uint64 t_regionSize, const bool t_allowPersistent = true);
+    /**
+     * @brief Destroy the StreamBuffer object
+     * 
+     */
+    virtual ~StreamBuffer();
+
+    /**
+     * @brief Move to the next region, waiting only if the GPU is still reading it
+     * The first region stays current until a frame is fenced on it, so writes issued
+     * before the first beginFrame are kept and fenced with that frame
+     * 
+     */
+    void beginFrame();
+    /**
+     * @brief Fence the current region after the frame draws were issued
+     * 
+     */
+    void endFrame();
+
+    /**
+     * @brief Copy data at the head of the current region
+     * 
+     * @param data 
+     * @param size 
+     * @param alignment Required offset alignment, use getUniformAlignment() for uniform blocks
+     * @return cfg::uint64 Byte offset inside the buffer or CURLY_STREAM_BUFFER_INVALID_OFFSET if the region is full
+     */
+    cfg::uint64 write(const void* data, const cfg::uint64 size, const cfg::uint64 alignment = 16);
+
+    /**
+     * @brief Bind a written range to an indexed target (GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER)
+     * 
+     * @param target 
+     * @param index 
+     * @param offset 
+     * @param size 
+     */
+    void bindRange(const cfg::uint32 target, const cfg::uint32 index, const cfg::uint64 offset, const cfg::uint64 size) const;
+
+    /**
+     * @brief Get the GL Buffer
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getBuffer() const;
+    /**
+     * @brief Whether the persistent mapping path is in use
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isPersistent() const;
+    /**
+     * @brief Get the number of frames that had to wait on a fence
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getStallCount() const;
+
+    /**
+     * @brief Whether the context supports glBufferStorage, through GL 4.4 or GL_ARB_buffer_storage
+     * 
+     * @return true 
+     * @return false 
+     */
+    static bool isPersistentMappingSupported();
+    /**
+     * @brief Get the offset alignment required for uniform buffer ranges
+     * 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 getUniformAlignment();
+
+private:
+    cfg::uint32 m_buffer;
+    cfg::uint64 m_regionSize;
+    cfg::uint32 m_region;
+    cfg::uint64 m_head;
+    cfg::uint64 m_stalls;
+
+    bool m_persistent;
+    cfg::byte* m_mapped;
+    void* m_fences[CURLY_STREAM_BUFFER_REGIONS];
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+};
+
+} // namespace gfx
@@ -0,0 +1,250 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <external/glm/glm.hpp>
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <vector>
+
+#define CURLY_MAX_POINT_LIGHTS 16
+
+namespace gfx
+{
+/**
+ * @brief Fixed binding points of the engine uniform blocks
+ * 
+ */
+enum UniformBlockBinding : cfg::uint32
+{
+    CAMERA_BLOCK_BINDING = 0,
+    LIGHTS_BLOCK_BINDING = 1
+};
+
+/**
+ * @brief Std140Writer Class that serializes values following the std140 layout rules
+ * 
+ */
+class CURLY_API Std140Writer
+{
+public:
+    /**
+     * @brief Construct a new Std140Writer object
+     * 
+     */
+    Std140Writer();
+    /**
+     * @brief Destroy the Std140Writer object
+     * 
+     */
+    virtual ~Std140Writer();
+
+    void write(const float v0);
+    void write(const cfg::int32 v0);
+    void write(const cfg::uint32 v0);
+    void write(const bool v0);
+    void write(const glm::vec2& v);
+    void write(const glm::vec3& v);
+    void write(const glm::vec4& v);
+    void write(const glm::mat3& m0);
+    void write(const glm::mat4& m0);
+
+    /**
+     * @brief Write an array of scalars or vectors, every element takes at least a vec4 slot
+     * 
+     * @param values 
+     * @param count 
+     */
+    template <typename T>
+    void writeArray(const T* values, const cfg::uint32 count);
+
+    /**
+     * @brief Begin a nested struct, structs are aligned as a vec4
+     * 
+     */
+    void beginStruct();
+    /**
+     * @brief End a nested struct, its size is rounded up to a vec4
+     * 
+     */
+    void endStruct();
+
+    /**
+     * @brief Get the serialized data
+     * 
+     * @return const cfg::byte* 
+     */
+    const cfg::byte* data() const;
+    /**
+     * @brief Get the size in bytes of the serialized data
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 size() const;
+    /**
+     * @brief Clear the serialized data to reuse the writer
+     * 
+     */
+    void clear();
+
+private:
+    void align(const cfg::uint32 alignment);
+    void append(const void* src, const cfg::uint32 bytes, const cfg::uint32 alignment);
+
+    std::vector<cfg::byte> m_buffer;
+};
+
+/**
+ * @brief UniformBlock Class that wraps a Uniform Buffer Object bound at a fixed binding point
+ * so every shader declaring the block reads the same data without per-program uploads
+ * 
+ */
+class CURLY_API UniformBlock
+{
+public:
+    /**
+     * @brief Construct a new UniformBlock object
+     * 
+     * @param t_bindingPoint 
+     * @param t_size Initial size in bytes of the buffer
+     */
+    UniformBlock(const cfg::uint32 t_bindingPoint, const cfg::uint32 t_size = 0u);
+    /**
+     * @brief Destroy the UniformBlock object
+     * 
+     */
+    virtual ~UniformBlock();
+
+    /**
+     * @brief Upload raw std140 data to the buffer, growing it if needed
+     * Growing keeps the bytes already uploaded, so a partial update past the end is safe
+     * 
+     * @param data 
+     * @param size 
+     * @param offset 
+     */
+    void update(const void* data, const cfg::uint32 size, const cfg::uint32 offset = 0u);
+    /**
+     * @brief Upload the content of a writer to the buffer
+     * 
+     * @param writer 
+     */
+    void update(const Std140Writer& writer);
+    /**
+     * @brief Serialize any struct with a writeStd140 overload and upload it
+     * 
+     * @param blockData 
+     */
+    template <typename T>
+    void update(const T& blockData);
+
+    /**
+     * @brief Bind the buffer to its binding point
+     * 
+     */
+    void bind() const;
+    /**
+     * @brief Get the Binding Point
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getBindingPoint() const;
+
+private:
+    cfg::uint32 m_UBO;
+    cfg::uint32 m_size;
+    cfg::uint32 m_bindingPoint;
+
+    Std140Writer m_writer;
+
+    UniformBlock(const UniformBlock&) = delete;
+    UniformBlock& operator=(const UniformBlock&) = delete;
+};
+
+/**
+ * @brief Per-frame camera data
+ * 
+ * layout(std140, binding = 0) uniform CameraBlock
+ * {
+ *     mat4 view;
+ *     mat4 projection;
+ *     vec3 viewPos;
+ * };
+ */
+struct CameraData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+};
+
+struct DirLightData
+{
+    glm::vec3 direction;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+};
+
+struct PointLightData
+{
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+/**
+ * @brief Per-frame light data
+ * 
+ * layout(std140, binding = 1) uniform LightsBlock
+ * {
+ *     vec3 lightColor;
+ *     DirLight dirLight;
+ *     int nrPointLights;
+ *     PointLight pointLights[CURLY_MAX_POINT_LIGHTS];
+ * };
+ */
+struct LightsData
+{
+    glm::vec3 lightColor;
+    DirLightData dirLight;
+    cfg::int32 nrPointLights;
+    PointLightData pointLights[CURLY_MAX_POINT_LIGHTS];
+};
+
+CURLY_API void writeStd140(Std140Writer& writer, const CameraData& camera);
+CURLY_API void writeStd140(Std140Writer& writer, const DirLightData& light);
+CURLY_API void writeStd140(Std140Writer& writer, const PointLightData& light);
+CURLY_API void writeStd140(Std140Writer& writer, const LightsData& lights);
+
+} // namespace gfx
+
+#include <graphics/uniformBlock.inl>
@@ -0,0 +1,77 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <cstddef>
+
+namespace gfx
+{
+/**
+ * @brief Hash a uniform name with FNV-1a, usable at compile time
+ * 
+ * @param name 
+ * @param length 
+ * @return cfg::uint32 
+ */
+constexpr cfg::uint32 hashUniformName(const char* name, const std::size_t length);
+/**
+ * @brief Hash a null-terminated uniform name with FNV-1a, usable at compile time
+ * 
+ * @param name 
+ * @return cfg::uint32 
+ */
+constexpr cfg::uint32 hashUniformName(const char* name);
+
+/**
+ * @brief UniformId Class that holds the precomputed hash of a uniform name
+ * so it can be looked up in the uniform table of a Shader without strings
+ * 
+ */
+class UniformId final
+{
+public:
+    /**
+     * @brief Construct a new UniformId object from a uniform name
+     * 
+     * @param name 
+     */
+    constexpr explicit UniformId(const char* name);
+
+    /**
+     * @brief Get the Hash of the uniform name
+     * 
+     * @return cfg::uint32 
+     */
+    constexpr cfg::uint32 getHash() const;
+
+private:
+    cfg::uint32 m_hash;
+};
+
+} // namespace gfx
+
+#include <graphics/uniformId.inl>
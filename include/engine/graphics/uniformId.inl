@@ -0,0 +1,57 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+namespace gfx
+{
+inline constexpr cfg::uint32 hashUniformName(const char* name, const std::size_t length)
+{
+    cfg::uint32 hash {2166136261u};
+    for(std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<cfg::uint8>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline constexpr cfg::uint32 hashUniformName(const char* name)
+{
+    std::size_t length {0};
+    while(name[length] != '\0')
+    {
+        ++length;
+    }
+    return hashUniformName(name, length);
+}
+
+inline constexpr UniformId::UniformId(const char* name)
+    : m_hash {hashUniformName(name)}
+{
+}
+
+inline constexpr cfg::uint32 UniformId::getHash() const
+{
+    return m_hash;
+}
+
+} // namespace gfx
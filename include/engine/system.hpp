@@ -26,5 +26,12 @@
 #include <core/config.hpp>
 
 #include <system/time.hpp>
+#include <system/clock.hpp>
 #include <system/timer.hpp>
+#include <system/timerWheel.hpp>
+#include <system/frameStats.hpp>
+#include <system/profiler.hpp>
+#include <system/perfCounters.hpp>
+#include <system/framePacer.hpp>
+#include <system/gameLoop.hpp>
 #include <system/utility.hpp>
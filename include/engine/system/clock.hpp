@@ -0,0 +1,120 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/time.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define CURLY_CLOCK_TSC_SUPPORT
+#endif
+
+namespace sys
+{
+/**
+ * @brief Monotonic nanosecond Clock with a calibrated TSC fast path.
+ * When the CPU reports an invariant TSC, ticks are read with rdtsc and
+ * converted using a rate calibrated against the platform monotonic clock,
+ * otherwise ticks are the platform monotonic clock nanoseconds themselves.
+ * Raw ticks are meant for cheap timestamps (profiling zones) and should be
+ * converted to Time only when they are consumed.
+ * 
+ */
+class CURLY_API Clock final
+{
+public:
+    Clock() = delete;
+
+    /**
+     * @brief Get the current Time
+     * 
+     * @return Time 
+     */
+    static Time now();
+    /**
+     * @brief Get the current raw tick count
+     * 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 getTicks();
+
+    /**
+     * @brief Convert a raw tick count to a Time Point on the now() timeline
+     * 
+     * @param t_ticks 
+     * @return Time 
+     */
+    static Time ticksToTime(const cfg::uint64 t_ticks);
+    /**
+     * @brief Convert a Time Point on the now() timeline back to raw ticks
+     * 
+     * @param t_time 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 timeToTicks(const Time& t_time);
+    /**
+     * @brief Convert a raw tick interval to nanoseconds
+     * 
+     * @param t_ticks 
+     * @return cfg::nanoT 
+     */
+    static cfg::nanoT ticksToNanoseconds(const cfg::int64 t_ticks);
+
+    /**
+     * @brief Check whether the TSC fast path is in use
+     * 
+     * @return true if ticks come from rdtsc
+     * @return false if ticks come from the platform monotonic clock
+     */
+    static bool isTscEnabled();
+    /**
+     * @brief Get the calibrated tick rate
+     * 
+     * @return double 
+     */
+    static double getTicksPerSecond();
+
+    /**
+     * @brief Check for an invariant TSC and calibrate it.
+     * It runs once during static initialization, ticks taken before
+     * that point belong to the platform clock and must not be mixed with later ones
+     * 
+     * @return true if the TSC fast path was enabled
+     */
+    static bool calibrate();
+
+private:
+    static cfg::uint64 getPlatformTicks();
+
+    static bool s_tscEnabled;
+    static cfg::uint64 s_baseTicks;
+    static cfg::nanoT s_baseNanoseconds;
+    static double s_nanosecondsPerTick;
+};
+
+} // namespace sys
+
+#include <system/clock.inl>
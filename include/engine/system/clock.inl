@@ -0,0 +1,75 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#if defined(CURLY_CLOCK_TSC_SUPPORT)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+namespace sys
+{
+inline Time Clock::now()
+{
+    return ticksToTime(getTicks());
+}
+
+inline cfg::uint64 Clock::getTicks()
+{
+#if defined(CURLY_CLOCK_TSC_SUPPORT)
+    if(s_tscEnabled)
+    {
+        return __rdtsc();
+    }
+#endif
+    return getPlatformTicks();
+}
+
+inline Time Clock::ticksToTime(const cfg::uint64 t_ticks)
+{
+    return nanoseconds(s_baseNanoseconds + ticksToNanoseconds(static_cast<cfg::int64>(t_ticks - s_baseTicks)));
+}
+
+inline cfg::uint64 Clock::timeToTicks(const Time& t_time)
+{
+    return s_baseTicks + static_cast<cfg::uint64>(static_cast<cfg::int64>(static_cast<double>(t_time.asNanoseconds() - s_baseNanoseconds) / s_nanosecondsPerTick));
+}
+
+inline cfg::nanoT Clock::ticksToNanoseconds(const cfg::int64 t_ticks)
+{
+    return static_cast<cfg::nanoT>(static_cast<double>(t_ticks) * s_nanosecondsPerTick);
+}
+
+inline bool Clock::isTscEnabled()
+{
+    return s_tscEnabled;
+}
+
+inline double Clock::getTicksPerSecond()
+{
+    return 1000000000.0 / s_nanosecondsPerTick;
+}
+
+} // namespace sys
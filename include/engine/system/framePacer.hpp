@@ -0,0 +1,192 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+namespace sys
+{
+/**
+ * @brief How presents are synchronized with the display refresh
+ * 
+ */
+enum PresentMode : cfg::uint8
+{
+    PRESENT_IMMEDIATE      = 0,
+    PRESENT_VSYNC          = 1,
+    PRESENT_ADAPTIVE_VSYNC = 2
+};
+
+/**
+ * @brief Pacing statistics since the last reset
+ * 
+ */
+struct FramePacingStats
+{
+    cfg::uint64 frameCount;
+    cfg::uint64 missedFrames;
+    float targetMs;
+    float averageMs;
+    float minMs;
+    float maxMs;
+    float jitterMs;
+    float sleepEstimateMs;
+};
+
+/**
+ * @brief FramePacer Class that owns the present mode, limits the frame rate and measures pacing
+ * The limiter sleeps while the remaining time is above its running estimate of the sleep
+ * granularity and spins the rest, which keeps the jitter well under a millisecond
+ * In low latency mode the wait happens at the start of the frame, so input is sampled
+ * right before simulation, and the window drains the GPU queue after every present
+ * 
+ */
+class CURLY_API FramePacer
+{
+public:
+    /**
+     * @brief Construct a new FramePacer object
+     * 
+     * @param t_presentMode 
+     * @param t_targetFps 0 disables the limiter
+     * @param t_lowLatency 
+     */
+    explicit FramePacer(const PresentMode t_presentMode = PRESENT_VSYNC, const float t_targetFps = 0.0f, const bool t_lowLatency = false);
+    /**
+     * @brief Destroy the FramePacer object
+     * 
+     */
+    virtual ~FramePacer();
+
+    /**
+     * @brief Set the Present Mode, the window applies it once on its next present
+     * 
+     * @param presentMode 
+     */
+    void setPresentMode(const PresentMode presentMode);
+    /**
+     * @brief Set the Target Fps of the limiter, 0 disables it
+     * 
+     * @param targetFps 
+     */
+    void setTargetFps(const float targetFps);
+    /**
+     * @brief Enable or disable the low latency mode
+     * 
+     * @param lowLatency 
+     */
+    void setLowLatency(const bool lowLatency);
+    /**
+     * @brief Set the Refresh Rate of the display presents go to, the window reports it
+     * 
+     * @param refreshRate 0 when unknown
+     */
+    void setRefreshRate(const float refreshRate);
+
+    /**
+     * @brief Get the Present Mode
+     * 
+     * @return PresentMode 
+     */
+    PresentMode getPresentMode() const;
+    /**
+     * @brief Get a counter bumped on every present mode change
+     * 
+     * @return cfg::uint32 
+     */
+    cfg::uint32 getPresentModeVersion() const;
+    /**
+     * @brief Get the Target Fps
+     * 
+     * @return float 
+     */
+    float getTargetFps() const;
+    /**
+     * @brief Check if the low latency mode is enabled
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool isLowLatency() const;
+    /**
+     * @brief Get the Refresh Rate of the display
+     * 
+     * @return float 0 when unknown
+     */
+    float getRefreshRate() const;
+
+    /**
+     * @brief Mark the start of a frame, before input is polled
+     * 
+     */
+    void beginFrame();
+    /**
+     * @brief Mark the end of a frame, right before the present
+     * 
+     */
+    void endFrame();
+
+    /**
+     * @brief Get the Stats
+     * 
+     * @return FramePacingStats 
+     */
+    FramePacingStats getStats() const;
+    /**
+     * @brief Reset the Stats
+     * 
+     */
+    void resetStats();
+
+private:
+    void pace();
+    void waitUntil(const cfg::int64 deadline);
+    void recordFrame(const cfg::int64 now);
+
+    static cfg::int64 getNanoseconds();
+
+    PresentMode m_presentMode;
+    cfg::uint32 m_presentModeVersion;
+    float m_targetFps;
+    cfg::int64 m_frameDuration;
+    bool m_lowLatency;
+    float m_refreshRate;
+
+    cfg::int64 m_deadline;
+    cfg::int64 m_lastFrame;
+
+    double m_sleepMean;
+    double m_sleepM2;
+    cfg::uint64 m_sleepCount;
+
+    cfg::uint64 m_frameCount;
+    cfg::uint64 m_missedFrames;
+    double m_frameMean;
+    double m_frameM2;
+    cfg::int64 m_frameMin;
+    cfg::int64 m_frameMax;
+};
+
+} // namespace sys
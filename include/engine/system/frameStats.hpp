@@ -0,0 +1,260 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <string>
+#include <vector>
+
+#define CURLY_FRAME_STATS_DEFAULT_CAPACITY 1024u
+#define CURLY_FRAME_HISTOGRAM_SUB_BITS     7u
+#define CURLY_FRAME_HISTOGRAM_SUB_BUCKETS  (1u << CURLY_FRAME_HISTOGRAM_SUB_BITS)
+#define CURLY_FRAME_HISTOGRAM_MAX_SHIFT    30u
+#define CURLY_FRAME_HISTOGRAM_BUCKETS      (CURLY_FRAME_HISTOGRAM_SUB_BUCKETS + CURLY_FRAME_HISTOGRAM_MAX_SHIFT * (CURLY_FRAME_HISTOGRAM_SUB_BUCKETS / 2u))
+#define CURLY_FRAME_STATS_UNKNOWN_TIME     (-1ll)
+
+namespace sys
+{
+/**
+ * @brief A single recorded frame
+ * 
+ */
+struct FrameSample
+{
+    cfg::uint64 frameIndex;
+    cfg::nanoT cpuTime;
+    cfg::nanoT gpuTime;
+    bool hitch;
+};
+
+/**
+ * @brief Percentiles of one time series, in milliseconds
+ * 
+ */
+struct FrameTimeStats
+{
+    cfg::uint64 sampleCount;
+    float meanMs;
+    float p50Ms;
+    float p95Ms;
+    float p99Ms;
+    float maxMs;
+};
+
+/**
+ * @brief Summary of every frame recorded since the last reset
+ * 
+ */
+struct FrameStatsSummary
+{
+    cfg::uint64 frameCount;
+    cfg::uint64 hitchCount;
+    FrameTimeStats cpu;
+    FrameTimeStats gpu;
+};
+
+/**
+ * @brief Log-linear histogram of microsecond values (HDR histogram style)
+ * Values below 128us are exact, above that every power of two is split into
+ * 64 buckets, so any reported value is within ~1.6% of the recorded one
+ * 
+ */
+class CURLY_API FrameHistogram
+{
+public:
+    /**
+     * @brief Construct a new FrameHistogram object
+     * 
+     */
+    FrameHistogram();
+
+    /**
+     * @brief Record a value
+     * 
+     * @param t_time 
+     */
+    void record(const cfg::nanoT t_time);
+    /**
+     * @brief Clear every bucket
+     * 
+     */
+    void reset();
+
+    /**
+     * @brief Get the value below which the given fraction of the samples falls
+     * 
+     * @param t_fraction in [0, 1]
+     * @return cfg::nanoT 
+     */
+    cfg::nanoT getPercentile(const double t_fraction) const;
+    /**
+     * @brief Get the percentiles summary
+     * 
+     * @return FrameTimeStats 
+     */
+    FrameTimeStats getStats() const;
+
+    /**
+     * @brief Get the count of one bucket
+     * 
+     * @param t_bucket 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getBucketCount(const cfg::uint32 t_bucket) const;
+    /**
+     * @brief Get the highest microsecond value that maps to a bucket
+     * 
+     * @param t_bucket 
+     * @return cfg::uint64 
+     */
+    static cfg::uint64 getBucketUpperBound(const cfg::uint32 t_bucket);
+    /**
+     * @brief Get the bucket a microsecond value maps to
+     * 
+     * @param t_micros 
+     * @return cfg::uint32 
+     */
+    static cfg::uint32 getBucketIndex(const cfg::uint64 t_micros);
+
+private:
+    std::vector<cfg::uint64> m_buckets;
+    cfg::uint64 m_count;
+    cfg::nanoT m_total;
+    cfg::nanoT m_max;
+};
+
+/**
+ * @brief FrameStats Class that records per frame CPU and GPU times
+ * The last frames are kept in a ring buffer for export, while every frame since the last
+ * reset feeds a histogram so the percentiles stay cheap no matter how long the app runs
+ * A frame is a hitch when it takes longer than the threshold, or when no threshold is set,
+ * longer than twice the running median
+ * GPU times usually arrive a few frames late, so they are reported by frame index
+ * 
+ */
+class CURLY_API FrameStats
+{
+public:
+    /**
+     * @brief Construct a new FrameStats object
+     * 
+     * @param t_capacity number of frames kept in the ring buffer
+     */
+    explicit FrameStats(const cfg::uint32 t_capacity = CURLY_FRAME_STATS_DEFAULT_CAPACITY);
+    /**
+     * @brief Destroy the FrameStats object
+     * 
+     */
+    virtual ~FrameStats();
+
+    /**
+     * @brief Record the CPU time of the next frame
+     * 
+     * @param t_cpuTime 
+     * @return cfg::uint64 the index of the recorded frame
+     */
+    cfg::uint64 recordFrame(const cfg::nanoT t_cpuTime);
+    /**
+     * @brief Attach the GPU time of an already recorded frame
+     * 
+     * @param t_frameIndex 
+     * @param t_gpuTime 
+     */
+    void recordGpuTime(const cfg::uint64 t_frameIndex, const cfg::nanoT t_gpuTime);
+    /**
+     * @brief Clear the ring buffer, the histograms and the hitch count
+     * 
+     */
+    void reset();
+
+    /**
+     * @brief Set the Hitch Threshold
+     * 
+     * @param t_threshold 0 uses twice the running median
+     */
+    void setHitchThreshold(const cfg::nanoT t_threshold);
+    /**
+     * @brief Get the Hitch Threshold
+     * 
+     * @return cfg::nanoT 
+     */
+    cfg::nanoT getHitchThreshold() const;
+
+    /**
+     * @brief Get the Summary of the recorded frames
+     * 
+     * @return FrameStatsSummary 
+     */
+    FrameStatsSummary getSummary() const;
+    /**
+     * @brief Get the frames still in the ring buffer, oldest first
+     * 
+     * @return std::vector<FrameSample> 
+     */
+    std::vector<FrameSample> getSamples() const;
+    /**
+     * @brief Get the Frame Count
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getFrameCount() const;
+    /**
+     * @brief Get the Hitch Count
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getHitchCount() const;
+
+    /**
+     * @brief Write the ring buffer as CSV
+     * 
+     * @param t_path 
+     * @return true if the file was written
+     */
+    bool exportCSV(const std::string& t_path) const;
+    /**
+     * @brief Write the summary, the histograms and the ring buffer as JSON
+     * 
+     * @param t_path 
+     * @return true if the file was written
+     */
+    bool exportJSON(const std::string& t_path) const;
+
+private:
+    bool isHitch(const cfg::nanoT t_time) const;
+
+    std::vector<FrameSample> m_samples;
+    cfg::uint64 m_frameCount;
+    cfg::uint64 m_hitchCount;
+
+    FrameHistogram m_cpuHistogram;
+    FrameHistogram m_gpuHistogram;
+
+    cfg::nanoT m_hitchThreshold;
+    cfg::nanoT m_medianEstimate;
+};
+
+} // namespace sys
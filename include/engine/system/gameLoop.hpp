@@ -0,0 +1,194 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/time.hpp>
+#include <system/framePacer.hpp>
+
+#include <functional>
+
+#define CURLY_GAME_LOOP_DEFAULT_RATE    60.0f
+#define CURLY_GAME_LOOP_DEFAULT_STEPS   5u
+#define CURLY_GAME_LOOP_MAX_FRAME_TIME  250000000ll
+#define CURLY_GAME_LOOP_SNAP_TOLERANCE  250000ll
+
+namespace sys
+{
+/**
+ * @brief The stages of a GameLoop frame
+ * 
+ */
+struct GameLoopCallbacks
+{
+    /**
+     * @brief Poll input, returning false stops the loop
+     * 
+     */
+    std::function<bool()> beginFrame;
+    /**
+     * @brief Advance the simulation by the fixed delta time
+     * 
+     */
+    std::function<void(const cfg::secT)> update;
+    /**
+     * @brief Render, blending the last two simulation states by alpha
+     * 
+     */
+    std::function<void(const float)> render;
+    /**
+     * @brief Present
+     * 
+     */
+    std::function<void()> endFrame;
+};
+
+/**
+ * @brief Step counters since the last restart
+ * 
+ */
+struct GameLoopStats
+{
+    cfg::uint64 frameCount;
+    cfg::uint64 stepCount;
+    cfg::uint64 droppedSteps;
+    cfg::uint64 cappedFrames;
+};
+
+/**
+ * @brief GameLoop Class that runs the simulation at a fixed rate, independently of the render rate
+ * Every frame the elapsed time goes into an accumulator that is drained in fixed steps,
+ * what is left over becomes the interpolation alpha for rendering
+ * A frame runs at most maxSteps steps, if the simulation still lags behind the backlog
+ * is dropped, so a slow frame never makes the next ones slower (spiral of death)
+ * With a FramePacer attached, frame times within a quarter millisecond of a multiple of
+ * the pacer period are snapped to it, so vsync jitter does not alternate 0 and 2 steps
+ * The period is the limiter target or, under V-Sync without a target, the display refresh
+ * The snapping error is carried into the next frame, so simulated time never drifts from wall time
+ * 
+ */
+class CURLY_API GameLoop
+{
+public:
+    /**
+     * @brief Construct a new GameLoop object
+     * 
+     * @param t_updateRate Simulation steps per second
+     * @param t_maxSteps Most steps run in a single frame
+     */
+    explicit GameLoop(const float t_updateRate = CURLY_GAME_LOOP_DEFAULT_RATE, const cfg::uint32 t_maxSteps = CURLY_GAME_LOOP_DEFAULT_STEPS);
+    /**
+     * @brief Destroy the GameLoop object
+     * 
+     */
+    virtual ~GameLoop();
+
+    /**
+     * @brief Set the Update Rate
+     * 
+     * @param t_updateRate 
+     */
+    void setUpdateRate(const float t_updateRate);
+    /**
+     * @brief Set the most steps run in a single frame
+     * 
+     * @param t_maxSteps 
+     */
+    void setMaxSteps(const cfg::uint32 t_maxSteps);
+    /**
+     * @brief Scale the simulated time (slow motion, pause with 0)
+     * 
+     * @param t_timeScale 
+     */
+    void setTimeScale(const float t_timeScale);
+    /**
+     * @brief Snap frame times to the period of a FramePacer
+     * 
+     * @param t_framePacer 
+     */
+    void setFramePacer(const FramePacer& t_framePacer);
+
+    /**
+     * @brief Restart the clock and empty the accumulator, call it after long stalls like loading
+     * 
+     */
+    void restart();
+    /**
+     * @brief Sample the clock once and run the steps that are due
+     * 
+     * @param t_update 
+     * @return cfg::uint32 steps run this frame
+     */
+    cfg::uint32 advance(const std::function<void(const cfg::secT)>& t_update);
+    /**
+     * @brief Run frames until beginFrame returns false
+     * 
+     * @param t_callbacks 
+     */
+    void run(const GameLoopCallbacks& t_callbacks);
+
+    /**
+     * @brief Get the interpolation alpha between the previous and the current simulation state
+     * 
+     * @return float in [0, 1)
+     */
+    float getAlpha() const;
+    /**
+     * @brief Get the Fixed Delta Time
+     * 
+     * @return cfg::secT 
+     */
+    cfg::secT getFixedDeltaTime() const;
+    /**
+     * @brief Get the Update Rate
+     * 
+     * @return float 
+     */
+    float getUpdateRate() const;
+    /**
+     * @brief Get the Stats
+     * 
+     * @return GameLoopStats 
+     */
+    GameLoopStats getStats() const;
+
+private:
+    cfg::nanoT snapFrameTime(const cfg::nanoT t_frameTime);
+    double getSnapPeriod() const;
+
+    cfg::nanoT m_step;
+    cfg::nanoT m_accumulator;
+    cfg::nanoT m_snapResidual;
+    cfg::nanoT m_lastTime;
+    cfg::uint32 m_maxSteps;
+    float m_timeScale;
+    float m_alpha;
+
+    const FramePacer* m_framePacer;
+    GameLoopStats m_stats;
+};
+
+} // namespace sys
@@ -0,0 +1,204 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/profiler.hpp>
+
+#include <vector>
+
+/**
+ * Counter zones follow the profiler switch (C__CURLY_PROFILER) and
+ * are meant for coarse scopes: each one reads the counters twice
+ */
+#if defined(C__CURLY_PROFILER)
+    #define CURLY_PROFILE_COUNTERS(name) const ::sys::PerfCounterZone CURLY_PROFILE_CONCAT(curlyPerfCounterZone, __LINE__) {name}
+#else
+    #define CURLY_PROFILE_COUNTERS(name) static_cast<void>(0)
+#endif
+
+namespace sys
+{
+/**
+ * @brief Hardware counters captured by counter zones
+ * 
+ */
+enum PerfCounter : cfg::uint8
+{
+    PERF_INSTRUCTIONS  = 0,
+    PERF_CYCLES        = 1,
+    PERF_CACHE_MISSES  = 2,
+    PERF_BRANCH_MISSES = 3,
+    PERF_COUNTER_COUNT = 4
+};
+
+/**
+ * @brief Counter values, counters that could not be opened stay at 0
+ * 
+ */
+struct PerfCounterSample
+{
+    cfg::uint64 values[PERF_COUNTER_COUNT];
+};
+
+/**
+ * @brief Counters aggregated over every call of a zone
+ * 
+ */
+struct PerfZoneStats
+{
+    /**
+     * @brief Owned by PerfCounters, valid until reset()
+     * 
+     */
+    const char* name;
+    cfg::uint64 calls;
+    PerfCounterSample totals;
+};
+
+/**
+ * @brief PerfCounters Class that reads the hardware counters of the calling thread
+ * On linux every thread lazily opens a perf_event_open group (user space only) and reads it
+ * with rdpmc when the kernel allows it, or with a single read() of the group otherwise
+ * When perf events are not available (no PMU, perf_event_paranoid, other platforms)
+ * isAvailable() is false and counter zones cost a single branch
+ * 
+ */
+class CURLY_API PerfCounters final
+{
+public:
+    PerfCounters() = delete;
+
+    /**
+     * @brief Check whether the calling thread can read counters
+     * 
+     * @return true 
+     * @return false 
+     */
+    static bool isAvailable();
+    /**
+     * @brief Check whether a single counter could be opened on the calling thread
+     * 
+     * @param t_counter 
+     * @return true 
+     * @return false 
+     */
+    static bool isCounterAvailable(const PerfCounter t_counter);
+
+    /**
+     * @brief Read the counters of the calling thread
+     * 
+     * @param t_sample 
+     * @return true if the sample is valid
+     */
+    static bool read(PerfCounterSample& t_sample);
+    /**
+     * @brief Add the difference of two samples to a zone
+     * 
+     * @param t_name Zones with the same text share one aggregate, wherever the string lives
+     * @param t_begin 
+     * @param t_end 
+     */
+    static void recordZone(const char* t_name, const PerfCounterSample& t_begin, const PerfCounterSample& t_end);
+
+    /**
+     * @brief Close the current frame, its zones become the last frame stats
+     * 
+     */
+    static void endFrame();
+    /**
+     * @brief Clear every aggregate
+     * 
+     */
+    static void reset();
+
+    /**
+     * @brief Get the zones aggregated since the last reset
+     * 
+     * @return std::vector<PerfZoneStats> 
+     */
+    static std::vector<PerfZoneStats> getZoneStats();
+    /**
+     * @brief Get the zones aggregated over the last closed frame
+     * 
+     * @return std::vector<PerfZoneStats> 
+     */
+    static std::vector<PerfZoneStats> getLastFrameStats();
+
+    /**
+     * @brief Get the instructions per cycle of a zone
+     * 
+     * @param t_stats 
+     * @return double 
+     */
+    static double getIPC(const PerfZoneStats& t_stats);
+    /**
+     * @brief Get the cache misses per thousand instructions of a zone
+     * 
+     * @param t_stats 
+     * @return double 
+     */
+    static double getCacheMPKI(const PerfZoneStats& t_stats);
+    /**
+     * @brief Get the branch mispredicts per thousand instructions of a zone
+     * 
+     * @param t_stats 
+     * @return double 
+     */
+    static double getBranchMPKI(const PerfZoneStats& t_stats);
+};
+
+/**
+ * @brief RAII counter zone, use it through CURLY_PROFILE_COUNTERS
+ * 
+ */
+class PerfCounterZone final
+{
+public:
+    /**
+     * @brief Open the zone
+     * 
+     * @param t_name 
+     */
+    explicit PerfCounterZone(const char* t_name);
+    /**
+     * @brief Close and record the zone
+     * 
+     */
+    ~PerfCounterZone();
+
+    PerfCounterZone(const PerfCounterZone&) = delete;
+    PerfCounterZone& operator=(const PerfCounterZone&) = delete;
+
+private:
+    const char* m_name;
+    PerfCounterSample m_begin;
+    bool m_active;
+};
+
+} // namespace sys
+
+#include <system/perfCounters.inl>
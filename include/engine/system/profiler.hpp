@@ -0,0 +1,205 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/clock.hpp>
+
+#include <string>
+#include <vector>
+
+#define CURLY_PROFILER_THREAD_CAPACITY (1u << 16)
+#define CURLY_PROFILER_RECORD_CAPACITY (1u << 20)
+
+#define CURLY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CURLY_PROFILE_CONCAT(a, b) CURLY_PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * Profiling zones are compiled in only when C__CURLY_PROFILER is defined
+ * (CMake option CURLY_PROFILER), otherwise the macros expand to nothing
+ * The zone name must outlive the capture, string literals are the expected use
+ */
+#if defined(C__CURLY_PROFILER)
+    #define CURLY_PROFILE_SCOPE(name) const ::sys::ProfileZone CURLY_PROFILE_CONCAT(curlyProfileZone, __LINE__) {name}
+    #define CURLY_PROFILE_FUNCTION() CURLY_PROFILE_SCOPE(__func__)
+    #define CURLY_PROFILE_THREAD(name) ::sys::Profiler::setThreadName(name)
+#else
+    #define CURLY_PROFILE_SCOPE(name) static_cast<void>(0)
+    #define CURLY_PROFILE_FUNCTION() static_cast<void>(0)
+    #define CURLY_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+namespace sys
+{
+/**
+ * @brief A closed profiling zone, timestamps are raw Clock ticks
+ * 
+ */
+struct ProfileEvent
+{
+    const char* name;
+    cfg::uint64 begin;
+    cfg::uint64 end;
+};
+
+/**
+ * @brief A collected profiling zone tagged with the track (thread) that recorded it
+ * 
+ */
+struct ProfileRecord
+{
+    ProfileEvent event;
+    cfg::uint32 thread;
+};
+
+/**
+ * @brief Profiler Class that owns the per thread event rings and collects them
+ * Every thread records into its own ring buffer, which is written only by that thread
+ * and read by the collector without locks: the collector copies the events it has not
+ * seen yet and drops the ones the producer may have overwritten meanwhile, so a thread
+ * that records faster than collect() is called loses its oldest events, never blocks
+ * Each slot carries a sequence number that is claimed before and published after the write,
+ * so the collector also drops slots it catches half written
+ * A ring is drained and recycled when its thread exits, and the collected events are a rolling
+ * window of the most recent ones, so long sessions with short lived threads stay bounded
+ * 
+ */
+class CURLY_API Profiler final
+{
+public:
+    Profiler() = delete;
+
+    /**
+     * @brief Record a zone on the calling thread
+     * 
+     * @param t_name 
+     * @param t_begin 
+     * @param t_end 
+     */
+    static void record(const char* t_name, const cfg::uint64 t_begin, const cfg::uint64 t_end);
+    /**
+     * @brief Name the calling thread in the exported trace
+     * 
+     * @param t_name 
+     */
+    static void setThreadName(const std::string& t_name);
+    /**
+     * @brief Create a track that is not bound to a thread, for events timed elsewhere (GPU)
+     * 
+     * @param t_name 
+     * @return cfg::uint32 the track to pass to recordOnTrack
+     */
+    static cfg::uint32 createTrack(const std::string& t_name);
+    /**
+     * @brief Record a zone on a track, straight into the collected events
+     * It takes the collector lock, so it is meant for a few events per frame
+     * 
+     * @param t_track 
+     * @param t_name 
+     * @param t_begin 
+     * @param t_end 
+     */
+    static void recordOnTrack(const cfg::uint32 t_track, const char* t_name, const cfg::uint64 t_begin, const cfg::uint64 t_end);
+
+    /**
+     * @brief Enable or disable recording at runtime
+     * 
+     * @param t_enabled 
+     */
+    static void setEnabled(const bool t_enabled);
+    /**
+     * @brief Check whether zones are being recorded
+     * 
+     * @return true 
+     * @return false 
+     */
+    static bool isEnabled();
+    /**
+     * @brief Set how many collected events are kept, the oldest ones are discarded first
+     * 
+     * @param t_capacity 0 keeps every event
+     */
+    static void setRecordCapacity(const cfg::uint64 t_capacity);
+
+    /**
+     * @brief Move every new event of every thread into the collected list
+     * Call it at least once per frame or so, it is cheap
+     * 
+     * @return cfg::uint64 the number of events dropped since the last collect
+     */
+    static cfg::uint64 collect();
+    /**
+     * @brief Get the collected events, at most about the record capacity of the most recent ones
+     * 
+     * @return const std::vector<ProfileRecord>& 
+     */
+    static const std::vector<ProfileRecord>& getRecords();
+    /**
+     * @brief Discard the collected events
+     * 
+     */
+    static void clear();
+
+    /**
+     * @brief Collect and write the events as Chrome trace event JSON
+     * The file opens in chrome://tracing and in the Perfetto UI
+     * 
+     * @param t_path 
+     * @return true if the file was written
+     */
+    static bool writeChromeTrace(const std::string& t_path);
+};
+
+/**
+ * @brief RAII profiling zone, use it through CURLY_PROFILE_SCOPE
+ * 
+ */
+class ProfileZone final
+{
+public:
+    /**
+     * @brief Open the zone
+     * 
+     * @param t_name 
+     */
+    explicit ProfileZone(const char* t_name);
+    /**
+     * @brief Close and record the zone
+     * 
+     */
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    cfg::uint64 m_begin;
+};
+
+} // namespace sys
+
+#include <system/profiler.inl>
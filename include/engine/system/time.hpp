@@ -37,7 +37,8 @@ class Time final
     friend constexpr Time seconds(cfg::secT seconds);
     friend constexpr Time milliseconds(cfg::milliT milliseconds);
     friend constexpr Time microseconds(cfg::microT microseconds);
-    friend constexpr Time rawTimeBuilder(cfg::microT microseconds);
+    friend constexpr Time nanoseconds(cfg::nanoT nanoseconds);
+    friend constexpr Time rawTimeBuilder(cfg::nanoT nanoseconds);
 public:
     /**
      * @brief Construct a new Time object
@@ -64,12 +65,18 @@ public:
      */
     constexpr cfg::microT asMicroseconds() const;
     /**
-     * @brief Get the Raw Time Count as microseconds
-     * It's equivalent to asMicroseconds function
+     * @brief Get the Time Point value as nanoseconds
      * 
-     * @return microT 
+     * @return nanoT 
      */
-    constexpr cfg::microT getRawTimeCount() const;
+    constexpr cfg::nanoT asNanoseconds() const;
+    /**
+     * @brief Get the Raw Time Count as nanoseconds
+     * It's equivalent to asNanoseconds function
+     * 
+     * @return nanoT 
+     */
+    constexpr cfg::nanoT getRawTimeCount() const;
 
 private:
     /**
@@ -78,10 +85,10 @@ private:
      * 
      * @param t_timeCount 
      */
-    constexpr explicit Time(cfg::microT t_timeCount);
+    constexpr explicit Time(cfg::nanoT t_timeCount);
 
 private:
-    cfg::microT m_timeCount;
+    cfg::nanoT m_timeCount;
 };
 
 /**
@@ -105,15 +112,22 @@ constexpr Time milliseconds(cfg::milliT milliseconds);
  * @return Time 
  */
 constexpr Time microseconds(cfg::microT microseconds);
+/**
+ * @brief Construct a new Time object given nanoseconds amount
+ * 
+ * @param nanoseconds 
+ * @return Time 
+ */
+constexpr Time nanoseconds(cfg::nanoT nanoseconds);
 
 /**
- * @brief Construct a new Time object given microseconds amount
- * It's equivalent to microseconds function
+ * @brief Construct a new Time object given nanoseconds amount
+ * It's equivalent to nanoseconds function
  * 
- * @param microseconds 
+ * @param nanoseconds 
  * @return Time 
  */
-constexpr Time rawTimeBuilder(cfg::microT microseconds);
+constexpr Time rawTimeBuilder(cfg::nanoT nanoseconds);
 
 /**
  * @brief Compare two Time Point values
@@ -28,49 +28,59 @@ inline constexpr Time::Time()
 {
 }
 
-inline constexpr Time::Time(cfg::microT t_timeCount)
+inline constexpr Time::Time(cfg::nanoT t_timeCount)
     : m_timeCount {t_timeCount}
 {
 }
 
 inline constexpr cfg::secT Time::asSeconds() const
 {
-    return static_cast<cfg::secT>(m_timeCount) / 1000000.0f;
+    return static_cast<cfg::secT>(static_cast<double>(m_timeCount) / 1000000000.0);
 }
 
 inline constexpr cfg::milliT Time::asMilliseconds() const
 {
-    return static_cast<cfg::milliT>(m_timeCount / 1000);
+    return static_cast<cfg::milliT>(m_timeCount / 1000000);
 }
 
 inline constexpr cfg::microT Time::asMicroseconds() const
+{
+    return static_cast<cfg::microT>(m_timeCount / 1000);
+}
+
+inline constexpr cfg::nanoT Time::asNanoseconds() const
 {
     return m_timeCount;
 }
 
-inline constexpr cfg::microT Time::getRawTimeCount() const
+inline constexpr cfg::nanoT Time::getRawTimeCount() const
 {
     return m_timeCount;
 }
 
 inline constexpr Time seconds(cfg::secT seconds)
 {
-    return Time {static_cast<cfg::microT>(seconds * 1000000.0f)};
+    return Time {static_cast<cfg::nanoT>(static_cast<double>(seconds) * 1000000000.0)};
 }
 
 inline constexpr Time milliseconds(cfg::milliT milliseconds)
 {
-    return Time {static_cast<cfg::microT>(milliseconds * 1000)};
+    return Time {static_cast<cfg::nanoT>(milliseconds) * 1000000};
 }
 
 inline constexpr Time microseconds(cfg::microT microseconds)
 {
-    return Time {microseconds};
+    return Time {static_cast<cfg::nanoT>(microseconds) * 1000};
+}
+
+inline constexpr Time nanoseconds(cfg::nanoT nanoseconds)
+{
+    return Time {nanoseconds};
 }
 
-inline constexpr Time rawTimeBuilder(cfg::microT microseconds)
+inline constexpr Time rawTimeBuilder(cfg::nanoT nanoseconds)
 {
-    return Time {microseconds};
+    return Time {nanoseconds};
 }
 
 inline constexpr bool operator==(const Time& lhs, const Time& rhs)
@@ -120,42 +130,42 @@ inline constexpr Time operator-(const Time& lhs, const Time& rhs)
 
 inline constexpr Time operator*(const Time& lhs, float rhs)
 {
-    return rawTimeBuilder(lhs.getRawTimeCount() * static_cast<cfg::microT>(rhs));
+    return rawTimeBuilder(static_cast<cfg::nanoT>(static_cast<double>(lhs.getRawTimeCount()) * static_cast<double>(rhs)));
 }
 
 inline constexpr Time operator*(const Time& lhs, cfg::int64 rhs)
 {
-    return rawTimeBuilder(lhs.getRawTimeCount() * static_cast<cfg::microT>(rhs));
+    return rawTimeBuilder(lhs.getRawTimeCount() * static_cast<cfg::nanoT>(rhs));
 }
 
 inline constexpr Time operator*(float lhs, const Time& rhs)
 {
-    return rawTimeBuilder(static_cast<cfg::microT>(lhs) * rhs.getRawTimeCount());
+    return rhs * lhs;
 }
 
 inline constexpr Time operator*(cfg::int64 lhs, const Time& rhs)
 {
-    return rawTimeBuilder(static_cast<cfg::microT>(lhs) * rhs.getRawTimeCount());
+    return rhs * lhs;
 }
 
 inline constexpr Time operator/(const Time& lhs, float rhs)
 {
-    return rawTimeBuilder(lhs.getRawTimeCount() / static_cast<cfg::microT>(rhs));
+    return rawTimeBuilder(static_cast<cfg::nanoT>(static_cast<double>(lhs.getRawTimeCount()) / static_cast<double>(rhs)));
 }
 
 inline constexpr Time operator/(const Time& lhs, cfg::int64 rhs)
 {
-    return rawTimeBuilder(lhs.getRawTimeCount() / static_cast<cfg::microT>(rhs));
+    return rawTimeBuilder(lhs.getRawTimeCount() / static_cast<cfg::nanoT>(rhs));
 }
 
 inline constexpr Time operator/(float lhs, const Time& rhs)
 {
-    return rawTimeBuilder(static_cast<cfg::microT>(lhs) / rhs.getRawTimeCount());
+    return rawTimeBuilder(static_cast<cfg::nanoT>(static_cast<double>(lhs) / static_cast<double>(rhs.getRawTimeCount())));
 }
 
 inline constexpr Time operator/(cfg::int64 lhs, const Time& rhs)
 {
-    return rawTimeBuilder(static_cast<cfg::microT>(lhs) / rhs.getRawTimeCount());
+    return rawTimeBuilder(static_cast<cfg::nanoT>(lhs) / rhs.getRawTimeCount());
 }
 
 inline Time& operator+=(Time& lhs, const Time& rhs)
@@ -27,6 +27,8 @@
 #include <core/common.hpp>
 
 #include <system/time.hpp>
+#include <system/frameStats.hpp>
+#include <system/timerWheel.hpp>
 
 namespace sys
 {
@@ -49,7 +51,7 @@ public:
     virtual ~Timer();
 
     /**
-     * @brief Update the timer
+     * @brief Update the timer, sampling the Clock once
      * 
      */
     void tick();
@@ -77,15 +79,27 @@ public:
      * @return cfg::uint32 
      */
     cfg::uint32 getFramesPerSecond();
+    /**
+     * @brief Get the Frame Stats fed by every tick
+     * 
+     * @return FrameStats& 
+     */
+    FrameStats& getFrameStats();
+    /**
+     * @brief Get the Timer Wheel advanced by every tick
+     * 
+     * @return TimerWheel& 
+     */
+    TimerWheel& getTimerWheel();
 
 private:
-    cfg::secT procDeltaTime();
-    cfg::secT procTotalElapsedTime();
-    cfg::secT procCurrentElapsedTime();
+    cfg::secT procDeltaTime(const Time& t_now);
+    cfg::secT procTotalElapsedTime(const Time& t_now);
+    cfg::secT procCurrentElapsedTime(const Time& t_now);
 
-    cfg::microT m_start;
-    cfg::microT m_currentStart;
-    cfg::microT m_lastTime;
+    cfg::nanoT m_start;
+    cfg::nanoT m_currentStart;
+    cfg::nanoT m_lastTime;
 
     cfg::secT m_deltaTime;
     cfg::secT m_currentTime;
@@ -94,6 +108,9 @@ private:
 
     cfg::secT m_period;
     bool m_debugMode;
+
+    FrameStats m_frameStats;
+    TimerWheel m_timerWheel;
 };
 
 } // namespace sys
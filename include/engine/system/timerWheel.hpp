@@ -0,0 +1,158 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/time.hpp>
+
+#include <vector>
+#include <functional>
+
+#define CURLY_INVALID_TIMER 0ull
+#define CURLY_TIMER_WHEEL_LEVELS 4u
+#define CURLY_TIMER_WHEEL_SLOT_BITS 8u
+#define CURLY_TIMER_WHEEL_SLOTS (1u << CURLY_TIMER_WHEEL_SLOT_BITS)
+
+namespace sys
+{
+using TimerHandle = cfg::uint64;
+
+/**
+ * @brief TimerWheel Class that schedules callbacks for thousands of timers at O(1) cost each
+ * Time advances in ticks of a fixed resolution, timers due in the next 256 ticks live in the
+ * first level, the following levels cover 256 times more each and their slots are cascaded
+ * down when the first level wraps, so schedule and cancel never sort anything
+ * Timers are pooled, a handle keeps a generation so cancelling a fired timer is harmless
+ * Callbacks run inside advance() and may schedule or cancel timers, including their own
+ * 
+ */
+class CURLY_API TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Construct a new TimerWheel object
+     * 
+     * @param t_resolution Length of a tick, delays are rounded up to it
+     */
+    explicit TimerWheel(const Time& t_resolution = milliseconds(1));
+    /**
+     * @brief Destroy the TimerWheel object
+     * 
+     */
+    virtual ~TimerWheel();
+
+    /**
+     * @brief Schedule a callback
+     * 
+     * @param t_delay Time from now, it fires on the first tick at or after it
+     * @param t_callback 
+     * @param t_period Repeat interval, zero for a one-shot timer
+     * @return TimerHandle 
+     */
+    TimerHandle schedule(const Time& t_delay, Callback t_callback, const Time& t_period = Time {});
+    /**
+     * @brief Cancel a timer
+     * 
+     * @param t_handle 
+     * @return true if the timer was pending
+     */
+    bool cancel(const TimerHandle t_handle);
+    /**
+     * @brief Check whether a timer is still pending
+     * 
+     * @param t_handle 
+     * @return true 
+     * @return false 
+     */
+    bool isPending(const TimerHandle t_handle) const;
+
+    /**
+     * @brief Advance the wheel and fire every timer that comes due
+     * 
+     * @param t_elapsed 
+     * @return cfg::uint32 fired callbacks
+     */
+    cfg::uint32 advance(const Time& t_elapsed);
+    /**
+     * @brief Cancel every timer
+     * 
+     */
+    void clear();
+
+    /**
+     * @brief Get the time the wheel has advanced to
+     * 
+     * @return Time 
+     */
+    Time getCurrentTime() const;
+    /**
+     * @brief Get the Pending Count
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getPendingCount() const;
+
+private:
+    enum TimerState : cfg::uint8
+    {
+        TIMER_FREE,
+        TIMER_PENDING,
+        TIMER_FIRING,
+        TIMER_CANCELLED
+    };
+
+    struct TimerNode
+    {
+        Callback callback;
+        cfg::uint64 expires;
+        cfg::uint64 period;
+        cfg::uint32 prev;
+        cfg::uint32 next;
+        cfg::uint32 generation;
+        cfg::uint32 slot;
+        TimerState state;
+    };
+
+    TimerNode* getNode(const TimerHandle t_handle);
+    void insert(const cfg::uint32 t_index);
+    void unlink(const cfg::uint32 t_index);
+    void release(const cfg::uint32 t_index);
+    void cascade(const cfg::uint32 t_level);
+    cfg::uint32 tick();
+
+    std::vector<TimerNode> m_nodes;
+    std::vector<cfg::uint32> m_freeNodes;
+    std::vector<cfg::uint32> m_slots;
+
+    cfg::nanoT m_resolution;
+    cfg::nanoT m_remainder;
+    cfg::uint64 m_now;
+    cfg::uint64 m_pendingCount;
+};
+
+} // namespace sys
@@ -27,6 +27,7 @@
 
 #include <window/inputEvents.hpp>
 #include <window/inputBindings.hpp>
+#include <window/inputEventStream.hpp>
 #include <window/inputHandler.hpp>
 
 #include <window/iWindow.hpp>
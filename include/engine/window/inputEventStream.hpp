@@ -0,0 +1,162 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <math/vec2.hpp>
+
+#include <system/time.hpp>
+
+#include <window/inputEvents.hpp>
+#include <window/inputBindings.hpp>
+
+#include <vector>
+
+namespace wnd
+{
+/**
+ * @brief A single input event as the platform delivered it
+ * 
+ */
+struct TimedInputEvent
+{
+    InputEvent event;
+    InputCode code;
+    math::Vec2i pos;
+    /**
+     * @brief When the event happened, on the sys::Clock::now() timeline
+     * 
+     */
+    sys::Time time;
+    /**
+     * @brief Timestamp given by the platform (milliseconds of the X server or of the message queue), zero if it had none
+     * 
+     */
+    cfg::uint32 nativeTime;
+};
+
+/**
+ * @brief Maps the millisecond timestamps of the platform onto the sys::Clock::now() timeline
+ * The offset between both clocks is the smallest one seen so far, that is the event that
+ * reached us with the least delay, and the 32 bit native counter is unwrapped on the way
+ * Mapped times never run ahead of now() and never go backwards
+ * 
+ */
+class CURLY_API NativeInputClock
+{
+public:
+    NativeInputClock();
+
+    /**
+     * @brief Map a native timestamp to a Time Point, sampling now() for the offset
+     * 
+     * @param t_nativeTime 
+     * @return sys::Time 
+     */
+    sys::Time toTime(const cfg::uint32 t_nativeTime);
+
+private:
+    cfg::nanoT m_offset;
+    cfg::nanoT m_lastTime;
+    cfg::uint64 m_nativeTime;
+    cfg::uint32 m_lastNativeTime;
+    bool m_started;
+};
+
+/**
+ * @brief InputEventStream Class that keeps every input event in the order it happened
+ * Events are appended while the window polls and tick() publishes them as the events of the
+ * current frame, so two presses of the same key within one frame are both there, each with
+ * its own timestamp, and games can iterate them instead of sampling state once per frame
+ * Both buffers keep their capacity, after a few frames pushing allocates nothing
+ * 
+ */
+class CURLY_API InputEventStream
+{
+public:
+    using const_iterator = std::vector<TimedInputEvent>::const_iterator;
+
+    /**
+     * @brief Construct a new InputEventStream object
+     * 
+     * @param t_capacity Events reserved per frame
+     */
+    explicit InputEventStream(const cfg::uint32 t_capacity = 256u);
+    /**
+     * @brief Destroy the InputEventStream object
+     * 
+     */
+    virtual ~InputEventStream();
+
+    /**
+     * @brief Append an event to the ones pending for the next frame
+     * 
+     * @param t_event 
+     */
+    void push(const TimedInputEvent& t_event);
+    /**
+     * @brief Publish the pending events as the events of the current frame
+     * 
+     */
+    void tick();
+    /**
+     * @brief Drop both the pending and the current events
+     * 
+     */
+    void clear();
+
+    /**
+     * @brief Get the events of the current frame, oldest first
+     * 
+     * @return const std::vector<TimedInputEvent>& 
+     */
+    const std::vector<TimedInputEvent>& getEvents() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    cfg::uint32 size() const;
+    bool empty() const;
+
+    /**
+     * @brief Get the time tick() published the current frame
+     * 
+     * @return sys::Time 
+     */
+    sys::Time getFrameTime() const;
+    /**
+     * @brief Get the number of events published since the stream was created
+     * 
+     * @return cfg::uint64 
+     */
+    cfg::uint64 getTotalCount() const;
+
+private:
+    std::vector<TimedInputEvent> m_pending;
+    std::vector<TimedInputEvent> m_current;
+    sys::Time m_frameTime;
+    cfg::uint64 m_totalCount;
+};
+
+} // namespace wnd
@@ -34,11 +34,29 @@
 
 #include <window/inputEvents.hpp>
 #include <window/inputBindings.hpp>
+#include <window/inputEventStream.hpp>
+
+#include <initializer_list>
+
+#define CURLY_INPUT_CODE_COUNT 0x146u
+#define CURLY_INPUT_WORD_COUNT ((CURLY_INPUT_CODE_COUNT + 63u) / 64u)
 
 namespace wnd
 {
+/**
+ * @brief One bit per InputCode, plus a last word that stays zero for out of range codes
+ * 
+ */
+struct InputBits
+{
+    cfg::uint64 words[CURLY_INPUT_WORD_COUNT + 1];
+};
+
 /**
  * @brief InputHandler class that handles input
+ * Window events are recorded in an InputEventStream, tick() publishes them for the frame and
+ * replays them into fixed bitsets indexed by InputCode, deriving the pressed and released masks,
+ * so every query is a single bit test and any-key or chord queries are a few word operations
  * 
  */
 class CURLY_API InputHandler
@@ -48,46 +66,79 @@ public:
     InputHandler();
     virtual ~InputHandler();
 
-    bool onKeyDown(InputCode key);
-    bool onKeyUp(InputCode key);
-    bool onKeyReleased(InputCode key);
-    bool onKeyTriggered(InputCode key);
-
-    bool onClick(InputCode button);
-    bool onRelease(InputCode button);
-    bool onButtonDown(InputCode button);
-    bool onButtonUp(InputCode button);
-
-    math::Vec2i getMousePos();
+    bool onKeyDown(InputCode key) const;
+    bool onKeyUp(InputCode key) const;
+    bool onKeyReleased(InputCode key) const;
+    bool onKeyTriggered(InputCode key) const;
+
+    bool onClick(InputCode button) const;
+    bool onRelease(InputCode button) const;
+    bool onButtonDown(InputCode button) const;
+    bool onButtonUp(InputCode button) const;
+
+    /**
+     * @brief Check whether any key is held
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool onAnyKeyDown() const;
+    /**
+     * @brief Check whether any key was pressed this frame
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool onAnyKeyTriggered() const;
+    /**
+     * @brief Check whether every key of a chord is held
+     * 
+     * @param keys 
+     * @return true 
+     * @return false 
+     */
+    bool onChordDown(std::initializer_list<InputCode> keys) const;
+    /**
+     * @brief Check whether every key of a chord is held and one of them was pressed this frame
+     * 
+     * @param keys 
+     * @return true 
+     * @return false 
+     */
+    bool onChordTriggered(std::initializer_list<InputCode> keys) const;
+
+    math::Vec2i getMousePos() const;
+
+    /**
+     * @brief Get the Event Stream, every event of the current frame in the order it happened
+     * 
+     * @return const InputEventStream& 
+     */
+    const InputEventStream& getEventStream() const;
 
 private:
-    struct KeyInfo
+    struct InputState
     {
-        InputEvent event;
-        cfg::int32 time;
-    };
-
-    struct MouseInfo
-    {
-        InputEvent event;
-        cfg::int32 time;
+        InputBits down;
+        InputBits pressed;
+        InputBits released;
+        InputBits pressEvents;
+        InputBits releaseEvents;
     };
 
 private:
     void tick();
 
-    void initKey(InputCode key);
-    void initButton(InputCode button);
+    void pushEvent(const TimedInputEvent& event);
+    void applyEvent(const TimedInputEvent& event);
 
-    void updateKeyEvent(InputCode key, InputEvent event);
-    void updateMouseEvent(InputCode button, InputEvent event);
-    void updateMousePosition(math::Vec2i position);
+    static void updateState(InputState& state, InputCode code, bool down);
+    static void tickState(InputState& state);
 
+    InputEventStream m_eventStream;
     math::Vec2i m_mousePos;
-    Map<InputCode, KeyInfo>* m_keys;
-    Map<InputCode, MouseInfo>* m_mouseButtons;
-
-    cfg::int32 m_currentTime;
+    InputState m_keys;
+    InputState m_mouseButtons;
 };
 
 } // namespace wnd
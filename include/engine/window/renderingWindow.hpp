@@ -31,6 +31,8 @@
 #include <window/inputHandler.hpp>
 #include <window/customization.hpp>
 
+#include <system/framePacer.hpp>
+
 namespace wnd
 {
 /**
@@ -59,6 +61,22 @@ public:
      * 
      */
     void swapBuffers();
+    /**
+     * @brief Make the GL context of the Window current on the calling thread
+     * 
+     */
+    void makeContextCurrent();
+    /**
+     * @brief Release the GL context from the calling thread, so another one can take it
+     * 
+     */
+    void releaseContext();
+    /**
+     * @brief Let a Frame Pacer drive the present mode, frame limiter and latency of this Window
+     * 
+     * @param t_framePacer 
+     */
+    void setFramePacer(sys::FramePacer& t_framePacer);
 
     /**
      * @brief Check if the Window shouldn't close
@@ -117,6 +135,9 @@ protected:
     virtual void initializeWindow() override;
 
 private:
+    sys::FramePacer* m_framePacer;
+    cfg::uint32 m_presentModeVersion;
+
     /**
      * @brief Key Callback function
      * 
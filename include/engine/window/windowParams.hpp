@@ -25,6 +25,8 @@
 
 #include <math/vec2.hpp>
 
+#include <system/time.hpp>
+
 #include <window/inputBindings.hpp>
 
 namespace wnd
@@ -32,6 +34,16 @@ namespace wnd
 
 struct WindowParams
 {
+    /**
+     * @brief When the event happened, on the sys::Clock::now() timeline
+     * 
+     */
+    sys::Time time {};
+    /**
+     * @brief Millisecond timestamp given by the platform, zero if it had none
+     * 
+     */
+    cfg::uint32 nativeTime {0};
 };
 
 struct MouseParams : public WindowParams
@@ -0,0 +1,156 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/bufferAllocator.hpp>
+#include <system/clock.hpp>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#define BENCH_CAPACITY (1u << 25)
+#define BENCH_ALLOCATIONS 16384u
+#define BENCH_MAX_SIZE 2048u
+#define BENCH_COMPACT_BUDGET (1u << 16)
+#define BENCH_MAX_STEP_US 2000
+#define BENCH_MAX_STEPS (1u << 20)
+
+namespace
+{
+double elapsedNs(const sys::Time& start, const cfg::uint32 count)
+{
+    return static_cast<double>((sys::Clock::now() - start).asNanoseconds()) / count;
+}
+
+// Every unit of the shadow buffer holds the handle that owns it, so any lost or overlapping move shows up
+bool verify(const gfx::BufferAllocator& allocator, const std::vector<cfg::uint32>& shadow, const std::vector<cfg::uint32>& live)
+{
+    for(const cfg::uint32 handle : live)
+    {
+        const cfg::uint32 offset {allocator.getOffset(handle)};
+        const cfg::uint32 size {allocator.getSize(handle)};
+        for(cfg::uint32 i = 0; i < size; ++i)
+        {
+            if(shadow[offset + i] != handle)
+            {
+                std::cerr << "Allocation " << handle << " is corrupt at unit " << offset + i << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng {1234u};
+    std::uniform_int_distribution<cfg::uint32> sizeDist {1u, BENCH_MAX_SIZE};
+    std::vector<cfg::uint32> sizes(BENCH_ALLOCATIONS);
+    for(cfg::uint32& size : sizes)
+    {
+        size = sizeDist(rng);
+    }
+
+    gfx::BufferAllocator allocator {BENCH_CAPACITY};
+    std::vector<cfg::uint32> shadow(BENCH_CAPACITY, CURLY_INVALID_ALLOCATION);
+    std::vector<cfg::uint32> handles(BENCH_ALLOCATIONS);
+
+    sys::Time start {sys::Clock::now()};
+    for(cfg::uint32 i = 0; i < BENCH_ALLOCATIONS; ++i)
+    {
+        handles[i] = allocator.allocate(sizes[i], (i & 3u) == 0 ? 16u : 1u).handle;
+    }
+    const double allocateNs {elapsedNs(start, BENCH_ALLOCATIONS)};
+
+    for(const cfg::uint32 handle : handles)
+    {
+        if(handle == CURLY_INVALID_ALLOCATION)
+        {
+            std::cerr << "Allocation failed with free space left" << std::endl;
+            return 1;
+        }
+        std::fill_n(shadow.begin() + allocator.getOffset(handle), allocator.getSize(handle), handle);
+    }
+
+    // Free every other allocation in a random order to leave a fragmented buffer behind
+    std::vector<cfg::uint32> freed;
+    std::vector<cfg::uint32> live;
+    for(cfg::uint32 i = 0; i < BENCH_ALLOCATIONS; ++i)
+    {
+        ((i & 1u) ? freed : live).push_back(handles[i]);
+    }
+    std::shuffle(freed.begin(), freed.end(), rng);
+
+    start = sys::Clock::now();
+    for(const cfg::uint32 handle : freed)
+    {
+        allocator.free(handle);
+    }
+    const double freeNs {elapsedNs(start, static_cast<cfg::uint32>(freed.size()))};
+    const gfx::BufferAllocatorStats fragmented {allocator.getStats()};
+
+    // Compact in budgeted steps, replaying the moves on the shadow buffer like the GPU would
+    std::vector<gfx::BufferMove> moves;
+    cfg::uint32 steps {0};
+    cfg::uint64 movedUnits {0};
+    sys::Time worstStep {};
+    start = sys::Clock::now();
+    while(!allocator.isCompacted())
+    {
+        if(steps == BENCH_MAX_STEPS)
+        {
+            std::cerr << "Compaction did not finish after " << steps << " steps" << std::endl;
+            return 1;
+        }
+        const sys::Time stepStart {sys::Clock::now()};
+        const cfg::uint32 moved {allocator.compact(moves, BENCH_COMPACT_BUDGET)};
+        const sys::Time stepTime {sys::Clock::now() - stepStart};
+        worstStep = stepTime > worstStep ? stepTime : worstStep;
+        for(const gfx::BufferMove& move : moves)
+        {
+            std::memmove(shadow.data() + move.dstOffset, shadow.data() + move.srcOffset, move.size * sizeof(cfg::uint32));
+        }
+        movedUnits += moved;
+        ++steps;
+    }
+    const sys::Time compactTime {sys::Clock::now() - start};
+    const gfx::BufferAllocatorStats compacted {allocator.getStats()};
+
+    std::cout << "allocate      " << allocateNs << " ns/op" << std::endl;
+    std::cout << "free          " << freeNs << " ns/op" << std::endl;
+    std::cout << "fragmentation " << fragmented.fragmentation << " -> " << compacted.fragmentation
+              << " (" << fragmented.freeBlockCount << " -> " << compacted.freeBlockCount << " free blocks)" << std::endl;
+    std::cout << "compact       " << steps << " steps, " << movedUnits << " units moved, "
+              << compactTime.asMilliseconds() << " ms total, worst step " << worstStep.asMicroseconds() << " us" << std::endl;
+
+    if(worstStep > sys::microseconds(BENCH_MAX_STEP_US))
+    {
+        std::cerr << "Worst compaction step took " << worstStep.asMicroseconds() << " us, the limit is " << BENCH_MAX_STEP_US << " us" << std::endl;
+        return 1;
+    }
+    return verify(allocator, shadow, live) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/lightGrid.hpp>
+#include <system/clock.hpp>
+
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <iostream>
+
+#define BENCH_LIGHTS 4096u
+#define BENCH_ITERATIONS 50u
+
+namespace
+{
+bool overlaps(const glm::vec3& center, const float radius, const gfx::ClusterAABB& box)
+{
+    const glm::vec3 d {glm::max(glm::vec3(0.0f), glm::max(box.min - center, center - box.max))};
+    return d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius;
+}
+
+double measureMs(gfx::LightGrid& grid, const std::vector<gfx::PointLightData>& lights, const cfg::uint32 threadCount)
+{
+    const sys::Time start {sys::Clock::now()};
+    for(cfg::uint32 i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        grid.setLights(lights, glm::mat4(1.0f));
+        grid.assign(threadCount);
+    }
+    return static_cast<double>((sys::Clock::now() - start).asMicroseconds()) / 1000.0 / BENCH_ITERATIONS;
+}
+
+} // namespace
+
+int main()
+{
+    // Lights are placed straight in view space, so the view matrix stays the identity
+    std::mt19937 rng {1234u};
+    std::uniform_real_distribution<float> xyDist {-40.0f, 40.0f};
+    std::uniform_real_distribution<float> depthDist {-100.0f, -0.1f};
+    std::uniform_real_distribution<float> quadraticDist {1.0f, 8.0f};
+
+    std::vector<gfx::PointLightData> lights(BENCH_LIGHTS);
+    for(cfg::uint32 i = 0; i < BENCH_LIGHTS; ++i)
+    {
+        gfx::PointLightData& light {lights[i]};
+        light.position = {xyDist(rng), xyDist(rng), depthDist(rng)};
+        light.ambient = glm::vec3(0.0f);
+        // Every 64th light is black, its radius is zero and the grid must drop it
+        light.diffuse = (i % 64 == 0) ? glm::vec3(0.0f) : glm::vec3(1.0f);
+        light.specular = light.diffuse;
+        light.constant = 1.0f;
+        light.linear = 0.7f;
+        light.quadratic = quadraticDist(rng);
+    }
+
+    gfx::LightGrid grid;
+    grid.setProjection(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    const cfg::uint32 threadCount {std::max(std::thread::hardware_concurrency(), 1u)};
+    const double singleMs {measureMs(grid, lights, 1)};
+    const double pooledMs {measureMs(grid, lights, threadCount)};
+
+    // Brute force reference, every surviving light against every cluster
+    std::vector<glm::vec3> centers;
+    std::vector<float> radii;
+    for(const gfx::PointLightData& light : lights)
+    {
+        const float radius {gfx::LightGrid::getLightRadius(light)};
+        if(radius > 0.0f)
+        {
+            centers.push_back(light.position);
+            radii.push_back(radius);
+        }
+    }
+
+    const sys::Time bruteStart {sys::Clock::now()};
+    std::vector<std::vector<cfg::uint32>> reference(CURLY_CLUSTER_COUNT);
+    for(cfg::uint32 z = 0; z < CURLY_CLUSTER_GRID_Z; ++z)
+    {
+        for(cfg::uint32 y = 0; y < CURLY_CLUSTER_GRID_Y; ++y)
+        {
+            for(cfg::uint32 x = 0; x < CURLY_CLUSTER_GRID_X; ++x)
+            {
+                const gfx::ClusterAABB& box {grid.getClusterAABB(x, y, z)};
+                std::vector<cfg::uint32>& list {reference[x + CURLY_CLUSTER_GRID_X * (y + CURLY_CLUSTER_GRID_Y * z)]};
+                for(cfg::uint32 l = 0; l < centers.size(); ++l)
+                {
+                    if(overlaps(centers[l], radii[l], box))
+                    {
+                        list.push_back(l);
+                    }
+                }
+            }
+        }
+    }
+    const double bruteMs {static_cast<double>((sys::Clock::now() - bruteStart).asMicroseconds()) / 1000.0};
+
+    bool matches {grid.getLightCount() == centers.size()};
+    cfg::uint64 references {0};
+    const std::vector<cfg::uint32>& indices {grid.getLightIndices()};
+    for(cfg::uint32 z = 0; z < CURLY_CLUSTER_GRID_Z; ++z)
+    {
+        for(cfg::uint32 y = 0; y < CURLY_CLUSTER_GRID_Y; ++y)
+        {
+            for(cfg::uint32 x = 0; x < CURLY_CLUSTER_GRID_X; ++x)
+            {
+                const gfx::ClusterRange& range {grid.getClusterRange(x, y, z)};
+                std::vector<cfg::uint32> binned {indices.begin() + range.offset, indices.begin() + range.offset + range.count};
+                std::sort(binned.begin(), binned.end());
+                if(binned != reference[x + CURLY_CLUSTER_GRID_X * (y + CURLY_CLUSTER_GRID_Y * z)])
+                {
+                    std::cerr << "Cluster " << x << ", " << y << ", " << z << " differs from the reference" << std::endl;
+                    matches = false;
+                }
+                references += range.count;
+            }
+        }
+    }
+
+    std::cout << "lights        " << grid.getLightCount() << " of " << BENCH_LIGHTS << " binned, " << references << " cluster references" << std::endl;
+    std::cout << "1 thread      " << singleMs << " ms" << std::endl;
+    std::cout << threadCount << " threads     " << pooledMs << " ms" << std::endl;
+    std::cout << "brute force   " << bruteMs << " ms" << std::endl;
+
+    return matches ? 0 : 1;
+}
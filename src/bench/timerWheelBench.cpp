@@ -0,0 +1,98 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/timerWheel.hpp>
+#include <system/clock.hpp>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iostream>
+
+#define BENCH_TIMERS 1000000u
+#define BENCH_MAX_DELAY_MS 60000
+#define BENCH_FRAME_NS 16666667ll
+
+namespace
+{
+double elapsedNs(const sys::Time& t_start)
+{
+    return static_cast<double>((sys::Clock::now() - t_start).asNanoseconds());
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng {1234u};
+    std::uniform_int_distribution<cfg::int64> delayDist {1, BENCH_MAX_DELAY_MS};
+
+    sys::TimerWheel wheel;
+    cfg::uint64 fired {0};
+
+    std::vector<sys::TimerHandle> handles(BENCH_TIMERS);
+    sys::Time start {sys::Clock::now()};
+    for(cfg::uint32 i = 0; i < BENCH_TIMERS; ++i)
+    {
+        handles[i] = wheel.schedule(sys::milliseconds(delayDist(rng)), [&fired]() { ++fired; });
+    }
+    const double scheduleNs {elapsedNs(start) / BENCH_TIMERS};
+
+    // Cancel half of them in random order, as gameplay code drops timers of despawned objects
+    std::shuffle(handles.begin(), handles.end(), rng);
+    const cfg::uint32 cancelCount {BENCH_TIMERS / 2u};
+    start = sys::Clock::now();
+    for(cfg::uint32 i = 0; i < cancelCount; ++i)
+    {
+        wheel.cancel(handles[i]);
+    }
+    const double cancelNs {elapsedNs(start) / cancelCount};
+
+    const cfg::uint64 expected {wheel.getPendingCount()};
+    double totalAdvanceNs {0.0};
+    double worstAdvanceNs {0.0};
+    cfg::uint64 frames {0};
+    // One extra frame covers the delay rounding up to the next tick
+    while(wheel.getCurrentTime() <= sys::milliseconds(BENCH_MAX_DELAY_MS + 17))
+    {
+        start = sys::Clock::now();
+        wheel.advance(sys::nanoseconds(BENCH_FRAME_NS));
+        const double advanceNs {elapsedNs(start)};
+        totalAdvanceNs += advanceNs;
+        worstAdvanceNs = std::max(worstAdvanceNs, advanceNs);
+        ++frames;
+    }
+
+    std::cout << "timers        " << BENCH_TIMERS << " scheduled, " << cancelCount << " cancelled" << std::endl;
+    std::cout << "schedule      " << scheduleNs << " ns per timer" << std::endl;
+    std::cout << "cancel        " << cancelNs << " ns per timer" << std::endl;
+    std::cout << "advance       " << totalAdvanceNs / static_cast<double>(frames) / 1000.0 << " us per frame on average, "
+              << worstAdvanceNs / 1000.0 << " us worst, over " << frames << " frames" << std::endl;
+
+    if(fired != expected || wheel.getPendingCount() != 0)
+    {
+        std::cerr << "Fired " << fired << " timers, expected " << expected << ", " << wheel.getPendingCount() << " still pending" << std::endl;
+        return 1;
+    }
+    return 0;
+}
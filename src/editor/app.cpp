@@ -19,18 +19,56 @@ int main()
 
     wnd::InputHandler inputHandler;
     window.setInputHandler(inputHandler);
-    while (window.isActive())
+
+    sys::FramePacer framePacer;
+    window.setFramePacer(framePacer);
+
+    gfx::FrameGraph frameGraph;
+    gfx::GpuProfiler gpuProfiler;
+    frameGraph.setGpuProfiler(&gpuProfiler);
+
+    sys::GameLoop gameLoop;
+    gameLoop.setFramePacer(framePacer);
+
+    sys::GameLoopCallbacks callbacks;
+    callbacks.beginFrame = [&]()
     {
         window.pollEvents();
         if (inputHandler.onKeyTriggered(wnd::KEY_ESCAPE))
         {
             window.close();
-            continue;
         }
-        glClearColor(0.0f, 0.5f, 1.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        return window.isActive();
+    };
+    callbacks.render = [&](const float)
+    {
+        const math::Vec2i viewport {window.getViewportRect()};
+        frameGraph.reset();
+        const gfx::FrameGraphResource backBuffer {frameGraph.importTexture("BackBuffer", 0, {static_cast<cfg::uint32>(viewport.x), static_cast<cfg::uint32>(viewport.y), GL_RGBA8})};
+        frameGraph.addPass("Clear",
+            [&](gfx::FrameGraphBuilder& builder) { builder.write(backBuffer); },
+            [](const gfx::FrameGraph&)
+            {
+                glClearColor(0.0f, 0.5f, 1.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            });
+        frameGraph.compile();
+        gpuProfiler.beginFrame();
+        frameGraph.execute();
+        gpuProfiler.endFrame();
+    };
+    callbacks.endFrame = [&]()
+    {
         window.swapBuffers();
-    }
+#if defined(C__CURLY_PROFILER)
+        sys::Profiler::collect();
+        sys::PerfCounters::endFrame();
+#endif
+    };
+    gameLoop.run(callbacks);
 
+#if defined(C__CURLY_PROFILER)
+    sys::Profiler::writeChromeTrace("curly-trace.json");
+#endif
     return 0;
 }
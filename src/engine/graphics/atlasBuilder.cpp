@@ -0,0 +1,304 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/atlasBuilder.hpp>
+#include <graphics/glState.hpp>
+
+#include "../core/stb_image.h"
+#include "../core/GL/gl.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace gfx
+{
+void remapUVs(sys::Vector<float>& vertexData, const AtlasRegion& region)
+{
+    for(cfg::uint64 i = 6; i + 1 < vertexData.size(); i += 8)
+    {
+        vertexData[i]     = region.offset.x + vertexData[i]     * region.scale.x;
+        vertexData[i + 1] = region.offset.y + vertexData[i + 1] * region.scale.y;
+    }
+}
+
+AtlasBuilder::AtlasBuilder(const cfg::uint32 t_width, const cfg::uint32 t_height, const cfg::uint32 t_padding, const cfg::uint32 t_mipLevels)
+    : m_width     {t_width},
+      m_height    {t_height},
+      m_gutter    {0},
+      m_alignment {0},
+      m_mipLevels {std::max(t_mipLevels, 1u)},
+      m_texture   {0}
+{
+    // Every mip level halves the gutter, so it's scaled up to keep t_padding texels on the last level
+    // and rects are aligned so that their borders never share a texel on any level
+    m_alignment = 1u << (m_mipLevels - 1u);
+    m_gutter = t_padding * m_alignment;
+}
+
+AtlasBuilder::~AtlasBuilder()
+{
+    if(m_texture)
+    {
+        glDeleteTextures(1, &m_texture);
+        GLState::releaseTexture(m_texture);
+    }
+}
+
+cfg::uint32 AtlasBuilder::addTexture(const char* path)
+{
+    int width;
+    int height;
+    int nrComponents;
+
+    stbi_set_flip_vertically_on_load(true);
+    cfg::uint8* data {stbi_load(path, &width, &height, &nrComponents, 4)};
+    if(!data)
+    {
+        std::cout << "Texture failed to load at: " << path << std::endl;
+        const cfg::uint8 placeholder[4] {255, 255, 255, 255};
+        return addTexture(placeholder, 1u, 1u, 4u);
+    }
+
+    cfg::uint32 id {addTexture(data, width, height, 4u)};
+    stbi_image_free(data);
+
+    return id;
+}
+
+cfg::uint32 AtlasBuilder::addTexture(const cfg::uint8* pixels, const cfg::uint32 width, const cfg::uint32 height, const cfg::uint32 nrComponents)
+{
+    if(pixels == nullptr || width == 0 || height == 0 || nrComponents == 0 || nrComponents > 4)
+    {
+        std::cerr << "Atlas rejected an empty texture of " << width << "x" << height << "x" << nrComponents << std::endl;
+        return CURLY_INVALID_ATLAS_REGION;
+    }
+
+    Image image {width, height, 0, 0, std::vector<cfg::uint8>(width * height * 4)};
+    for(cfg::uint32 i = 0; i < width * height; ++i)
+    {
+        const cfg::uint8* src {pixels + i * nrComponents};
+        cfg::uint8* dst {image.pixels.data() + i * 4};
+        dst[0] = src[0];
+        dst[1] = (nrComponents > 1) ? src[1] : 0;
+        dst[2] = (nrComponents > 2) ? src[2] : 0;
+        dst[3] = (nrComponents > 3) ? src[3] : 255;
+    }
+
+    m_images.push_back(std::move(image));
+    m_regions.push_back({{0.0f, 0.0f}, {1.0f, 1.0f}});
+
+    return static_cast<cfg::uint32>(m_images.size() - 1);
+}
+
+bool AtlasBuilder::build()
+{
+    const auto alignUp = [this](const cfg::uint32 value) -> cfg::uint32 {
+        return (value + m_alignment - 1u) & ~(m_alignment - 1u);
+    };
+
+    // Tallest first gives the skyline the flattest profile
+    std::vector<cfg::uint32> order(m_images.size());
+    for(cfg::uint32 i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](const cfg::uint32 lhs, const cfg::uint32 rhs) {
+        if(m_images[lhs].height != m_images[rhs].height)
+        {
+            return m_images[lhs].height > m_images[rhs].height;
+        }
+        return m_images[lhs].width > m_images[rhs].width;
+    });
+
+    m_skyline.clear();
+    m_skyline.push_back({0, 0, m_width});
+
+    for(const cfg::uint32 id : order)
+    {
+        Image& image {m_images[id]};
+        const cfg::uint32 width {alignUp(image.width + 2 * m_gutter)};
+        const cfg::uint32 height {alignUp(image.height + 2 * m_gutter)};
+
+        cfg::uint32 index;
+        if(!findPosition(width, height, index, image.x, image.y))
+        {
+            std::cerr << "Atlas of " << m_width << "x" << m_height << " is too small to fit all the textures" << std::endl;
+            return false;
+        }
+        addSkylineLevel(index, image.x, image.y, width, height);
+    }
+
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+    for(cfg::uint32 id = 0; id < m_images.size(); ++id)
+    {
+        const Image& image {m_images[id]};
+        blitImage(image);
+
+        m_regions[id].offset = {static_cast<float>(image.x + m_gutter) / m_width, static_cast<float>(image.y + m_gutter) / m_height};
+        m_regions[id].scale  = {static_cast<float>(image.width) / m_width, static_cast<float>(image.height) / m_height};
+    }
+
+    return true;
+}
+
+cfg::uint32 AtlasBuilder::upload()
+{
+    if(m_pixels.empty())
+    {
+        return 0;
+    }
+    if(!m_texture)
+    {
+        glGenTextures(1, &m_texture);
+    }
+
+    GLState::bindTexture(GL_TEXTURE_2D, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_mipLevels - 1);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return m_texture;
+}
+
+const AtlasRegion& AtlasBuilder::getRegion(const cfg::uint32 id) const
+{
+    return m_regions[id];
+}
+
+cfg::uint32 AtlasBuilder::getTexture() const
+{
+    return m_texture;
+}
+
+cfg::uint32 AtlasBuilder::getTextureCount() const
+{
+    return static_cast<cfg::uint32>(m_images.size());
+}
+
+bool AtlasBuilder::findPosition(const cfg::uint32 width, const cfg::uint32 height, cfg::uint32& bestIndex, cfg::uint32& bestX, cfg::uint32& bestY) const
+{
+    bool found {false};
+    cfg::uint32 bestWidth {0};
+
+    for(cfg::uint32 i = 0; i < m_skyline.size(); ++i)
+    {
+        const cfg::uint32 x {m_skyline[i].x};
+        if(x + width > m_width)
+        {
+            break;
+        }
+
+        // The rect rests on the highest level it spans
+        cfg::uint32 y {0};
+        cfg::uint32 covered {0};
+        for(cfg::uint32 j = i; covered < width; ++j)
+        {
+            y = std::max(y, m_skyline[j].y);
+            covered += m_skyline[j].width;
+        }
+        if(y + height > m_height)
+        {
+            continue;
+        }
+
+        if(!found || (y < bestY) || ((y == bestY) && (m_skyline[i].width < bestWidth)))
+        {
+            found = true;
+            bestIndex = i;
+            bestX = x;
+            bestY = y;
+            bestWidth = m_skyline[i].width;
+        }
+    }
+
+    return found;
+}
+
+void AtlasBuilder::addSkylineLevel(const cfg::uint32 index, const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 width, const cfg::uint32 height)
+{
+    m_skyline.insert(m_skyline.begin() + index, {x, y + height, width});
+
+    // Shrink or drop the levels now covered by the new one
+    for(cfg::uint32 i = index + 1; i < m_skyline.size();)
+    {
+        const cfg::uint32 prevEnd {m_skyline[i - 1].x + m_skyline[i - 1].width};
+        if(m_skyline[i].x >= prevEnd)
+        {
+            break;
+        }
+
+        const cfg::uint32 shrink {prevEnd - m_skyline[i].x};
+        if(m_skyline[i].width <= shrink)
+        {
+            m_skyline.erase(m_skyline.begin() + i);
+            continue;
+        }
+        m_skyline[i].x += shrink;
+        m_skyline[i].width -= shrink;
+        break;
+    }
+
+    // Merge neighbour levels of the same height
+    for(cfg::uint32 i = 0; i + 1 < m_skyline.size();)
+    {
+        if(m_skyline[i].y == m_skyline[i + 1].y)
+        {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void AtlasBuilder::blitImage(const Image& image)
+{
+    const cfg::uint32 paddedWidth {image.width + 2 * m_gutter};
+    const cfg::uint32 paddedHeight {image.height + 2 * m_gutter};
+
+    for(cfg::uint32 ty = 0; ty < paddedHeight; ++ty)
+    {
+        // Gutter texels repeat the closest border texel so filtering never reaches a neighbour
+        const cfg::uint32 sy {std::min(ty > m_gutter ? ty - m_gutter : 0u, image.height - 1)};
+        for(cfg::uint32 tx = 0; tx < paddedWidth; ++tx)
+        {
+            const cfg::uint32 sx {std::min(tx > m_gutter ? tx - m_gutter : 0u, image.width - 1)};
+
+            const cfg::uint8* src {image.pixels.data() + (static_cast<size_t>(sy) * image.width + sx) * 4};
+            cfg::uint8* dst {m_pixels.data() + (static_cast<size_t>(image.y + ty) * m_width + (image.x + tx)) * 4};
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = src[3];
+        }
+    }
+}
+
+} // namespace gfx
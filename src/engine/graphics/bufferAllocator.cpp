@@ -0,0 +1,509 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/bufferAllocator.hpp>
+
+#include <bit>
+
+#define CURLY_TLSF_NIL 0xFFFFFFFFu
+#define CURLY_COMPACT_SEARCH_LIMIT 32u
+
+namespace gfx
+{
+BufferAllocator::BufferAllocator(const cfg::uint32 t_size)
+    : m_size             {t_size},
+      m_usedSize         {0},
+      m_freeBlockCount   {0},
+      m_firstNode        {CURLY_TLSF_NIL},
+      m_lastNode         {CURLY_TLSF_NIL},
+      m_compactCursor    {CURLY_TLSF_NIL},
+      m_compactPassMoved {false},
+      m_compacted        {true},
+      m_flBitmap         {0},
+      m_slBitmaps        {},
+      m_heads            {}
+{
+    for(cfg::uint32 fl = 0; fl < CURLY_TLSF_FL_COUNT; ++fl)
+    {
+        for(cfg::uint32 sl = 0; sl < CURLY_TLSF_SL_COUNT; ++sl)
+        {
+            m_heads[fl][sl] = CURLY_TLSF_NIL;
+        }
+    }
+
+    if(m_size > 0)
+    {
+        m_firstNode = newNode();
+        m_nodes[m_firstNode] = {0, m_size, 1, CURLY_INVALID_ALLOCATION, CURLY_TLSF_NIL, CURLY_TLSF_NIL, CURLY_TLSF_NIL, CURLY_TLSF_NIL, false};
+        insertFree(m_firstNode);
+        m_lastNode = m_firstNode;
+    }
+}
+
+BufferAllocator::~BufferAllocator()
+{
+}
+
+BufferAllocation BufferAllocator::allocate(const cfg::uint32 size, const cfg::uint32 alignment)
+{
+    const cfg::uint32 align {alignment > 0 ? alignment : 1u};
+    const cfg::uint64 request {static_cast<cfg::uint64>(size) + align - 1};
+    if((size == 0) || (request > 0xFFFFFFFFu))
+    {
+        return {CURLY_INVALID_ALLOCATION, 0, 0};
+    }
+
+    const cfg::uint32 block {findFree(static_cast<cfg::uint32>(request))};
+    if(block == CURLY_TLSF_NIL)
+    {
+        return {CURLY_INVALID_ALLOCATION, 0, 0};
+    }
+    removeFree(block);
+    const cfg::uint32 used {carve(block, size, align)};
+
+    cfg::uint32 handle;
+    if(!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_handles[handle] = used;
+    }
+    else
+    {
+        handle = static_cast<cfg::uint32>(m_handles.size());
+        m_handles.push_back(used);
+    }
+    m_nodes[used].handle = handle;
+    m_usedSize += size;
+    m_compacted = false;
+
+    return {handle, m_nodes[used].offset, size};
+}
+
+void BufferAllocator::free(const cfg::uint32 handle)
+{
+    if((handle >= m_handles.size()) || (m_handles[handle] == CURLY_TLSF_NIL))
+    {
+        return;
+    }
+
+    const cfg::uint32 used {m_handles[handle]};
+    m_usedSize -= m_nodes[used].size;
+    release(used);
+
+    m_handles[handle] = CURLY_TLSF_NIL;
+    m_freeHandles.push_back(handle);
+    m_compacted = false;
+}
+
+cfg::uint32 BufferAllocator::compact(std::vector<BufferMove>& moves, const cfg::uint32 maxSize)
+{
+    moves.clear();
+
+    cfg::uint64 work {0};
+    cfg::uint32 moved {0};
+    bool handled {false};
+    while(!m_compacted)
+    {
+        if(isPacked())
+        {
+            m_compactCursor = CURLY_TLSF_NIL;
+            m_compactPassMoved = false;
+            m_compacted = true;
+            break;
+        }
+        if(handled && (maxSize > 0) && (work >= maxSize))
+        {
+            break;
+        }
+        if(m_compactCursor == CURLY_TLSF_NIL)
+        {
+            m_compactCursor = m_lastNode;
+        }
+
+        const cfg::uint32 candidate {m_compactCursor};
+        work += CURLY_BUFFER_COMPACT_VISIT_COST;
+        if(!m_nodes[candidate].used)
+        {
+            advanceCursor();
+            handled = true;
+            continue;
+        }
+
+        const cfg::uint32 hole {findHoleBelow(candidate, work)};
+        if(hole == CURLY_TLSF_NIL)
+        {
+            advanceCursor();
+            handled = true;
+            continue;
+        }
+
+        const cfg::uint32 size {m_nodes[candidate].size};
+        if(handled && (maxSize > 0) && (work + size > maxSize))
+        {
+            // The cursor stays on the candidate, the next step retries it
+            break;
+        }
+
+        removeFree(hole);
+        const cfg::uint32 destination {carve(hole, size, m_nodes[candidate].alignment)};
+        const cfg::uint32 handle {m_nodes[candidate].handle};
+        m_nodes[destination].handle = handle;
+        m_handles[handle] = destination;
+        moves.push_back({handle, m_nodes[candidate].offset, m_nodes[destination].offset, size});
+        moved += size;
+        work += size;
+        m_compactPassMoved = true;
+
+        // Carving may have split a node right before the candidate, and releasing
+        // only ever merges into the previous node, so it stays valid to continue from
+        advanceCursor();
+        release(candidate);
+        handled = true;
+    }
+
+    return moved;
+}
+
+bool BufferAllocator::isCompacted() const
+{
+    return m_compacted;
+}
+
+cfg::uint32 BufferAllocator::getOffset(const cfg::uint32 handle) const
+{
+    return m_nodes[m_handles[handle]].offset;
+}
+
+cfg::uint32 BufferAllocator::getSize(const cfg::uint32 handle) const
+{
+    return m_nodes[m_handles[handle]].size;
+}
+
+BufferAllocatorStats BufferAllocator::getStats() const
+{
+    BufferAllocatorStats stats {};
+    stats.totalSize = m_size;
+    stats.usedSize = m_usedSize;
+    stats.freeSize = m_size - m_usedSize;
+    stats.freeBlockCount = m_freeBlockCount;
+    stats.allocationCount = static_cast<cfg::uint32>(m_handles.size() - m_freeHandles.size());
+
+    if(m_flBitmap != 0)
+    {
+        const cfg::uint32 fl {static_cast<cfg::uint32>(std::bit_width(m_flBitmap) - 1)};
+        const cfg::uint32 sl {static_cast<cfg::uint32>(std::bit_width(m_slBitmaps[fl]) - 1)};
+        for(cfg::uint32 it = m_heads[fl][sl]; it != CURLY_TLSF_NIL; it = m_nodes[it].nextFree)
+        {
+            if(m_nodes[it].size > stats.largestFreeBlock)
+            {
+                stats.largestFreeBlock = m_nodes[it].size;
+            }
+        }
+    }
+
+    if(stats.freeSize > 0)
+    {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeBlock) / static_cast<float>(stats.freeSize);
+    }
+
+    return stats;
+}
+
+cfg::uint32 BufferAllocator::newNode()
+{
+    if(!m_freeNodes.empty())
+    {
+        const cfg::uint32 index {m_freeNodes.back()};
+        m_freeNodes.pop_back();
+        return index;
+    }
+    m_nodes.push_back({});
+    return static_cast<cfg::uint32>(m_nodes.size() - 1);
+}
+
+void BufferAllocator::releaseNode(const cfg::uint32 index)
+{
+    // Nodes are only released when they merge into their previous node, which takes over the cursor
+    if(m_compactCursor == index)
+    {
+        m_compactCursor = m_nodes[index].prevPhys;
+    }
+    m_freeNodes.push_back(index);
+}
+
+void BufferAllocator::insertFree(const cfg::uint32 index)
+{
+    cfg::uint32 fl, sl;
+    mapping(m_nodes[index].size, fl, sl);
+
+    const cfg::uint32 head {m_heads[fl][sl]};
+    m_nodes[index].used = false;
+    m_nodes[index].prevFree = CURLY_TLSF_NIL;
+    m_nodes[index].nextFree = head;
+    if(head != CURLY_TLSF_NIL)
+    {
+        m_nodes[head].prevFree = index;
+    }
+    m_heads[fl][sl] = index;
+
+    m_slBitmaps[fl] |= 1u << sl;
+    m_flBitmap |= 1u << fl;
+    ++m_freeBlockCount;
+}
+
+void BufferAllocator::removeFree(const cfg::uint32 index)
+{
+    cfg::uint32 fl, sl;
+    mapping(m_nodes[index].size, fl, sl);
+
+    const cfg::uint32 prev {m_nodes[index].prevFree};
+    const cfg::uint32 next {m_nodes[index].nextFree};
+    if(prev != CURLY_TLSF_NIL)
+    {
+        m_nodes[prev].nextFree = next;
+    }
+    if(next != CURLY_TLSF_NIL)
+    {
+        m_nodes[next].prevFree = prev;
+    }
+    if(m_heads[fl][sl] == index)
+    {
+        m_heads[fl][sl] = next;
+        if(next == CURLY_TLSF_NIL)
+        {
+            m_slBitmaps[fl] &= ~(1u << sl);
+            if(m_slBitmaps[fl] == 0)
+            {
+                m_flBitmap &= ~(1u << fl);
+            }
+        }
+    }
+    --m_freeBlockCount;
+}
+
+cfg::uint32 BufferAllocator::findFree(const cfg::uint32 size) const
+{
+    cfg::uint32 fl, sl;
+    if(!searchMapping(size, fl, sl))
+    {
+        return CURLY_TLSF_NIL;
+    }
+
+    cfg::uint32 slBits {m_slBitmaps[fl] & (~0u << sl)};
+    if(slBits == 0)
+    {
+        const cfg::uint32 flBits {(fl + 1 < 32) ? (m_flBitmap & (~0u << (fl + 1))) : 0u};
+        if(flBits == 0)
+        {
+            return CURLY_TLSF_NIL;
+        }
+        fl = static_cast<cfg::uint32>(std::countr_zero(flBits));
+        slBits = m_slBitmaps[fl];
+    }
+    sl = static_cast<cfg::uint32>(std::countr_zero(slBits));
+
+    return m_heads[fl][sl];
+}
+
+cfg::uint32 BufferAllocator::findHoleBelow(const cfg::uint32 index, cfg::uint64& work) const
+{
+    const cfg::uint32 offset {m_nodes[index].offset};
+    const cfg::uint64 request {static_cast<cfg::uint64>(m_nodes[index].size) + m_nodes[index].alignment - 1};
+    cfg::uint32 fl, sl;
+    if((request > 0xFFFFFFFFu) || !searchMapping(static_cast<cfg::uint32>(request), fl, sl))
+    {
+        return CURLY_TLSF_NIL;
+    }
+
+    // Any block from the rounded up bin on fits, smaller bins come first so holes are filled tightly
+    cfg::uint32 visits {0};
+    cfg::uint32 flBits {m_flBitmap & (~0u << fl)};
+    while(flBits != 0)
+    {
+        const cfg::uint32 binFl {static_cast<cfg::uint32>(std::countr_zero(flBits))};
+        flBits &= flBits - 1;
+        cfg::uint32 slBits {m_slBitmaps[binFl] & (binFl == fl ? (~0u << sl) : ~0u)};
+        while(slBits != 0)
+        {
+            const cfg::uint32 binSl {static_cast<cfg::uint32>(std::countr_zero(slBits))};
+            slBits &= slBits - 1;
+            for(cfg::uint32 it = m_heads[binFl][binSl]; it != CURLY_TLSF_NIL; it = m_nodes[it].nextFree)
+            {
+                if(visits == CURLY_COMPACT_SEARCH_LIMIT)
+                {
+                    return CURLY_TLSF_NIL;
+                }
+                ++visits;
+                work += CURLY_BUFFER_COMPACT_VISIT_COST;
+                if(m_nodes[it].offset < offset)
+                {
+                    return it;
+                }
+            }
+        }
+    }
+    return CURLY_TLSF_NIL;
+}
+
+bool BufferAllocator::isPacked() const
+{
+    return (m_freeBlockCount == 0) || ((m_freeBlockCount == 1) && !m_nodes[m_lastNode].used);
+}
+
+void BufferAllocator::advanceCursor()
+{
+    m_compactCursor = m_nodes[m_compactCursor].prevPhys;
+    if(m_compactCursor == CURLY_TLSF_NIL)
+    {
+        // A whole pass without a single move means nothing left can be moved down
+        m_compacted = !m_compactPassMoved;
+        m_compactPassMoved = false;
+    }
+}
+
+cfg::uint32 BufferAllocator::carve(const cfg::uint32 index, const cfg::uint32 size, const cfg::uint32 alignment)
+{
+    const cfg::uint32 offset {m_nodes[index].offset};
+    const cfg::uint32 aligned {static_cast<cfg::uint32>((static_cast<cfg::uint64>(offset) + alignment - 1) / alignment * alignment)};
+
+    // Alignment padding goes back to the free lists as its own block
+    if(aligned > offset)
+    {
+        const cfg::uint32 front {newNode()};
+        const cfg::uint32 prev {m_nodes[index].prevPhys};
+        m_nodes[front] = {offset, aligned - offset, 1, CURLY_INVALID_ALLOCATION, prev, index, CURLY_TLSF_NIL, CURLY_TLSF_NIL, false};
+        if(prev != CURLY_TLSF_NIL)
+        {
+            m_nodes[prev].nextPhys = front;
+        }
+        else
+        {
+            m_firstNode = front;
+        }
+        m_nodes[index].prevPhys = front;
+        m_nodes[index].offset = aligned;
+        m_nodes[index].size -= aligned - offset;
+        insertFree(front);
+    }
+
+    if(m_nodes[index].size > size)
+    {
+        const cfg::uint32 back {newNode()};
+        const cfg::uint32 next {m_nodes[index].nextPhys};
+        m_nodes[back] = {aligned + size, m_nodes[index].size - size, 1, CURLY_INVALID_ALLOCATION, index, next, CURLY_TLSF_NIL, CURLY_TLSF_NIL, false};
+        if(next != CURLY_TLSF_NIL)
+        {
+            m_nodes[next].prevPhys = back;
+        }
+        else
+        {
+            m_lastNode = back;
+        }
+        m_nodes[index].nextPhys = back;
+        m_nodes[index].size = size;
+        insertFree(back);
+    }
+
+    m_nodes[index].used = true;
+    m_nodes[index].alignment = alignment;
+    return index;
+}
+
+void BufferAllocator::release(cfg::uint32 index)
+{
+    m_nodes[index].used = false;
+    m_nodes[index].handle = CURLY_INVALID_ALLOCATION;
+
+    const cfg::uint32 prev {m_nodes[index].prevPhys};
+    if((prev != CURLY_TLSF_NIL) && !m_nodes[prev].used)
+    {
+        removeFree(prev);
+        const cfg::uint32 next {m_nodes[index].nextPhys};
+        m_nodes[prev].size += m_nodes[index].size;
+        m_nodes[prev].nextPhys = next;
+        if(next != CURLY_TLSF_NIL)
+        {
+            m_nodes[next].prevPhys = prev;
+        }
+        else
+        {
+            m_lastNode = prev;
+        }
+        releaseNode(index);
+        index = prev;
+    }
+
+    const cfg::uint32 next {m_nodes[index].nextPhys};
+    if((next != CURLY_TLSF_NIL) && !m_nodes[next].used)
+    {
+        removeFree(next);
+        const cfg::uint32 after {m_nodes[next].nextPhys};
+        m_nodes[index].size += m_nodes[next].size;
+        m_nodes[index].nextPhys = after;
+        if(after != CURLY_TLSF_NIL)
+        {
+            m_nodes[after].prevPhys = index;
+        }
+        else
+        {
+            m_lastNode = index;
+        }
+        releaseNode(next);
+    }
+
+    insertFree(index);
+}
+
+bool BufferAllocator::searchMapping(const cfg::uint32 size, cfg::uint32& fl, cfg::uint32& sl)
+{
+    // Round up to the next bin boundary, so any block of the found bin is big enough
+    cfg::uint64 request {size};
+    if(size >= CURLY_TLSF_SL_COUNT)
+    {
+        request += (1ull << (std::bit_width(size) - 1 - CURLY_TLSF_SL_LOG2)) - 1;
+        if(request > 0xFFFFFFFFu)
+        {
+            return false;
+        }
+    }
+    mapping(static_cast<cfg::uint32>(request), fl, sl);
+    return true;
+}
+
+void BufferAllocator::mapping(const cfg::uint32 size, cfg::uint32& fl, cfg::uint32& sl)
+{
+    if(size < CURLY_TLSF_SL_COUNT)
+    {
+        fl = 0;
+        sl = size;
+    }
+    else
+    {
+        const cfg::uint32 log2 {static_cast<cfg::uint32>(std::bit_width(size) - 1)};
+        fl = log2 - CURLY_TLSF_SL_LOG2 + 1;
+        sl = (size >> (log2 - CURLY_TLSF_SL_LOG2)) - CURLY_TLSF_SL_COUNT;
+    }
+}
+
+} // namespace gfx
@@ -0,0 +1,243 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/commandList.hpp>
+
+#include <graphics/mesh.hpp>
+#include <graphics/shader.hpp>
+
+#include <external/glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+
+namespace gfx
+{
+CommandList::CommandList(const cfg::uint64 t_blockSize)
+    : m_blockSize {t_blockSize},
+      m_block     {0},
+      m_head      {0}
+{
+}
+
+CommandList::~CommandList()
+{
+    clear();
+}
+
+void CommandList::useShader(const Shader& shader)
+{
+    push(CommandType::USE_PROGRAM, UseProgramCommand {shader.getProgram()}, 0);
+}
+
+void CommandList::bindTexture(const cfg::uint32 unit, const cfg::uint32 texture)
+{
+    push(CommandType::BIND_TEXTURE, BindTextureCommand {unit, texture}, 0);
+}
+
+void CommandList::setInt(const Shader& shader, const UniformId id, const cfg::int32 value)
+{
+    push(CommandType::SET_INT, SetIntCommand {shader.getProgram(), shader.getUniformLocation(id), value}, 0);
+}
+
+void CommandList::setFloat(const Shader& shader, const UniformId id, const float value)
+{
+    push(CommandType::SET_FLOAT, SetFloatCommand {shader.getProgram(), shader.getUniformLocation(id), value}, 0);
+}
+
+void CommandList::setVec3(const Shader& shader, const UniformId id, const glm::vec3& value)
+{
+    push(CommandType::SET_VEC3, SetVec3Command {shader.getProgram(), shader.getUniformLocation(id), {value.x, value.y, value.z}}, 0);
+}
+
+void CommandList::setMat4(const Shader& shader, const UniformId id, const glm::mat4& value)
+{
+    SetMat4Command command {shader.getProgram(), shader.getUniformLocation(id), {}};
+    std::memcpy(command.value, glm::value_ptr(value), sizeof(command.value));
+    push(CommandType::SET_MAT4, command, 0);
+}
+
+void CommandList::draw(const Mesh& mesh, const Shader& shader, const glm::mat4& transform, const cfg::uint64 key,
+                       std::span<const cfg::uint32> textures, std::span<const DrawUniform> uniforms)
+{
+    constexpr UniformId modelMatrix {"model"};
+    DrawCommand command {shader.getProgram(), mesh.getVertexArray(), mesh.getIndexCount(), shader.getUniformLocation(modelMatrix), {}, 0, {}, 0, nullptr};
+    std::memcpy(command.model, glm::value_ptr(transform), sizeof(command.model));
+
+    if(textures.size() > CURLY_DRAW_MAX_TEXTURES)
+    {
+        std::cerr << "Draw packet has " << textures.size() << " textures, only " << CURLY_DRAW_MAX_TEXTURES << " are bound" << std::endl;
+    }
+    command.textureCount = static_cast<cfg::uint32>(std::min<cfg::uint64>(textures.size(), CURLY_DRAW_MAX_TEXTURES));
+    std::copy_n(textures.begin(), command.textureCount, command.textures);
+
+    if(!uniforms.empty())
+    {
+        // The values share the arena with the packet, so they move with it on merge
+        DrawUniform* storage {static_cast<DrawUniform*>(allocate(uniforms.size_bytes(), alignof(DrawUniform)))};
+        std::memcpy(storage, uniforms.data(), uniforms.size_bytes());
+        command.uniformCount = static_cast<cfg::uint32>(uniforms.size());
+        command.uniforms = storage;
+    }
+
+    push(CommandType::DRAW, command, key);
+}
+
+DrawUniform CommandList::makeUniform(const Shader& shader, const UniformId id, const cfg::int32 value)
+{
+    DrawUniform uniform {shader.getUniformLocation(id), DrawUniformType::INT, {}};
+    uniform.intValue = value;
+    return uniform;
+}
+
+DrawUniform CommandList::makeUniform(const Shader& shader, const UniformId id, const float value)
+{
+    DrawUniform uniform {shader.getUniformLocation(id), DrawUniformType::FLOAT, {}};
+    uniform.floatValues[0] = value;
+    return uniform;
+}
+
+DrawUniform CommandList::makeUniform(const Shader& shader, const UniformId id, const glm::vec3& value)
+{
+    DrawUniform uniform {shader.getUniformLocation(id), DrawUniformType::VEC3, {}};
+    std::memcpy(uniform.floatValues, glm::value_ptr(value), sizeof(glm::vec3));
+    return uniform;
+}
+
+DrawUniform CommandList::makeUniform(const Shader& shader, const UniformId id, const glm::mat4& value)
+{
+    DrawUniform uniform {shader.getUniformLocation(id), DrawUniformType::MAT4, {}};
+    std::memcpy(uniform.floatValues, glm::value_ptr(value), sizeof(glm::mat4));
+    return uniform;
+}
+
+void CommandList::merge(std::span<CommandList* const> lists, const bool sortByKey)
+{
+    // Blocks past the current one hold nothing, so they can be handed to the sources
+    const cfg::uint64 spare {m_commands.empty() ? 0 : m_block + 1};
+
+    std::vector<Block> adopted;
+    for(CommandList* list : lists)
+    {
+        if((list == this) || list->m_commands.empty())
+        {
+            continue;
+        }
+
+        m_commands.insert(m_commands.end(), list->m_commands.begin(), list->m_commands.end());
+        list->m_commands.clear();
+
+        const cfg::uint64 used {list->m_block + 1};
+        for(cfg::uint64 i = 0; i < used; ++i)
+        {
+            adopted.push_back(std::move(list->m_blocks[i]));
+            if(m_blocks.size() > spare)
+            {
+                list->m_blocks[i] = std::move(m_blocks.back());
+                m_blocks.pop_back();
+            }
+        }
+        list->m_blocks.erase(std::remove_if(list->m_blocks.begin(), list->m_blocks.end(), [](const Block& block) { return block.data == nullptr; }), list->m_blocks.end());
+        list->m_block = 0;
+        list->m_head = 0;
+    }
+
+    if(!adopted.empty())
+    {
+        for(Block& block : adopted)
+        {
+            m_blocks.push_back(std::move(block));
+        }
+        // Adopted blocks are full of live payloads, new records go to fresh blocks
+        m_block = m_blocks.size() - 1;
+        m_head = m_blocks.back().size;
+    }
+
+    if(sortByKey)
+    {
+        // State commands apply to whatever follows them, moving draws around them would change the frame
+        const bool drawsOnly {std::all_of(m_commands.begin(), m_commands.end(), [](const Command& command) {
+            return command.type == CommandType::DRAW;
+        })};
+        assert(drawsOnly && "CommandList::merge can only sort lists made of draw packets");
+        if(!drawsOnly)
+        {
+            std::cerr << "Command List holds state commands, it is kept in merge order instead of sorted" << std::endl;
+            return;
+        }
+        std::stable_sort(m_commands.begin(), m_commands.end(), [](const Command& lhs, const Command& rhs) {
+            return lhs.key < rhs.key;
+        });
+    }
+}
+
+void CommandList::clear()
+{
+    m_commands.clear();
+    m_block = 0;
+    m_head = 0;
+}
+
+std::span<const Command> CommandList::getCommands() const
+{
+    return m_commands;
+}
+
+cfg::uint64 CommandList::getCommandCount() const
+{
+    return m_commands.size();
+}
+
+bool CommandList::isEmpty() const
+{
+    return m_commands.empty();
+}
+
+void* CommandList::allocate(const cfg::uint64 size, const cfg::uint64 alignment)
+{
+    // Blocks are kept across clears, the arena just walks them again from the start
+    while(m_block < m_blocks.size())
+    {
+        Block& block {m_blocks[m_block]};
+        const cfg::uint64 base {reinterpret_cast<cfg::uint64>(block.data.get())};
+        const cfg::uint64 offset {((base + m_head + alignment - 1) & ~(alignment - 1)) - base};
+        if(offset + size <= block.size)
+        {
+            m_head = offset + size;
+            return block.data.get() + offset;
+        }
+        ++m_block;
+        m_head = 0;
+    }
+
+    const cfg::uint64 blockSize {size + alignment > m_blockSize ? size + alignment : m_blockSize};
+    m_blocks.push_back({std::make_unique<cfg::byte[]>(blockSize), blockSize});
+    m_block = m_blocks.size() - 1;
+    m_head = 0;
+
+    return allocate(size, alignment);
+}
+
+} // namespace gfx
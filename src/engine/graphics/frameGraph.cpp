@@ -0,0 +1,474 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/frameGraph.hpp>
+
+#include <graphics/glState.hpp>
+#include <graphics/gpuProfiler.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace gfx
+{
+namespace
+{
+bool isDepthFormat(const cfg::uint32 format)
+{
+    switch(format)
+    {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool isStencilFormat(const cfg::uint32 format)
+{
+    return (format == GL_DEPTH24_STENCIL8) || (format == GL_DEPTH32F_STENCIL8);
+}
+
+bool operator==(const FrameGraphTextureDesc& lhs, const FrameGraphTextureDesc& rhs)
+{
+    return (lhs.width == rhs.width) && (lhs.height == rhs.height) && (lhs.format == rhs.format);
+}
+
+} // namespace
+
+FrameGraphBuilder::FrameGraphBuilder(FrameGraph& t_graph, const cfg::uint32 t_pass)
+    : m_graph {t_graph},
+      m_pass  {t_pass}
+{
+}
+
+FrameGraphResource FrameGraphBuilder::create(const char* name, const FrameGraphTextureDesc& desc)
+{
+    return m_graph.addResource(name, FrameGraph::TRANSIENT_TEXTURE, desc, 0);
+}
+
+FrameGraphResource FrameGraphBuilder::read(const FrameGraphResource resource)
+{
+    m_graph.m_passes[m_pass].reads.push_back(resource);
+    return resource;
+}
+
+FrameGraphResource FrameGraphBuilder::write(const FrameGraphResource resource)
+{
+    m_graph.m_passes[m_pass].writes.push_back(resource);
+    m_graph.m_resources[resource].writers.push_back(m_pass);
+    if(m_graph.m_resources[resource].kind != FrameGraph::TRANSIENT_TEXTURE)
+    {
+        // Anything outside the graph may consume imported resources
+        m_graph.m_passes[m_pass].sideEffect = true;
+    }
+    return resource;
+}
+
+void FrameGraphBuilder::setSideEffect()
+{
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+FrameGraph::FrameGraph()
+    : m_frame       {0},
+      m_stats       {},
+      m_gpuProfiler {nullptr}
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+    for(const Framebuffer& framebuffer : m_framebuffers)
+    {
+        glDeleteFramebuffers(1, &framebuffer.fbo);
+    }
+    for(const PooledTexture& pooled : m_texturePool)
+    {
+        glDeleteTextures(1, &pooled.texture);
+        GLState::releaseTexture(pooled.texture);
+    }
+}
+
+FrameGraphResource FrameGraph::importTexture(const char* name, const cfg::uint32 texture, const FrameGraphTextureDesc& desc)
+{
+    return addResource(name, IMPORTED_TEXTURE, desc, texture);
+}
+
+FrameGraphResource FrameGraph::importBuffer(const char* name, const cfg::uint32 buffer)
+{
+    return addResource(name, IMPORTED_BUFFER, {0, 0, 0}, buffer);
+}
+
+void FrameGraph::addPass(const char* name, const SetupFunction& setup, ExecuteFunction execute)
+{
+    m_passes.push_back({name, std::move(execute), {}, {}, 0, false});
+    FrameGraphBuilder builder {*this, static_cast<cfg::uint32>(m_passes.size() - 1)};
+    setup(builder);
+}
+
+void FrameGraph::compile()
+{
+    m_order.clear();
+    m_stats = {};
+    m_stats.passCount = static_cast<cfg::uint32>(m_passes.size());
+
+    // A pass is referenced by what it writes, a resource by the live passes reading it
+    for(Pass& pass : m_passes)
+    {
+        pass.refCount = static_cast<cfg::uint32>(pass.writes.size()) + (pass.sideEffect ? 1 : 0);
+    }
+    for(Resource& resource : m_resources)
+    {
+        resource.refCount = 0;
+    }
+    for(const Pass& pass : m_passes)
+    {
+        if(pass.refCount > 0)
+        {
+            for(const FrameGraphResource read : pass.reads)
+            {
+                ++m_resources[read].refCount;
+            }
+        }
+    }
+
+    // Unread resources release their writers, which in turn release what they read
+    std::vector<FrameGraphResource> unreferenced;
+    for(cfg::uint32 i = 0; i < m_resources.size(); ++i)
+    {
+        if(m_resources[i].refCount == 0)
+        {
+            unreferenced.push_back(i);
+        }
+    }
+    while(!unreferenced.empty())
+    {
+        const FrameGraphResource resource {unreferenced.back()};
+        unreferenced.pop_back();
+        for(const cfg::uint32 writer : m_resources[resource].writers)
+        {
+            Pass& pass {m_passes[writer]};
+            if((pass.refCount > 0) && (--pass.refCount == 0))
+            {
+                for(const FrameGraphResource read : pass.reads)
+                {
+                    if(--m_resources[read].refCount == 0)
+                    {
+                        unreferenced.push_back(read);
+                    }
+                }
+            }
+        }
+    }
+
+    for(cfg::uint32 i = 0; i < m_passes.size(); ++i)
+    {
+        if(m_passes[i].refCount > 0)
+        {
+            m_order.push_back(i);
+        }
+    }
+    m_stats.culledPassCount = m_stats.passCount - static_cast<cfg::uint32>(m_order.size());
+
+    // Lifetimes in execution steps
+    for(Resource& resource : m_resources)
+    {
+        resource.firstUse = CURLY_INVALID_FRAME_GRAPH_RESOURCE;
+        resource.lastUse = 0;
+    }
+    for(cfg::uint32 step = 0; step < m_order.size(); ++step)
+    {
+        const Pass& pass {m_passes[m_order[step]]};
+        for(const std::vector<FrameGraphResource>* list : {&pass.reads, &pass.writes})
+        {
+            for(const FrameGraphResource resource : *list)
+            {
+                m_resources[resource].firstUse = std::min(m_resources[resource].firstUse, step);
+                m_resources[resource].lastUse = step;
+            }
+        }
+    }
+
+    // Transient targets take a free pooled texture on first use and give it back after their last one
+    for(PooledTexture& pooled : m_texturePool)
+    {
+        pooled.taken = false;
+    }
+    std::vector<cfg::uint32> poolIndices(m_resources.size(), CURLY_INVALID_FRAME_GRAPH_RESOURCE);
+    for(cfg::uint32 step = 0; step < m_order.size(); ++step)
+    {
+        const Pass& pass {m_passes[m_order[step]]};
+        for(const std::vector<FrameGraphResource>* list : {&pass.reads, &pass.writes})
+        {
+            for(const FrameGraphResource resource : *list)
+            {
+                Resource& entry {m_resources[resource]};
+                if((entry.kind == TRANSIENT_TEXTURE) && (entry.firstUse == step) && (poolIndices[resource] == CURLY_INVALID_FRAME_GRAPH_RESOURCE))
+                {
+                    poolIndices[resource] = acquireTexture(entry.desc);
+                    entry.handle = m_texturePool[poolIndices[resource]].texture;
+                    ++m_stats.transientTextureCount;
+                }
+            }
+        }
+        for(const std::vector<FrameGraphResource>* list : {&pass.reads, &pass.writes})
+        {
+            for(const FrameGraphResource resource : *list)
+            {
+                if((m_resources[resource].lastUse == step) && (poolIndices[resource] != CURLY_INVALID_FRAME_GRAPH_RESOURCE))
+                {
+                    m_texturePool[poolIndices[resource]].taken = false;
+                    poolIndices[resource] = CURLY_INVALID_FRAME_GRAPH_RESOURCE;
+                }
+            }
+        }
+    }
+
+    for(const PooledTexture& pooled : m_texturePool)
+    {
+        if(pooled.lastFrame == m_frame)
+        {
+            ++m_stats.physicalTextureCount;
+        }
+    }
+    m_stats.pooledTextureCount = static_cast<cfg::uint32>(m_texturePool.size());
+}
+
+void FrameGraph::execute()
+{
+    std::vector<cfg::uint32> attachments;
+    std::vector<cfg::uint32> formats;
+    for(const cfg::uint32 index : m_order)
+    {
+        const Pass& pass {m_passes[index]};
+
+        attachments.clear();
+        formats.clear();
+        bool hasTarget {false};
+        bool defaultFramebuffer {false};
+        cfg::uint32 width {0};
+        cfg::uint32 height {0};
+        for(const FrameGraphResource write : pass.writes)
+        {
+            const Resource& resource {m_resources[write]};
+            if(resource.kind == IMPORTED_BUFFER)
+            {
+                continue;
+            }
+
+            hasTarget = true;
+            width = resource.desc.width;
+            height = resource.desc.height;
+            if((resource.kind == IMPORTED_TEXTURE) && (resource.handle == 0))
+            {
+                defaultFramebuffer = true;
+            }
+            else
+            {
+                attachments.push_back(resource.handle);
+                formats.push_back(resource.desc.format);
+            }
+        }
+
+        if(hasTarget)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer ? 0 : getFramebuffer(attachments, formats));
+            glViewport(0, 0, width, height);
+        }
+        if(m_gpuProfiler != nullptr)
+        {
+            m_gpuProfiler->beginZone(pass.name);
+            pass.execute(*this);
+            m_gpuProfiler->endZone();
+        }
+        else
+        {
+            pass.execute(*this);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    trimPools();
+    ++m_frame;
+}
+
+void FrameGraph::reset()
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_order.clear();
+}
+
+cfg::uint32 FrameGraph::getTexture(const FrameGraphResource resource) const
+{
+    return m_resources[resource].handle;
+}
+
+cfg::uint32 FrameGraph::getBuffer(const FrameGraphResource resource) const
+{
+    return m_resources[resource].handle;
+}
+
+const FrameGraphTextureDesc& FrameGraph::getDesc(const FrameGraphResource resource) const
+{
+    return m_resources[resource].desc;
+}
+
+FrameGraphStats FrameGraph::getStats() const
+{
+    return m_stats;
+}
+
+void FrameGraph::setGpuProfiler(GpuProfiler* profiler)
+{
+    m_gpuProfiler = profiler;
+}
+
+FrameGraphResource FrameGraph::addResource(const char* name, const ResourceKind kind, const FrameGraphTextureDesc& desc, const cfg::uint32 handle)
+{
+    m_resources.push_back({name, kind, desc, handle, {}, 0, CURLY_INVALID_FRAME_GRAPH_RESOURCE, 0});
+    return static_cast<FrameGraphResource>(m_resources.size() - 1);
+}
+
+cfg::uint32 FrameGraph::acquireTexture(const FrameGraphTextureDesc& desc)
+{
+    for(cfg::uint32 i = 0; i < m_texturePool.size(); ++i)
+    {
+        PooledTexture& pooled {m_texturePool[i]};
+        if(!pooled.taken && (pooled.desc == desc))
+        {
+            pooled.taken = true;
+            pooled.lastFrame = m_frame;
+            return i;
+        }
+    }
+
+    cfg::uint32 texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, desc.format, desc.width, desc.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_texturePool.push_back({desc, texture, m_frame, true});
+    return static_cast<cfg::uint32>(m_texturePool.size() - 1);
+}
+
+cfg::uint32 FrameGraph::getFramebuffer(const std::vector<cfg::uint32>& attachments, const std::vector<cfg::uint32>& formats)
+{
+    for(Framebuffer& framebuffer : m_framebuffers)
+    {
+        if(framebuffer.attachments == attachments)
+        {
+            framebuffer.lastFrame = m_frame;
+            return framebuffer.fbo;
+        }
+    }
+
+    cfg::uint32 fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    GLenum drawBuffers[CURLY_FRAME_GRAPH_MAX_COLOR_ATTACHMENTS];
+    cfg::uint32 colorCount {0};
+    for(cfg::uint32 i = 0; i < attachments.size(); ++i)
+    {
+        if(isDepthFormat(formats[i]))
+        {
+            glFramebufferTexture(GL_FRAMEBUFFER, isStencilFormat(formats[i]) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, attachments[i], 0);
+        }
+        else if(colorCount < CURLY_FRAME_GRAPH_MAX_COLOR_ATTACHMENTS)
+        {
+            drawBuffers[colorCount] = GL_COLOR_ATTACHMENT0 + colorCount;
+            glFramebufferTexture(GL_FRAMEBUFFER, drawBuffers[colorCount], attachments[i], 0);
+            ++colorCount;
+        }
+    }
+    if(colorCount > 0)
+    {
+        glDrawBuffers(colorCount, drawBuffers);
+    }
+    else
+    {
+        glDrawBuffer(GL_NONE);
+    }
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Frame Graph framebuffer is incomplete" << std::endl;
+    }
+
+    m_framebuffers.push_back({attachments, fbo, m_frame});
+    return fbo;
+}
+
+void FrameGraph::trimPools()
+{
+    const auto isStale = [this](const cfg::uint64 lastFrame) -> bool {
+        return lastFrame + CURLY_FRAME_GRAPH_POOL_FRAMES < m_frame;
+    };
+
+    for(const PooledTexture& pooled : m_texturePool)
+    {
+        if(isStale(pooled.lastFrame))
+        {
+            glDeleteTextures(1, &pooled.texture);
+            GLState::releaseTexture(pooled.texture);
+            // Framebuffers can't outlive their attachments
+            for(Framebuffer& framebuffer : m_framebuffers)
+            {
+                if(std::find(framebuffer.attachments.begin(), framebuffer.attachments.end(), pooled.texture) != framebuffer.attachments.end())
+                {
+                    framebuffer.lastFrame = 0;
+                }
+            }
+        }
+    }
+    m_texturePool.erase(std::remove_if(m_texturePool.begin(), m_texturePool.end(), [&isStale](const PooledTexture& pooled) {
+        return isStale(pooled.lastFrame);
+    }), m_texturePool.end());
+
+    for(const Framebuffer& framebuffer : m_framebuffers)
+    {
+        if(isStale(framebuffer.lastFrame))
+        {
+            glDeleteFramebuffers(1, &framebuffer.fbo);
+        }
+    }
+    m_framebuffers.erase(std::remove_if(m_framebuffers.begin(), m_framebuffers.end(), [&isStale](const Framebuffer& framebuffer) {
+        return isStale(framebuffer.lastFrame);
+    }), m_framebuffers.end());
+}
+
+} // namespace gfx
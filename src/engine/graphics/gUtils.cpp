@@ -22,6 +22,9 @@
  ********************************************************************************/
 
 #include <graphics/gUtils.hpp>
+#include <graphics/glState.hpp>
+#include <system/profiler.hpp>
+#include <system/perfCounters.hpp>
 
 #define  STB_IMAGE_IMPLEMENTATION
 #include "../core/stb_image.h"
@@ -34,6 +37,8 @@ namespace gfx
 {
 bool loadObj(const char* path, sys::Vector<float>& vertexData, sys::Vector<cfg::uint32>& indices, bool hasNormals, bool hasUVs)
 {
+    CURLY_PROFILE_SCOPE("loadObj");
+    CURLY_PROFILE_COUNTERS("loadObj");
     sys::Vector<cfg::uint32> vertexIndices;
     sys::Vector<cfg::uint32> normalIndices;
     sys::Vector<cfg::uint32> UVIndices;
@@ -220,6 +225,7 @@ bool loadObj(const char* path, sys::Vector<float>& vertexData, sys::Vector<cfg::
 
 cfg::uint32 loadTexture(const char* path)
 {
+    CURLY_PROFILE_SCOPE("loadTexture");
     cfg::uint32 textureID;
     glGenTextures(1, &textureID);
 
@@ -249,7 +255,7 @@ cfg::uint32 loadTexture(const char* path)
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::bindTexture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -279,37 +285,80 @@ cfg::uint32 loadTexture(const char* path)
 
 void setupDefaultLights(Shader& shader, const glm::vec3& viewPos)
 {
+    constexpr UniformId materialSpecular    {"material.specular"};
+    constexpr UniformId viewPosition        {"viewPos"};
+    constexpr UniformId lightColor          {"lightColor"};
+    constexpr UniformId dirLightDirection   {"dirLight.direction"};
+    constexpr UniformId dirLightAmbient     {"dirLight.ambient"};
+    constexpr UniformId dirLightDiffuse     {"dirLight.diffuse"};
+    constexpr UniformId dirLightSpecular    {"dirLight.specular"};
+    constexpr UniformId nrPointLights       {"nrPointLights"};
+    constexpr UniformId pointLightPosition  {"pointLights[0].position"};
+    constexpr UniformId pointLightAmbient   {"pointLights[0].ambient"};
+    constexpr UniformId pointLightDiffuse   {"pointLights[0].diffuse"};
+    constexpr UniformId pointLightSpecular  {"pointLights[0].specular"};
+    constexpr UniformId pointLightConstant  {"pointLights[0].constant"};
+    constexpr UniformId pointLightLinear    {"pointLights[0].linear"};
+    constexpr UniformId pointLightQuadratic {"pointLights[0].quadratic"};
+
     glm::vec3 lightPos {1.2f, 1.0f, 2.0f};
 
     shader.use();
 
-    shader.setVec3("material.specular", 1.0f, 1.0f, 1.0f);
+    shader.setVec3(materialSpecular, 1.0f, 1.0f, 1.0f);
 
     // Setting up Fragment Shader Uniforms
-    shader.setVec3("viewPos", viewPos.x, viewPos.y, viewPos.z);
-    shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+    shader.setVec3(viewPosition, viewPos.x, viewPos.y, viewPos.z);
+    shader.setVec3(lightColor, 1.0f, 1.0f, 1.0f);
 
     // Light Parameters
     // Directional Light
-    shader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
+    shader.setVec3(dirLightDirection, -0.2f, -1.0f, -0.3f);
 
     // Light Intensity
-    shader.setVec3("dirLight.ambient", 0.2f, 0.2f, 0.2f);
-    shader.setVec3("dirLight.diffuse", 0.5f, 0.5f, 0.5f);
-    shader.setVec3("dirLight.specular", 1.0f, 1.0f, 1.0f);
+    shader.setVec3(dirLightAmbient, 0.2f, 0.2f, 0.2f);
+    shader.setVec3(dirLightDiffuse, 0.5f, 0.5f, 0.5f);
+    shader.setVec3(dirLightSpecular, 1.0f, 1.0f, 1.0f);
 
     // Point Light
-    shader.setInt("nrPointLights", 1);
+    shader.setInt(nrPointLights, 1);
+
+    shader.setVec3(pointLightPosition, lightPos.x, lightPos.y, lightPos.z);
 
-    shader.setVec3( "pointLights[0].position", lightPos.x, lightPos.y, lightPos.z);
+    shader.setVec3(pointLightAmbient, 0.2f, 0.2f, 0.2f);
+    shader.setVec3(pointLightDiffuse, 0.5f, 0.5f, 0.5f);
+    shader.setVec3(pointLightSpecular, 1.0f, 1.0f, 1.0f);
 
-    shader.setVec3( "pointLights[0].ambient", 0.2f, 0.2f, 0.2f);
-    shader.setVec3( "pointLights[0].diffuse", 0.5f, 0.5f, 0.5f);
-    shader.setVec3( "pointLights[0].specular", 1.0f, 1.0f, 1.0f);
+    shader.setFloat(pointLightConstant, 1.0f);
+    shader.setFloat(pointLightLinear, 0.09f);
+    shader.setFloat(pointLightQuadratic, 0.032f);
+}
 
-    shader.setFloat("pointLights[0].constant", 1.0f);
-    shader.setFloat("pointLights[0].linear", 0.09f);
-    shader.setFloat("pointLights[0].quadratic", 0.032f);
+LightsData getDefaultLights()
+{
+    LightsData lights {};
+    lights.lightColor = {1.0f, 1.0f, 1.0f};
+
+    lights.dirLight.direction = {-0.2f, -1.0f, -0.3f};
+    lights.dirLight.ambient   = {0.2f, 0.2f, 0.2f};
+    lights.dirLight.diffuse   = {0.5f, 0.5f, 0.5f};
+    lights.dirLight.specular  = {1.0f, 1.0f, 1.0f};
+
+    lights.nrPointLights = 1;
+    lights.pointLights[0].position  = {1.2f, 1.0f, 2.0f};
+    lights.pointLights[0].ambient   = {0.2f, 0.2f, 0.2f};
+    lights.pointLights[0].diffuse   = {0.5f, 0.5f, 0.5f};
+    lights.pointLights[0].specular  = {1.0f, 1.0f, 1.0f};
+    lights.pointLights[0].constant  = 1.0f;
+    lights.pointLights[0].linear    = 0.09f;
+    lights.pointLights[0].quadratic = 0.032f;
+
+    return lights;
+}
+
+void setupDefaultLights(UniformBlock& lightsBlock)
+{
+    lightsBlock.update(getDefaultLights());
 }
 
 } // namespace gfx
@@ -0,0 +1,303 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/geometryPool.hpp>
+
+#include <graphics/gUtils.hpp>
+#include <graphics/glState.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+#define CURLY_POOL_VERTEX_STRIDE (8 * sizeof(float))
+
+namespace gfx
+{
+GeometryPool::GeometryPool(const cfg::uint32 t_vertexCapacity, const cfg::uint32 t_indexCapacity)
+    : m_VAO            {0},
+      m_VBO            {0},
+      m_EBO            {0},
+      m_indirectBuffer {0},
+      m_vertexAllocator {t_vertexCapacity},
+      m_indexAllocator  {t_indexCapacity}
+{
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    glGenBuffers(1, &m_indirectBuffer);
+
+    GLState::bindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<cfg::uint64>(t_vertexCapacity) * CURLY_POOL_VERTEX_STRIDE, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<cfg::uint64>(t_indexCapacity) * sizeof(cfg::uint32), nullptr, GL_STATIC_DRAW);
+
+    // Position Attrib
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, CURLY_POOL_VERTEX_STRIDE, (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Normal Attrib
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, CURLY_POOL_VERTEX_STRIDE, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // UV Attrib
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, CURLY_POOL_VERTEX_STRIDE, (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // Instance Transform Attrib, selected per command through its base instance
+    for(cfg::uint32 i = 0; i < 4; ++i)
+    {
+        glVertexAttribFormat(CURLY_INSTANCE_ATTRIB_LOCATION + i, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+        glVertexAttribBinding(CURLY_INSTANCE_ATTRIB_LOCATION + i, CURLY_INSTANCE_BUFFER_BINDING);
+        glEnableVertexAttribArray(CURLY_INSTANCE_ATTRIB_LOCATION + i);
+    }
+    glVertexBindingDivisor(CURLY_INSTANCE_BUFFER_BINDING, 1);
+
+    GLState::bindVertexArray(0);
+}
+
+GeometryPool::~GeometryPool()
+{
+    glDeleteVertexArrays(1, &m_VAO);
+    GLState::releaseVertexArray(m_VAO);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+    glDeleteBuffers(1, &m_indirectBuffer);
+}
+
+cfg::uint32 GeometryPool::add(const sys::Vector<float>& vertexData, const sys::Vector<cfg::uint32>& indices)
+{
+    const cfg::uint32 vertexCount {static_cast<cfg::uint32>(vertexData.size() / 8)};
+    const cfg::uint32 indexCount {static_cast<cfg::uint32>(indices.size())};
+    const BufferAllocation vertices {m_vertexAllocator.allocate(vertexCount)};
+    const BufferAllocation elements {m_indexAllocator.allocate(indexCount)};
+    if((vertices.handle == CURLY_INVALID_ALLOCATION) || (elements.handle == CURLY_INVALID_ALLOCATION))
+    {
+        m_vertexAllocator.free(vertices.handle);
+        m_indexAllocator.free(elements.handle);
+        std::cerr << "Geometry Pool is full, can't add a mesh of " << vertexCount << " vertices" << std::endl;
+        return CURLY_INVALID_GEOMETRY;
+    }
+
+    GeometryRange range {vertices.offset, vertexCount, elements.offset, indexCount};
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<cfg::uint64>(range.baseVertex) * CURLY_POOL_VERTEX_STRIDE, static_cast<cfg::uint64>(vertexCount) * CURLY_POOL_VERTEX_STRIDE, vertexData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer binding is VAO state, the pool VAO is the one that owns it
+    GLState::bindVertexArray(m_VAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<cfg::uint64>(range.firstIndex) * sizeof(cfg::uint32), static_cast<cfg::uint64>(indexCount) * sizeof(cfg::uint32), indices.data());
+
+    cfg::uint32 geometryID;
+    if(!m_freeIDs.empty())
+    {
+        geometryID = m_freeIDs.back();
+        m_freeIDs.pop_back();
+        m_ranges[geometryID] = range;
+        m_slots[geometryID] = {vertices.handle, elements.handle};
+    }
+    else
+    {
+        geometryID = static_cast<cfg::uint32>(m_ranges.size());
+        m_ranges.push_back(range);
+        m_slots.push_back({vertices.handle, elements.handle});
+    }
+
+    if(vertices.handle >= m_vertexOwners.size())
+    {
+        m_vertexOwners.resize(vertices.handle + 1, CURLY_INVALID_GEOMETRY);
+    }
+    if(elements.handle >= m_indexOwners.size())
+    {
+        m_indexOwners.resize(elements.handle + 1, CURLY_INVALID_GEOMETRY);
+    }
+    m_vertexOwners[vertices.handle] = geometryID;
+    m_indexOwners[elements.handle] = geometryID;
+
+    return geometryID;
+}
+
+cfg::uint32 GeometryPool::add(const char* path, bool hasNormals, bool hasUVs)
+{
+    sys::Vector<float> vertexData;
+    sys::Vector<cfg::uint32> indices;
+    loadObj(path, vertexData, indices, hasNormals, hasUVs);
+    return add(vertexData, indices);
+}
+
+void GeometryPool::remove(const cfg::uint32 geometryID)
+{
+    if(!isValid(geometryID))
+    {
+        return;
+    }
+
+    Slot& slot {m_slots[geometryID]};
+    m_vertexOwners[slot.vertexHandle] = CURLY_INVALID_GEOMETRY;
+    m_indexOwners[slot.indexHandle] = CURLY_INVALID_GEOMETRY;
+    m_vertexAllocator.free(slot.vertexHandle);
+    m_indexAllocator.free(slot.indexHandle);
+    slot = {CURLY_INVALID_ALLOCATION, CURLY_INVALID_ALLOCATION};
+
+    m_ranges[geometryID] = {0, 0, 0, 0};
+    m_freeIDs.push_back(geometryID);
+}
+
+void GeometryPool::compact(const cfg::uint32 maxVertices, const cfg::uint32 maxIndices)
+{
+    // Without an index budget the vertex one is scaled by the capacity ratio of both buffers
+    cfg::uint32 indexBudget {maxIndices};
+    if((indexBudget == 0) && (maxVertices != 0))
+    {
+        const cfg::uint64 scaled {static_cast<cfg::uint64>(maxVertices) * m_indexAllocator.getStats().totalSize / m_vertexAllocator.getStats().totalSize};
+        indexBudget = static_cast<cfg::uint32>(std::clamp<cfg::uint64>(scaled, 1, 0xFFFFFFFFu));
+    }
+
+    // Indices are relative to the base vertex, so moving them needs no patching
+    m_vertexAllocator.compact(m_moves, maxVertices);
+    applyBufferMoves(m_VBO, m_moves, CURLY_POOL_VERTEX_STRIDE);
+    for(const BufferMove& move : m_moves)
+    {
+        m_ranges[m_vertexOwners[move.handle]].baseVertex = move.dstOffset;
+    }
+
+    m_indexAllocator.compact(m_moves, indexBudget);
+    applyBufferMoves(m_EBO, m_moves, sizeof(cfg::uint32));
+    for(const BufferMove& move : m_moves)
+    {
+        m_ranges[m_indexOwners[move.handle]].firstIndex = move.dstOffset;
+    }
+}
+
+void GeometryPool::draw(const cfg::uint32 geometryID, const glm::mat4& transform)
+{
+    assert(isValid(geometryID) && "GeometryPool::draw of an invalid or removed geometry");
+    if(!isValid(geometryID))
+    {
+        return;
+    }
+    m_draws.push_back({geometryID, static_cast<cfg::uint32>(m_transforms.size())});
+    m_transforms.push_back(transform);
+}
+
+void GeometryPool::submit(const Shader& shader, InstanceBuffer& instances)
+{
+    if(m_draws.empty())
+    {
+        return;
+    }
+
+    // Grouping by geometry turns every group into a single instanced command
+    std::stable_sort(m_draws.begin(), m_draws.end(), [](const DrawRecord& lhs, const DrawRecord& rhs) {
+        return lhs.geometryID < rhs.geometryID;
+    });
+
+    m_commands.clear();
+    m_instanceTransforms.clear();
+    for(cfg::uint64 i = 0; i < m_draws.size(); ++i)
+    {
+        const DrawRecord& record {m_draws[i]};
+        // A geometry removed after being drawn is skipped instead of issuing an empty command
+        if(!isValid(record.geometryID))
+        {
+            continue;
+        }
+        if(m_commands.empty() || (m_draws[i - 1].geometryID != record.geometryID))
+        {
+            const GeometryRange& range {m_ranges[record.geometryID]};
+            m_commands.push_back({range.indexCount, 0, range.firstIndex, static_cast<cfg::int32>(range.baseVertex), static_cast<cfg::uint32>(m_instanceTransforms.size())});
+        }
+        ++m_commands.back().instanceCount;
+        m_instanceTransforms.push_back(m_transforms[record.transformIndex]);
+    }
+
+    if(m_commands.empty())
+    {
+        m_draws.clear();
+        m_transforms.clear();
+        return;
+    }
+
+    // Base instances are relative to the binding offset, so the upload offset goes there
+    const cfg::uint64 instanceOffset {instances.upload(m_instanceTransforms)};
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commands.size() * sizeof(DrawElementsIndirectCommand), m_commands.data(), GL_STREAM_DRAW);
+
+    shader.use();
+    GLState::bindVertexArray(m_VAO);
+    glBindVertexBuffer(CURLY_INSTANCE_BUFFER_BINDING, instances.getBuffer(), static_cast<GLintptr>(instanceOffset), sizeof(glm::mat4));
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, static_cast<GLsizei>(m_commands.size()), 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    m_draws.clear();
+    m_transforms.clear();
+}
+
+const GeometryRange& GeometryPool::getRange(const cfg::uint32 geometryID) const
+{
+    return m_ranges[geometryID];
+}
+
+BufferAllocatorStats GeometryPool::getVertexStats() const
+{
+    return m_vertexAllocator.getStats();
+}
+
+BufferAllocatorStats GeometryPool::getIndexStats() const
+{
+    return m_indexAllocator.getStats();
+}
+
+void GeometryPool::applyBufferMoves(const cfg::uint32 buffer, const std::vector<BufferMove>& moves, const cfg::uint32 unitSize)
+{
+    if(moves.empty())
+    {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    for(const BufferMove& move : moves)
+    {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(static_cast<cfg::uint64>(move.srcOffset) * unitSize),
+                            static_cast<GLintptr>(static_cast<cfg::uint64>(move.dstOffset) * unitSize),
+                            static_cast<GLsizeiptr>(static_cast<cfg::uint64>(move.size) * unitSize));
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+bool GeometryPool::isValid(const cfg::uint32 geometryID) const
+{
+    return (geometryID < m_slots.size()) && (m_slots[geometryID].vertexHandle != CURLY_INVALID_ALLOCATION);
+}
+
+} // namespace gfx
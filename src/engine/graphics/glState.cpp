@@ -0,0 +1,223 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/glState.hpp>
+
+#include "../core/GL/gl.h"
+
+#define CURLY_UNKNOWN_STATE 0xFFFFFFFFu
+
+namespace gfx
+{
+cfg::uint32 GLState::s_program     {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_vertexArray {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_activeUnit  {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_textures[CURLY_MAX_TEXTURE_UNITS][CURLY_TRACKED_TEXTURE_TARGETS] {};
+
+cfg::uint32 GLState::s_blend     {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_blendSrc  {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_blendDst  {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_depthTest {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_depthMask {CURLY_UNKNOWN_STATE};
+cfg::uint32 GLState::s_depthFunc {CURLY_UNKNOWN_STATE};
+
+GLStateStats GLState::s_stats {0, 0};
+
+void GLState::useProgram(const cfg::uint32 program)
+{
+    if(change(s_program, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(const cfg::uint32 vertexArray)
+{
+    if(change(s_vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GLState::activeTexture(const cfg::uint32 unit)
+{
+    if(change(s_activeUnit, unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLState::bindTexture(const cfg::uint32 target, const cfg::uint32 texture)
+{
+    const cfg::int32 targetIndex {getTargetIndex(target)};
+    if((targetIndex < 0) || (s_activeUnit >= CURLY_MAX_TEXTURE_UNITS))
+    {
+        ++s_stats.requested;
+        glBindTexture(target, texture);
+        return;
+    }
+    if(change(s_textures[s_activeUnit][targetIndex], texture))
+    {
+        glBindTexture(target, texture);
+    }
+}
+
+void GLState::bindTexture(const cfg::uint32 unit, const cfg::uint32 target, const cfg::uint32 texture)
+{
+    const cfg::int32 targetIndex {getTargetIndex(target)};
+    if((targetIndex >= 0) && (unit < CURLY_MAX_TEXTURE_UNITS) && (s_textures[unit][targetIndex] == texture))
+    {
+        // Already bound there, not even the unit has to change
+        ++s_stats.requested;
+        ++s_stats.skipped;
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void GLState::setBlend(const bool enabled)
+{
+    if(change(s_blend, enabled))
+    {
+        enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+    }
+}
+
+void GLState::setBlendFunc(const cfg::uint32 srcFactor, const cfg::uint32 dstFactor)
+{
+    ++s_stats.requested;
+    if((s_blendSrc == srcFactor) && (s_blendDst == dstFactor))
+    {
+        ++s_stats.skipped;
+        return;
+    }
+    s_blendSrc = srcFactor;
+    s_blendDst = dstFactor;
+    glBlendFunc(srcFactor, dstFactor);
+}
+
+void GLState::setDepthTest(const bool enabled)
+{
+    if(change(s_depthTest, enabled))
+    {
+        enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+    }
+}
+
+void GLState::setDepthMask(const bool enabled)
+{
+    if(change(s_depthMask, enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GLState::setDepthFunc(const cfg::uint32 func)
+{
+    if(change(s_depthFunc, func))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void GLState::releaseProgram(const cfg::uint32 program)
+{
+    if(s_program == program)
+    {
+        s_program = CURLY_UNKNOWN_STATE;
+    }
+}
+
+void GLState::releaseVertexArray(const cfg::uint32 vertexArray)
+{
+    if(s_vertexArray == vertexArray)
+    {
+        s_vertexArray = 0;
+    }
+}
+
+void GLState::releaseTexture(const cfg::uint32 texture)
+{
+    for(cfg::uint32 unit = 0; unit < CURLY_MAX_TEXTURE_UNITS; ++unit)
+    {
+        for(cfg::uint32 targetIndex = 0; targetIndex < CURLY_TRACKED_TEXTURE_TARGETS; ++targetIndex)
+        {
+            if(s_textures[unit][targetIndex] == texture)
+            {
+                s_textures[unit][targetIndex] = 0;
+            }
+        }
+    }
+}
+
+void GLState::invalidate()
+{
+    s_program = s_vertexArray = s_activeUnit = CURLY_UNKNOWN_STATE;
+    for(cfg::uint32 unit = 0; unit < CURLY_MAX_TEXTURE_UNITS; ++unit)
+    {
+        for(cfg::uint32 targetIndex = 0; targetIndex < CURLY_TRACKED_TEXTURE_TARGETS; ++targetIndex)
+        {
+            s_textures[unit][targetIndex] = CURLY_UNKNOWN_STATE;
+        }
+    }
+    s_blend = s_blendSrc = s_blendDst = CURLY_UNKNOWN_STATE;
+    s_depthTest = s_depthMask = s_depthFunc = CURLY_UNKNOWN_STATE;
+}
+
+GLStateStats GLState::getStats()
+{
+    return s_stats;
+}
+
+void GLState::resetStats()
+{
+    s_stats = {0, 0};
+}
+
+bool GLState::change(cfg::uint32& cached, const cfg::uint32 value)
+{
+    ++s_stats.requested;
+    if(cached == value)
+    {
+        ++s_stats.skipped;
+        return false;
+    }
+    cached = value;
+    return true;
+}
+
+cfg::int32 GLState::getTargetIndex(const cfg::uint32 target)
+{
+    switch(target)
+    {
+        case GL_TEXTURE_2D:       return 0;
+        case GL_TEXTURE_CUBE_MAP: return 1;
+        case GL_TEXTURE_2D_ARRAY: return 2;
+        case GL_TEXTURE_3D:       return 3;
+        case GL_TEXTURE_BUFFER:   return 4;
+        default:                  return -1;
+    }
+}
+
+} // namespace gfx
@@ -0,0 +1,237 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/gpuProfiler.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include "../core/GL/gl.h"
+
+namespace gfx
+{
+GpuProfiler::GpuProfiler(const cfg::uint32 t_latency)
+    : m_frames     {std::vector<GpuQueryFrame>(std::max(t_latency, 1u))},
+      m_zoneStack  {},
+      m_results    {},
+      m_names      {},
+      m_frameIndex {0},
+      m_frameTime  {0},
+      m_stallCount {0},
+      m_frameStats {nullptr},
+      m_track      {0},
+      m_supported  {false},
+      m_inFrame    {false}
+{
+    if(GLAD_GL_VERSION_3_3 != 0)
+    {
+        cfg::int32 counterBits {0};
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+        m_supported = counterBits > 0;
+    }
+    if(!m_supported)
+    {
+        std::cerr << "GPU timestamps are not supported, GPU profiling is disabled" << std::endl;
+        return;
+    }
+
+#if defined(C__CURLY_PROFILER)
+    m_track = sys::Profiler::createTrack("GPU");
+#endif
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for(GpuQueryFrame& frame : m_frames)
+    {
+        if(!frame.queries.empty())
+        {
+            glDeleteQueries(static_cast<cfg::int32>(frame.queries.size()), frame.queries.data());
+        }
+    }
+}
+
+void GpuProfiler::beginFrame()
+{
+    if(!m_supported || m_inFrame)
+    {
+        return;
+    }
+
+    GpuQueryFrame& frame {m_frames[m_frameIndex % m_frames.size()]};
+    resolve(frame);
+
+    // GL_TIMESTAMP through glGet is the GPU clock right now, pair it with the CPU clock
+    cfg::int64 gpuNow {0};
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    frame.clockOffset = sys::Clock::now().asNanoseconds() - gpuNow;
+    frame.statsFrame  = (m_frameStats != nullptr && m_frameStats->getFrameCount() > 0) ? m_frameStats->getFrameCount() - 1u : 0u;
+    frame.usedQueries = 0;
+    frame.zones.clear();
+    frame.pending     = true;
+
+    m_inFrame = true;
+    beginZone("GPU Frame");
+}
+
+void GpuProfiler::endFrame()
+{
+    if(!m_inFrame)
+    {
+        return;
+    }
+    if(m_zoneStack.size() > 1)
+    {
+        std::cerr << "GPU profiler frame ended with " << (m_zoneStack.size() - 1) << " open zones" << std::endl;
+    }
+    while(!m_zoneStack.empty())
+    {
+        endZone();
+    }
+    m_inFrame = false;
+    ++m_frameIndex;
+}
+
+void GpuProfiler::beginZone(const char* t_name)
+{
+    if(!m_inFrame)
+    {
+        return;
+    }
+
+    GpuQueryFrame& frame {m_frames[m_frameIndex % m_frames.size()]};
+    const cfg::uint32 query {acquireQuery(frame)};
+    glQueryCounter(query, GL_TIMESTAMP);
+    m_zoneStack.push_back(static_cast<cfg::uint32>(frame.zones.size()));
+    frame.zones.push_back({t_name, query, 0, static_cast<cfg::uint32>(m_zoneStack.size() - 1)});
+}
+
+void GpuProfiler::beginZone(const std::string& t_name)
+{
+    if(!m_inFrame)
+    {
+        return;
+    }
+    // Set nodes never move, so the interned name outlives the frames in flight
+    beginZone(m_names.insert(t_name).first->c_str());
+}
+
+void GpuProfiler::endZone()
+{
+    if(!m_inFrame || m_zoneStack.empty())
+    {
+        return;
+    }
+
+    GpuQueryFrame& frame {m_frames[m_frameIndex % m_frames.size()]};
+    const cfg::uint32 query {acquireQuery(frame)};
+    glQueryCounter(query, GL_TIMESTAMP);
+    frame.zones[m_zoneStack.back()].endQuery = query;
+    m_zoneStack.pop_back();
+}
+
+void GpuProfiler::setFrameStats(sys::FrameStats& t_frameStats)
+{
+    m_frameStats = &t_frameStats;
+}
+
+const std::vector<GpuZoneResult>& GpuProfiler::getResults() const
+{
+    return m_results;
+}
+
+cfg::nanoT GpuProfiler::getFrameTime() const
+{
+    return m_frameTime;
+}
+
+cfg::uint64 GpuProfiler::getStallCount() const
+{
+    return m_stallCount;
+}
+
+bool GpuProfiler::isSupported() const
+{
+    return m_supported;
+}
+
+cfg::uint32 GpuProfiler::acquireQuery(GpuQueryFrame& t_frame)
+{
+    if(t_frame.usedQueries == t_frame.queries.size())
+    {
+        // Grow the pool of this frame, it is kept for the following frames
+        const cfg::uint32 oldSize {static_cast<cfg::uint32>(t_frame.queries.size())};
+        const cfg::uint32 newSize {std::max(oldSize * 2u, 32u)};
+        t_frame.queries.resize(newSize);
+        glGenQueries(static_cast<cfg::int32>(newSize - oldSize), t_frame.queries.data() + oldSize);
+    }
+    return t_frame.queries[t_frame.usedQueries++];
+}
+
+void GpuProfiler::resolve(GpuQueryFrame& t_frame)
+{
+    if(!t_frame.pending || t_frame.zones.empty())
+    {
+        return;
+    }
+    t_frame.pending = false;
+
+    // The frame zone closes last, once it is available every other query is too
+    // Reading GL_QUERY_RESULT before that would block until the GPU catches up, and the slot
+    // is about to be reused, so a frame that is not ready yet is dropped unread
+    cfg::int32 available {0};
+    glGetQueryObjectiv(t_frame.zones.front().endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available)
+    {
+        ++m_stallCount;
+        return;
+    }
+
+    m_results.clear();
+    for(const GpuQueryZone& zone : t_frame.zones)
+    {
+        cfg::uint64 begin {0};
+        cfg::uint64 end {0};
+        glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+
+        GpuZoneResult result {};
+        result.name  = zone.name;
+        result.begin = static_cast<cfg::nanoT>(begin) + t_frame.clockOffset;
+        result.end   = static_cast<cfg::nanoT>(end) + t_frame.clockOffset;
+        result.depth = zone.depth;
+        m_results.push_back(result);
+
+#if defined(C__CURLY_PROFILER)
+        sys::Profiler::recordOnTrack(m_track, result.name, sys::Clock::timeToTicks(sys::nanoseconds(result.begin)), sys::Clock::timeToTicks(sys::nanoseconds(result.end)));
+#endif
+    }
+
+    m_frameTime = m_results.front().end - m_results.front().begin;
+    if(m_frameStats != nullptr)
+    {
+        m_frameStats->recordGpuTime(t_frame.statsFrame, m_frameTime);
+    }
+}
+
+} // namespace gfx
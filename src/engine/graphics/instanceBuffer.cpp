@@ -0,0 +1,82 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/instanceBuffer.hpp>
+
+#include <system/dstr/vector.hpp>
+
+#include "../core/GL/gl.h"
+
+namespace gfx
+{
+InstanceBuffer::InstanceBuffer(const cfg::uint32 t_capacity)
+    : m_VBO      {0},
+      m_capacity {0},
+      m_head     {0}
+{
+    glGenBuffers(1, &m_VBO);
+    allocate(t_capacity);
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+    glDeleteBuffers(1, &m_VBO);
+}
+
+cfg::uint64 InstanceBuffer::upload(std::span<const glm::mat4> transforms)
+{
+    const cfg::uint32 count {static_cast<cfg::uint32>(transforms.size())};
+    if(count > m_capacity)
+    {
+        allocate(static_cast<cfg::uint32>(sys::hid::p2RoundUp(count)));
+    }
+    else if(m_head + count > m_capacity)
+    {
+        allocate(m_capacity);
+    }
+
+    const cfg::uint64 offset {static_cast<cfg::uint64>(m_head) * sizeof(glm::mat4)};
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, count * sizeof(glm::mat4), transforms.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_head += count;
+
+    return offset;
+}
+
+cfg::uint32 InstanceBuffer::getBuffer() const
+{
+    return m_VBO;
+}
+
+void InstanceBuffer::allocate(const cfg::uint32 capacity)
+{
+    m_capacity = capacity;
+    m_head = 0;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<cfg::uint64>(m_capacity) * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+} // namespace gfx
@@ -0,0 +1,408 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/lightGrid.hpp>
+
+#include <system/profiler.hpp>
+#include <system/perfCounters.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <cmath>
+#include <limits>
+#include <bit>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CURLY_LIGHT_GRID_SSE2
+#endif
+
+namespace gfx
+{
+namespace
+{
+/**
+ * @brief Test 4 spheres stored from x, y, z, r against a box, one mask bit per overlapping sphere
+ * 
+ */
+inline cfg::uint32 testSpheres4(const float* x, const float* y, const float* z, const float* r, const ClusterAABB& box)
+{
+#if defined(CURLY_LIGHT_GRID_SSE2)
+    const __m128 zero {_mm_setzero_ps()};
+    const __m128 cx {_mm_loadu_ps(x)};
+    const __m128 cy {_mm_loadu_ps(y)};
+    const __m128 cz {_mm_loadu_ps(z)};
+    const __m128 cr {_mm_loadu_ps(r)};
+
+    // Distance from the center to the box along every axis, zero when inside
+    const __m128 dx {_mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_set1_ps(box.min.x), cx), _mm_sub_ps(cx, _mm_set1_ps(box.max.x))))};
+    const __m128 dy {_mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_set1_ps(box.min.y), cy), _mm_sub_ps(cy, _mm_set1_ps(box.max.y))))};
+    const __m128 dz {_mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_set1_ps(box.min.z), cz), _mm_sub_ps(cz, _mm_set1_ps(box.max.z))))};
+    const __m128 distance2 {_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz))};
+
+    return static_cast<cfg::uint32>(_mm_movemask_ps(_mm_cmple_ps(distance2, _mm_mul_ps(cr, cr))));
+#else
+    cfg::uint32 mask {0};
+    for(cfg::uint32 i = 0; i < 4; ++i)
+    {
+        const float dx {std::max(0.0f, std::max(box.min.x - x[i], x[i] - box.max.x))};
+        const float dy {std::max(0.0f, std::max(box.min.y - y[i], y[i] - box.max.y))};
+        const float dz {std::max(0.0f, std::max(box.min.z - z[i], z[i] - box.max.z))};
+        if(dx * dx + dy * dy + dz * dz <= r[i] * r[i])
+        {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+inline cfg::uint32 getValidMask(const cfg::uint32 first, const cfg::uint32 count)
+{
+    return (count - first >= 4) ? 0xFu : ((1u << (count - first)) - 1u);
+}
+
+} // namespace
+
+void LightGrid::SphereSet::clear()
+{
+    index.clear();
+}
+
+void LightGrid::SphereSet::push(const float t_x, const float t_y, const float t_z, const float t_r, const cfg::uint32 t_index)
+{
+    // Components are kept padded to 4, so the last group can always be loaded whole
+    const cfg::uint32 count {size()};
+    if(count % 4 == 0 && x.size() < count + 4)
+    {
+        x.resize(count + 4);
+        y.resize(count + 4);
+        z.resize(count + 4);
+        r.resize(count + 4);
+    }
+    x[count] = t_x;
+    y[count] = t_y;
+    z[count] = t_z;
+    r[count] = t_r;
+    index.push_back(t_index);
+}
+
+cfg::uint32 LightGrid::SphereSet::size() const
+{
+    return static_cast<cfg::uint32>(index.size());
+}
+
+LightGrid::LightGrid()
+    : m_near          {0.1f},
+      m_far           {100.0f},
+      m_clusters      (CURLY_CLUSTER_COUNT),
+      m_ranges        (CURLY_CLUSTER_COUNT),
+      m_sliceIndices  (CURLY_CLUSTER_GRID_Z),
+      m_lightBuffer   {0},
+      m_gridBuffer    {0},
+      m_indexBuffer   {0},
+      m_nextSlice     {0},
+      m_generation    {0},
+      m_activeWorkers {0},
+      m_busyWorkers   {0},
+      m_stopWorkers   {false}
+{
+}
+
+LightGrid::~LightGrid()
+{
+    {
+        std::lock_guard<std::mutex> lock {m_workerMutex};
+        m_stopWorkers = true;
+    }
+    m_wakeCondition.notify_all();
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    // Buffers only exist once upload() ran, a headless grid never touches GL
+    if(m_lightBuffer != 0)
+    {
+        glDeleteBuffers(1, &m_lightBuffer);
+        glDeleteBuffers(1, &m_gridBuffer);
+        glDeleteBuffers(1, &m_indexBuffer);
+    }
+}
+
+
+void LightGrid::setProjection(const float fovY, const float aspect, const float zNear, const float zFar)
+{
+    m_near = zNear;
+    m_far = zFar;
+
+    const float tanHalfY {std::tan(fovY * 0.5f)};
+    const float tanHalfX {tanHalfY * aspect};
+    for(cfg::uint32 k = 0; k < CURLY_CLUSTER_GRID_Z; ++k)
+    {
+        // Exponential slicing keeps clusters roughly cubic along depth
+        const float d0 {m_near * std::pow(m_far / m_near, static_cast<float>(k) / CURLY_CLUSTER_GRID_Z)};
+        const float d1 {m_near * std::pow(m_far / m_near, static_cast<float>(k + 1) / CURLY_CLUSTER_GRID_Z)};
+        for(cfg::uint32 j = 0; j < CURLY_CLUSTER_GRID_Y; ++j)
+        {
+            const float y0 {(-1.0f + 2.0f * j / CURLY_CLUSTER_GRID_Y) * tanHalfY};
+            const float y1 {(-1.0f + 2.0f * (j + 1) / CURLY_CLUSTER_GRID_Y) * tanHalfY};
+            for(cfg::uint32 i = 0; i < CURLY_CLUSTER_GRID_X; ++i)
+            {
+                const float x0 {(-1.0f + 2.0f * i / CURLY_CLUSTER_GRID_X) * tanHalfX};
+                const float x1 {(-1.0f + 2.0f * (i + 1) / CURLY_CLUSTER_GRID_X) * tanHalfX};
+
+                ClusterAABB& box {m_clusters[getClusterIndex(i, j, k)]};
+                box.min = {std::min(x0 * d0, x0 * d1), std::min(y0 * d0, y0 * d1), -d1};
+                box.max = {std::max(x1 * d0, x1 * d1), std::max(y1 * d0, y1 * d1), -d0};
+            }
+        }
+    }
+}
+
+void LightGrid::setLights(std::span<const PointLightData> lights, const glm::mat4& view)
+{
+    m_lights.clear();
+    m_gpuLights.clear();
+    for(cfg::uint32 i = 0; i < lights.size(); ++i)
+    {
+        const PointLightData& light {lights[i]};
+        const float radius {getLightRadius(light)};
+        if(radius <= 0.0f)
+        {
+            continue;
+        }
+        const glm::vec4 viewPos {view * glm::vec4(light.position, 1.0f)};
+
+        m_lights.push(viewPos.x, viewPos.y, viewPos.z, radius, static_cast<cfg::uint32>(m_gpuLights.size()));
+        m_gpuLights.push_back({glm::vec4(light.position, radius),
+                               glm::vec4(light.ambient, 0.0f),
+                               glm::vec4(light.diffuse, 0.0f),
+                               glm::vec4(light.specular, 0.0f),
+                               glm::vec4(light.constant, light.linear, light.quadratic, 0.0f)});
+    }
+}
+
+void LightGrid::assign(const cfg::uint32 threadCount)
+{
+    const cfg::uint32 helpers {std::min(std::max(threadCount, 1u), CURLY_CLUSTER_GRID_Z) - 1};
+    if(helpers == 0)
+    {
+        assignSlices(0, CURLY_CLUSTER_GRID_Z);
+        finalize();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {m_workerMutex};
+        for(cfg::uint32 i = static_cast<cfg::uint32>(m_workers.size()); i < helpers; ++i)
+        {
+            m_workers.emplace_back(&LightGrid::runWorker, this, i, m_generation);
+        }
+        m_nextSlice = 0;
+        m_activeWorkers = helpers;
+        m_busyWorkers = helpers;
+        ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+
+    assignPendingSlices();
+
+    {
+        std::unique_lock<std::mutex> lock {m_workerMutex};
+        m_doneCondition.wait(lock, [this]() { return m_busyWorkers == 0; });
+    }
+    finalize();
+}
+
+void LightGrid::assignSlices(const cfg::uint32 firstSlice, const cfg::uint32 sliceCount)
+{
+    CURLY_PROFILE_SCOPE("LightGrid::assignSlices");
+    CURLY_PROFILE_COUNTERS("LightGrid::assignSlices");
+
+    constexpr float huge {std::numeric_limits<float>::max()};
+
+    SphereSet slice;
+    SphereSet row;
+    for(cfg::uint32 k = firstSlice; k < firstSlice + sliceCount; ++k)
+    {
+        // Narrow the candidates down slice, then row, then cluster
+        const ClusterAABB& front {m_clusters[getClusterIndex(0, 0, k)]};
+        filter(m_lights, {{-huge, -huge, front.min.z}, {huge, huge, front.max.z}}, slice);
+
+        std::vector<cfg::uint32>& indices {m_sliceIndices[k]};
+        indices.clear();
+        for(cfg::uint32 j = 0; j < CURLY_CLUSTER_GRID_Y; ++j)
+        {
+            ClusterAABB rowBox {m_clusters[getClusterIndex(0, j, k)]};
+            for(cfg::uint32 i = 1; i < CURLY_CLUSTER_GRID_X; ++i)
+            {
+                const ClusterAABB& box {m_clusters[getClusterIndex(i, j, k)]};
+                rowBox.min = glm::min(rowBox.min, box.min);
+                rowBox.max = glm::max(rowBox.max, box.max);
+            }
+            filter(slice, rowBox, row);
+
+            for(cfg::uint32 i = 0; i < CURLY_CLUSTER_GRID_X; ++i)
+            {
+                const cfg::uint32 cluster {getClusterIndex(i, j, k)};
+                const cfg::uint32 offset {static_cast<cfg::uint32>(indices.size())};
+                for(cfg::uint32 l = 0; l < row.size(); l += 4)
+                {
+                    cfg::uint32 mask {testSpheres4(&row.x[l], &row.y[l], &row.z[l], &row.r[l], m_clusters[cluster]) & getValidMask(l, row.size())};
+                    while(mask != 0)
+                    {
+                        const cfg::uint32 bit {static_cast<cfg::uint32>(std::countr_zero(mask))};
+                        indices.push_back(row.index[l + bit]);
+                        mask &= mask - 1;
+                    }
+                }
+                m_ranges[cluster] = {offset, static_cast<cfg::uint32>(indices.size()) - offset};
+            }
+        }
+    }
+}
+
+void LightGrid::runWorker(const cfg::uint32 workerIndex, cfg::uint64 generation)
+{
+    CURLY_PROFILE_THREAD("Light Grid Worker");
+    while(true)
+    {
+        bool active;
+        {
+            std::unique_lock<std::mutex> lock {m_workerMutex};
+            m_wakeCondition.wait(lock, [this, generation]() { return m_stopWorkers || (m_generation != generation); });
+            if(m_stopWorkers)
+            {
+                return;
+            }
+            generation = m_generation;
+            active = workerIndex < m_activeWorkers;
+        }
+        if(!active)
+        {
+            continue;
+        }
+
+        assignPendingSlices();
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock {m_workerMutex};
+            last = (--m_busyWorkers == 0);
+        }
+        if(last)
+        {
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+void LightGrid::assignPendingSlices()
+{
+    // Far slices hold far more lights than near ones, so threads pull single slices
+    for(cfg::uint32 k = m_nextSlice++; k < CURLY_CLUSTER_GRID_Z; k = m_nextSlice++)
+    {
+        assignSlices(k, 1);
+    }
+}
+
+void LightGrid::finalize()
+{
+    m_indices.clear();
+    for(cfg::uint32 k = 0; k < CURLY_CLUSTER_GRID_Z; ++k)
+    {
+        // Ranges are relative to their slice list until here
+        const cfg::uint32 base {static_cast<cfg::uint32>(m_indices.size())};
+        for(cfg::uint32 cluster = getClusterIndex(0, 0, k); cluster < getClusterIndex(0, 0, k + 1); ++cluster)
+        {
+            m_ranges[cluster].offset += base;
+        }
+        m_indices.insert(m_indices.end(), m_sliceIndices[k].begin(), m_sliceIndices[k].end());
+    }
+}
+
+const ClusterRange& LightGrid::getClusterRange(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z) const
+{
+    return m_ranges[getClusterIndex(x, y, z)];
+}
+
+const ClusterAABB& LightGrid::getClusterAABB(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z) const
+{
+    return m_clusters[getClusterIndex(x, y, z)];
+}
+
+const std::vector<cfg::uint32>& LightGrid::getLightIndices() const
+{
+    return m_indices;
+}
+
+cfg::uint32 LightGrid::getLightCount() const
+{
+    return static_cast<cfg::uint32>(m_gpuLights.size());
+}
+
+float LightGrid::getLightRadius(const PointLightData& light)
+{
+    const glm::vec3 peak {glm::max(light.diffuse, light.specular)};
+    const float target {std::max(peak.x, std::max(peak.y, peak.z)) * CURLY_LIGHT_INTENSITY_CUTOFF};
+    if(target <= light.constant)
+    {
+        return 0.0f;
+    }
+
+    // Solve constant + linear * d + quadratic * d^2 = target
+    if(light.quadratic > 0.0f)
+    {
+        const float discriminant {light.linear * light.linear - 4.0f * light.quadratic * (light.constant - target)};
+        return (-light.linear + std::sqrt(discriminant)) / (2.0f * light.quadratic);
+    }
+    if(light.linear > 0.0f)
+    {
+        return (target - light.constant) / light.linear;
+    }
+    return std::numeric_limits<float>::max();
+}
+
+cfg::uint32 LightGrid::getClusterIndex(const cfg::uint32 x, const cfg::uint32 y, const cfg::uint32 z)
+{
+    return x + CURLY_CLUSTER_GRID_X * (y + CURLY_CLUSTER_GRID_Y * z);
+}
+
+void LightGrid::filter(const SphereSet& in, const ClusterAABB& box, SphereSet& out)
+{
+    out.clear();
+    for(cfg::uint32 l = 0; l < in.size(); l += 4)
+    {
+        cfg::uint32 mask {testSpheres4(&in.x[l], &in.y[l], &in.z[l], &in.r[l], box) & getValidMask(l, in.size())};
+        while(mask != 0)
+        {
+            const cfg::uint32 bit {static_cast<cfg::uint32>(std::countr_zero(mask))};
+            out.push(in.x[l + bit], in.y[l + bit], in.z[l + bit], in.r[l + bit], in.index[l + bit]);
+            mask &= mask - 1;
+        }
+    }
+}
+
+} // namespace gfx
@@ -0,0 +1,71 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/lightGrid.hpp>
+
+#include <graphics/shader.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <cmath>
+
+namespace gfx
+{
+void LightGrid::upload()
+{
+    if(m_lightBuffer == 0)
+    {
+        glGenBuffers(1, &m_lightBuffer);
+        glGenBuffers(1, &m_gridBuffer);
+        glGenBuffers(1, &m_indexBuffer);
+    }
+
+    // Storage buffers can't be empty, so empty lists still get a minimal allocation
+    const auto uploadBuffer = [](const cfg::uint32 buffer, const void* data, const cfg::uint64 size) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size > 0 ? size : 16, size > 0 ? data : nullptr, GL_STREAM_DRAW);
+    };
+    uploadBuffer(m_lightBuffer, m_gpuLights.data(), m_gpuLights.size() * sizeof(GpuPointLight));
+    uploadBuffer(m_gridBuffer, m_ranges.data(), m_ranges.size() * sizeof(ClusterRange));
+    uploadBuffer(m_indexBuffer, m_indices.data(), m_indices.size() * sizeof(cfg::uint32));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void LightGrid::bind() const
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CURLY_CLUSTER_LIGHTS_BINDING, m_lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CURLY_CLUSTER_GRID_BINDING, m_gridBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CURLY_CLUSTER_INDICES_BINDING, m_indexBuffer);
+}
+
+void LightGrid::setupShader(Shader& shader, const cfg::uint32 viewportWidth, const cfg::uint32 viewportHeight) const
+{
+    constexpr UniformId clusterScale {"clusterScale"};
+    constexpr UniformId clusterDepth {"clusterDepth"};
+
+    const float logRatio {std::log(m_far / m_near)};
+    shader.setVec2(clusterScale, static_cast<float>(CURLY_CLUSTER_GRID_X) / viewportWidth, static_cast<float>(CURLY_CLUSTER_GRID_Y) / viewportHeight);
+    shader.setVec2(clusterDepth, CURLY_CLUSTER_GRID_Z / logRatio, -CURLY_CLUSTER_GRID_Z * std::log(m_near) / logRatio);
+}
+
+} // namespace gfx
@@ -24,34 +24,51 @@
 #include <graphics/mesh.hpp>
 
 #include <graphics/gUtils.hpp>
+#include <graphics/glState.hpp>
 
 #include "../core/GL/gl.h"
 
 namespace gfx
 {
 Mesh::Mesh()
-    : m_VAO        {0},
-      m_VBO        {0},
-      m_EBO        {0},
-      m_indices    {new sys::Vector<cfg::uint32>},
-      m_vertexData {new sys::Vector<float>}
+    : m_VAO               {0},
+      m_VBO               {0},
+      m_EBO               {0},
+      m_instancingEnabled {false},
+      m_indices           {new sys::Vector<cfg::uint32>},
+      m_vertexData        {new sys::Vector<float>}
 {
 }
 
 Mesh::Mesh(const char* path, bool hasNormals, bool hasUVs)
-    : m_VAO        {0},
-      m_VBO        {0},
-      m_EBO        {0},
-      m_indices    {new sys::Vector<cfg::uint32>},
-      m_vertexData {new sys::Vector<float>}
+    : m_VAO               {0},
+      m_VBO               {0},
+      m_EBO               {0},
+      m_instancingEnabled {false},
+      m_indices           {new sys::Vector<cfg::uint32>},
+      m_vertexData        {new sys::Vector<float>}
 {
     loadObj(path, *m_vertexData, *m_indices, hasNormals, hasUVs);
     generate();
 }
 
+Mesh::Mesh(const char* path, const AtlasRegion& uvRegion, bool hasNormals, bool hasUVs)
+    : m_VAO               {0},
+      m_VBO               {0},
+      m_EBO               {0},
+      m_instancingEnabled {false},
+      m_indices           {new sys::Vector<cfg::uint32>},
+      m_vertexData        {new sys::Vector<float>}
+{
+    loadObj(path, *m_vertexData, *m_indices, hasNormals, hasUVs);
+    remapUVs(*m_vertexData, uvRegion);
+    generate();
+}
+
 Mesh::~Mesh()
 {
     glDeleteVertexArrays(1, &m_VAO);
+    GLState::releaseVertexArray(m_VAO);
     glDeleteBuffers(1, &m_VBO);
     glDeleteBuffers(1, &m_EBO);
     delete m_indices;
@@ -61,9 +78,35 @@ Mesh::~Mesh()
 void Mesh::draw(const Shader& shader)
 {
     shader.use();
-    glBindVertexArray(m_VAO);
-        glDrawElements(GL_TRIANGLES, (cfg::uint32)m_indices->size(), GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, (cfg::uint32)m_indices->size(), GL_UNSIGNED_INT, (void*)0);
+}
+
+void Mesh::drawInstanced(const Shader& shader, const InstanceBuffer& instances, const cfg::uint64 offset, const cfg::uint32 count)
+{
+    shader.use();
+    GLState::bindVertexArray(m_VAO);
+    if(!m_instancingEnabled)
+    {
+        // Enabled lazily so non-instanced draws never read an unbound instance binding
+        for(cfg::uint32 i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(CURLY_INSTANCE_ATTRIB_LOCATION + i);
+        }
+        m_instancingEnabled = true;
+    }
+    glBindVertexBuffer(CURLY_INSTANCE_BUFFER_BINDING, instances.getBuffer(), static_cast<GLintptr>(offset), sizeof(glm::mat4));
+    glDrawElementsInstanced(GL_TRIANGLES, (cfg::uint32)m_indices->size(), GL_UNSIGNED_INT, (void*)0, count);
+}
+
+cfg::uint32 Mesh::getVertexArray() const
+{
+    return m_VAO;
+}
+
+cfg::uint32 Mesh::getIndexCount() const
+{
+    return static_cast<cfg::uint32>(m_indices->size());
 }
 
 void Mesh::generate()
@@ -72,7 +115,7 @@ void Mesh::generate()
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
 
-    glBindVertexArray(m_VAO);
+    GLState::bindVertexArray(m_VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
     glBufferData(GL_ARRAY_BUFFER, m_vertexData->size() * sizeof(float), m_vertexData->data(), GL_STATIC_DRAW);
@@ -91,7 +134,15 @@ void Mesh::generate()
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    // Instance Transform Attrib, a mat4 takes four vec4 locations
+    for(cfg::uint32 i = 0; i < 4; ++i)
+    {
+        glVertexAttribFormat(CURLY_INSTANCE_ATTRIB_LOCATION + i, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+        glVertexAttribBinding(CURLY_INSTANCE_ATTRIB_LOCATION + i, CURLY_INSTANCE_BUFFER_BINDING);
+    }
+    glVertexBindingDivisor(CURLY_INSTANCE_BUFFER_BINDING, 1);
+
+    GLState::bindVertexArray(0);
 }
 
 } // namespace gfx
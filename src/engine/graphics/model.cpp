@@ -24,36 +24,72 @@
 #include <graphics/model.hpp>
 
 #include <graphics/gUtils.hpp>
+#include <graphics/glState.hpp>
 
 #include "../core/GL/gl.h"
 
 namespace gfx
 {
 Model::Model()
-    : m_mesh       {},
-      m_diffuseMap {0}
+    : m_mesh           {},
+      m_diffuseMap     {0},
+      m_ownsDiffuseMap {true}
 {
 }
 
 Model::Model(const char* path, const char* texturePath, bool hasNormals, bool hasUVs)
-    : m_mesh       {path, hasNormals, hasUVs},
-      m_diffuseMap {0}
+    : m_mesh           {path, hasNormals, hasUVs},
+      m_diffuseMap     {0},
+      m_ownsDiffuseMap {true}
 {
     m_diffuseMap = loadTexture(texturePath);
 }
 
+Model::Model(const char* path, const AtlasBuilder& atlas, const cfg::uint32 regionID, bool hasNormals, bool hasUVs)
+    : m_mesh           {path, atlas.getRegion(regionID), hasNormals, hasUVs},
+      m_diffuseMap     {atlas.getTexture()},
+      m_ownsDiffuseMap {false}
+{
+}
+
 Model::~Model()
 {
-    glDeleteTextures(1, &m_diffuseMap);
+    if(m_ownsDiffuseMap)
+    {
+        glDeleteTextures(1, &m_diffuseMap);
+        GLState::releaseTexture(m_diffuseMap);
+    }
 }
 
 void Model::draw(Shader& shader)
 {
+    constexpr UniformId materialDiffuse {"material.texture_diffuse"};
+
     shader.use();
-    shader.setInt("material.texture_diffuse", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_diffuseMap);
+    shader.setInt(materialDiffuse, 0);
+    GLState::bindTexture(0, GL_TEXTURE_2D, m_diffuseMap);
     m_mesh.draw(shader);
 }
 
+void Model::drawInstanced(Shader& shader, std::span<const glm::mat4> transforms, InstanceBuffer& instances)
+{
+    constexpr UniformId materialDiffuse {"material.texture_diffuse"};
+
+    if(transforms.empty())
+    {
+        return;
+    }
+
+    const cfg::uint64 offset {instances.upload(transforms)};
+    shader.use();
+    shader.setInt(materialDiffuse, 0);
+    GLState::bindTexture(0, GL_TEXTURE_2D, m_diffuseMap);
+    m_mesh.drawInstanced(shader, instances, offset, static_cast<cfg::uint32>(transforms.size()));
+}
+
+void Model::submit(RenderQueue& queue, Shader& shader, const glm::mat4& transform, const cfg::uint32 layer, const RenderBucket bucket)
+{
+    queue.submit(m_mesh, shader, m_diffuseMap, transform, layer, bucket);
+}
+
 } // namespace gfx
@@ -0,0 +1,244 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/renderQueue.hpp>
+
+#include <graphics/glState.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <algorithm>
+
+namespace gfx
+{
+RenderQueue::RenderQueue()
+    : m_viewPos            {0.0f, 0.0f, 0.0f},
+      m_invFarPlane        {1.0f},
+      m_packets            {},
+      m_sortBuffer         {},
+      m_transforms         {},
+      m_instances          {nullptr},
+      m_instanceTransforms {},
+      m_instancedVariants  {}
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::begin(const glm::vec3& viewPos, const float farPlane)
+{
+    clear();
+    m_viewPos = viewPos;
+    m_invFarPlane = (farPlane > 0.0f) ? 1.0f / farPlane : 1.0f;
+}
+
+void RenderQueue::submit(Mesh& mesh, Shader& shader, const cfg::uint32 texture, const glm::mat4& transform, const cfg::uint32 layer, const RenderBucket bucket)
+{
+    const float depth {glm::length(glm::vec3 {transform[3]} - m_viewPos) * m_invFarPlane};
+
+    DrawPacket packet;
+    packet.key = makeKey(layer, bucket, shader.getProgram(), texture, mesh.getVertexArray(), depth);
+    packet.mesh = &mesh;
+    packet.shader = &shader;
+    packet.texture = texture;
+    packet.transformIndex = static_cast<cfg::uint32>(m_transforms.size());
+
+    m_packets.push_back(packet);
+    m_transforms.push_back(transform);
+}
+
+void RenderQueue::sort()
+{
+    const size_t count {m_packets.size()};
+    m_sortBuffer.resize(count);
+
+    // LSD radix sort on bytes, passes where every key shares the digit are skipped
+    for(cfg::uint32 shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] {};
+        for(const DrawPacket& packet : m_packets)
+        {
+            ++histogram[(packet.key >> shift) & 0xFF];
+        }
+        if(histogram[(m_packets.empty() ? 0 : (m_packets[0].key >> shift) & 0xFF)] == count)
+        {
+            continue;
+        }
+
+        size_t offset {0};
+        for(size_t& bucketCount : histogram)
+        {
+            const size_t bucketStart {offset};
+            offset += bucketCount;
+            bucketCount = bucketStart;
+        }
+        for(const DrawPacket& packet : m_packets)
+        {
+            m_sortBuffer[histogram[(packet.key >> shift) & 0xFF]++] = packet;
+        }
+        m_packets.swap(m_sortBuffer);
+    }
+}
+
+void RenderQueue::setInstancedVariant(const Shader& shader, Shader& instancedShader)
+{
+    m_instancedVariants[shader.getProgram()] = &instancedShader;
+}
+
+void RenderQueue::flush()
+{
+    constexpr UniformId modelMatrix {"model"};
+    constexpr UniformId materialDiffuse {"material.texture_diffuse"};
+    constexpr cfg::uint64 stateMask {((1ull << 36) - 1) << 23};
+
+    sort();
+
+    Shader* currentShader {nullptr};
+    bool transparent {false};
+    GLState::setBlend(false);
+    GLState::setDepthMask(true);
+
+    for(size_t i = 0; i < m_packets.size();)
+    {
+        const DrawPacket& packet {m_packets[i]};
+        const bool packetTransparent {((packet.key >> 59) & 0x1) == TRANSPARENT_BUCKET};
+        if(packetTransparent != transparent)
+        {
+            transparent = packetTransparent;
+            GLState::setBlend(transparent);
+            GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            GLState::setDepthMask(!transparent);
+        }
+
+        // Opaque packets sharing shader, material and mesh are adjacent after sorting
+        size_t runLength {1};
+        if(!transparent)
+        {
+            while((i + runLength < m_packets.size()) &&
+                  (m_packets[i + runLength].shader == packet.shader) &&
+                  (m_packets[i + runLength].texture == packet.texture) &&
+                  (m_packets[i + runLength].mesh == packet.mesh) &&
+                  ((m_packets[i + runLength].key & stateMask) == (packet.key & stateMask)))
+            {
+                ++runLength;
+            }
+        }
+        if((runLength > 1) && drawInstancedRun(&packet, runLength, currentShader))
+        {
+            i += runLength;
+            continue;
+        }
+
+        if(packet.shader != currentShader)
+        {
+            currentShader = packet.shader;
+            currentShader->use();
+            currentShader->setInt(materialDiffuse, 0);
+        }
+        GLState::bindTexture(0, GL_TEXTURE_2D, packet.texture);
+        currentShader->setMat4(modelMatrix, m_transforms[packet.transformIndex]);
+        packet.mesh->draw(*currentShader);
+        ++i;
+    }
+
+    GLState::setBlend(false);
+    GLState::setDepthMask(true);
+    clear();
+}
+
+void RenderQueue::clear()
+{
+    m_packets.clear();
+    m_transforms.clear();
+}
+
+const std::vector<DrawPacket>& RenderQueue::getPackets() const
+{
+    return m_packets;
+}
+
+const glm::mat4& RenderQueue::getTransform(const DrawPacket& packet) const
+{
+    return m_transforms[packet.transformIndex];
+}
+
+cfg::uint64 RenderQueue::makeKey(const cfg::uint32 layer, const RenderBucket bucket, const cfg::uint32 shader, const cfg::uint32 material, const cfg::uint32 mesh, const float depth)
+{
+    constexpr cfg::uint64 depthMask {(1ull << 23) - 1};
+    const cfg::uint64 quantizedDepth {static_cast<cfg::uint64>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(depthMask))};
+
+    const cfg::uint64 state {(static_cast<cfg::uint64>(shader & 0xFFF) << 24) |
+                             (static_cast<cfg::uint64>(material & 0xFFF) << 12) |
+                             (static_cast<cfg::uint64>(mesh & 0xFFF))};
+
+    cfg::uint64 key {(static_cast<cfg::uint64>(layer & 0xF) << 60) | (static_cast<cfg::uint64>(bucket & 0x1) << 59)};
+    if(bucket == OPAQUE_BUCKET)
+    {
+        // State first to minimize changes, then front-to-back to help early depth rejection
+        key |= (state << 23) | quantizedDepth;
+    }
+    else
+    {
+        // Back-to-front is required for correct blending, state only breaks ties
+        key |= ((depthMask - quantizedDepth) << 36) | state;
+    }
+    return key;
+}
+
+bool RenderQueue::drawInstancedRun(const DrawPacket* run, const size_t count, Shader*& currentShader)
+{
+    constexpr UniformId materialDiffuse {"material.texture_diffuse"};
+
+    auto variantIt {m_instancedVariants.find(run->shader->getProgram())};
+    if(variantIt == m_instancedVariants.end())
+    {
+        return false;
+    }
+    if(!m_instances)
+    {
+        m_instances = std::make_unique<InstanceBuffer>();
+    }
+
+    m_instanceTransforms.clear();
+    for(size_t i = 0; i < count; ++i)
+    {
+        m_instanceTransforms.push_back(m_transforms[run[i].transformIndex]);
+    }
+    const cfg::uint64 offset {m_instances->upload(m_instanceTransforms)};
+
+    Shader* instancedShader {variantIt->second};
+    if(instancedShader != currentShader)
+    {
+        currentShader = instancedShader;
+        currentShader->use();
+        currentShader->setInt(materialDiffuse, 0);
+    }
+    GLState::bindTexture(0, GL_TEXTURE_2D, run->texture);
+    run->mesh->drawInstanced(*currentShader, *m_instances, offset, static_cast<cfg::uint32>(count));
+
+    return true;
+}
+
+} // namespace gfx
@@ -0,0 +1,265 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/renderThread.hpp>
+
+#include <graphics/glState.hpp>
+#include <system/profiler.hpp>
+
+#include "../core/GL/gl.h"
+
+namespace gfx
+{
+RenderThread::RenderThread(wnd::RenderingWindow& t_window, const cfg::uint32 t_latency)
+    : m_window        {t_window},
+      m_latency       {t_latency < 1u ? 1u : (t_latency > CURLY_RENDER_THREAD_MAX_LATENCY ? CURLY_RENDER_THREAD_MAX_LATENCY : t_latency)},
+      m_submitted     {0},
+      m_completed     {0},
+      m_running       {false},
+      m_stopRequested {false}
+{
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::start()
+{
+    if(m_running)
+    {
+        return;
+    }
+
+    m_window.releaseContext();
+    m_stopRequested = false;
+    m_running = true;
+    m_thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+    if(!m_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_stopRequested = true;
+    }
+    m_submitCondition.notify_one();
+    m_thread.join();
+    m_running = false;
+
+    m_window.makeContextCurrent();
+    GLState::invalidate();
+}
+
+CommandList& RenderThread::beginFrame()
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+    m_completeCondition.wait(lock, [this]() { return m_submitted - m_completed <= m_latency; });
+
+    return m_lists[m_submitted % (m_latency + 1)];
+}
+
+void RenderThread::endFrame()
+{
+    if(!m_running)
+    {
+        CommandList& list {m_lists[m_submitted % (m_latency + 1)]};
+        replay(list);
+        list.clear();
+        m_window.swapBuffers();
+        ++m_submitted;
+        ++m_completed;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        ++m_submitted;
+    }
+    m_submitCondition.notify_one();
+}
+
+void RenderThread::waitIdle()
+{
+    std::unique_lock<std::mutex> lock {m_mutex};
+    m_completeCondition.wait(lock, [this]() { return m_completed == m_submitted; });
+}
+
+bool RenderThread::isRunning() const
+{
+    return m_running;
+}
+
+cfg::uint32 RenderThread::getLatency() const
+{
+    return m_latency;
+}
+
+namespace
+{
+void applyUniform(const DrawUniform& uniform)
+{
+    switch(uniform.type)
+    {
+        case DrawUniformType::INT:
+            glUniform1i(uniform.location, uniform.intValue);
+            break;
+
+        case DrawUniformType::FLOAT:
+            glUniform1f(uniform.location, uniform.floatValues[0]);
+            break;
+
+        case DrawUniformType::VEC3:
+            glUniform3fv(uniform.location, 1, uniform.floatValues);
+            break;
+
+        case DrawUniformType::MAT4:
+            glUniformMatrix4fv(uniform.location, 1, GL_FALSE, uniform.floatValues);
+            break;
+
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+void RenderThread::replay(const CommandList& list)
+{
+    for(const Command& command : list.getCommands())
+    {
+        switch(command.type)
+        {
+            case CommandType::USE_PROGRAM:
+                {
+                    GLState::useProgram(static_cast<const UseProgramCommand*>(command.payload)->program);
+                }
+                break;
+
+            case CommandType::BIND_TEXTURE:
+                {
+                    const BindTextureCommand* bind {static_cast<const BindTextureCommand*>(command.payload)};
+                    GLState::bindTexture(bind->unit, GL_TEXTURE_2D, bind->texture);
+                }
+                break;
+
+            case CommandType::SET_INT:
+                {
+                    const SetIntCommand* set {static_cast<const SetIntCommand*>(command.payload)};
+                    GLState::useProgram(set->program);
+                    glUniform1i(set->location, set->value);
+                }
+                break;
+
+            case CommandType::SET_FLOAT:
+                {
+                    const SetFloatCommand* set {static_cast<const SetFloatCommand*>(command.payload)};
+                    GLState::useProgram(set->program);
+                    glUniform1f(set->location, set->value);
+                }
+                break;
+
+            case CommandType::SET_VEC3:
+                {
+                    const SetVec3Command* set {static_cast<const SetVec3Command*>(command.payload)};
+                    GLState::useProgram(set->program);
+                    glUniform3fv(set->location, 1, set->value);
+                }
+                break;
+
+            case CommandType::SET_MAT4:
+                {
+                    const SetMat4Command* set {static_cast<const SetMat4Command*>(command.payload)};
+                    GLState::useProgram(set->program);
+                    glUniformMatrix4fv(set->location, 1, GL_FALSE, set->value);
+                }
+                break;
+
+            case CommandType::DRAW:
+                {
+                    const DrawCommand* draw {static_cast<const DrawCommand*>(command.payload)};
+                    GLState::useProgram(draw->program);
+                    for(cfg::uint32 i = 0; i < draw->textureCount; ++i)
+                    {
+                        GLState::bindTexture(i, GL_TEXTURE_2D, draw->textures[i]);
+                    }
+                    for(cfg::uint32 i = 0; i < draw->uniformCount; ++i)
+                    {
+                        applyUniform(draw->uniforms[i]);
+                    }
+                    glUniformMatrix4fv(draw->modelLocation, 1, GL_FALSE, draw->model);
+                    GLState::bindVertexArray(draw->vertexArray);
+                    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(draw->indexCount), GL_UNSIGNED_INT, (void*)0);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void RenderThread::run()
+{
+    CURLY_PROFILE_THREAD("Render Thread");
+    m_window.makeContextCurrent();
+    // The shadow state belongs to whatever thread touched the context last
+    GLState::invalidate();
+
+    while(true)
+    {
+        CommandList* list {nullptr};
+        {
+            std::unique_lock<std::mutex> lock {m_mutex};
+            m_submitCondition.wait(lock, [this]() { return m_stopRequested || (m_completed < m_submitted); });
+            if(m_completed == m_submitted)
+            {
+                break;
+            }
+            list = &m_lists[m_completed % (m_latency + 1)];
+        }
+
+        {
+            CURLY_PROFILE_SCOPE("RenderThread::execute");
+            replay(*list);
+            list->clear();
+        }
+        m_window.swapBuffers();
+
+        {
+            std::lock_guard<std::mutex> lock {m_mutex};
+            ++m_completed;
+        }
+        m_completeCondition.notify_all();
+    }
+
+    m_window.releaseContext();
+}
+
+} // namespace gfx
@@ -22,151 +22,361 @@
  ********************************************************************************/
 
 #include <graphics/shader.hpp>
+#include <graphics/glState.hpp>
+#include <graphics/uniformBlock.hpp>
+#include <graphics/shaderPreprocessor.hpp>
+#include <system/profiler.hpp>
 
-#include <exception/graphics/graphicsException.hpp>
-
-#include <cctype>
+#include <vector>
+#include <cstring>
 #include <string>
+#include <iomanip>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <filesystem>
 
 #include "../core/GL/gl.h"
 
 namespace gfx
 {
+std::string Shader::s_binaryCacheDirectory {"shaders/cache"};
+
 Shader::Shader(const std::string& t_name)
+    : Shader {t_name, ShaderDefines {}}
 {
-    std::string vsSrc {loadShaderFromFile(ShaderType::VERTEX_SHADER, "shaders/" + t_name)};
-    std::string fsSrc {loadShaderFromFile(ShaderType::FRAGMENT_SHADER, "shaders/" + t_name)};
+}
 
-#if defined(C__CURLY_FORCE_GLX_CTX_VERSION)
-    constexpr int glxCtxMajorVersion{ C__CURLY_GLX_CTX_VERSION_MAJOR };
-    constexpr int glxCtxMinorVersion{ C__CURLY_GLX_CTX_VERSION_MINOR };
-    const auto replaceGlxContextVersion = [](std::string& shaderSrc) -> void {
-        const size_t versionDeclIdx = shaderSrc.find("#version");
-        size_t versionDefStartIdx = versionDeclIdx + 9;
-        while ((versionDefStartIdx < shaderSrc.size()) && !std::isdigit(shaderSrc[versionDefStartIdx]))
-        {
-            ++versionDefStartIdx;
-        }
-        size_t versionDefEndIdx = versionDefStartIdx + 1;
-        while ((versionDefEndIdx < shaderSrc.size()) && std::isdigit(shaderSrc[versionDefEndIdx]))
-        {
-            ++versionDefEndIdx;
-        }
-        if ((versionDefStartIdx >= shaderSrc.size()) || (versionDefEndIdx >= shaderSrc.size()))
-        {
-            throw GraphicsException();
-        }
-        std::string glxCtxVersionStr = std::to_string(glxCtxMajorVersion) + std::to_string(glxCtxMinorVersion) + std::string("0");
-        shaderSrc.replace(versionDefStartIdx, versionDefEndIdx - versionDefStartIdx, glxCtxVersionStr);
-    };
+Shader::Shader(const std::string& t_name, const ShaderDefines& defines, const bool deferred)
+    : m_program        {0},
+      m_vertexShader   {0},
+      m_fragmentShader {0},
+      m_programKey     {0},
+      m_pending        {false}
+{
+    ShaderPreprocessor preprocessor {"shaders/"};
+    std::string vsSrc {preprocessor.process(loadShaderFromFile(ShaderType::VERTEX_SHADER, "shaders/" + t_name), defines)};
+    std::string fsSrc {preprocessor.process(loadShaderFromFile(ShaderType::FRAGMENT_SHADER, "shaders/" + t_name), defines)};
 
-    try
+    createProgram(vsSrc, fsSrc, deferred);
+}
+
+Shader::Shader(const std::string& vsSrc, const std::string& fsSrc)
+    : m_program        {0},
+      m_vertexShader   {0},
+      m_fragmentShader {0},
+      m_programKey     {0},
+      m_pending        {false}
+{
+    createProgram(vsSrc, fsSrc, false);
+}
+
+Shader::~Shader()
+{
+    if(m_pending)
+    {
+        glDeleteShader(m_vertexShader);
+        glDeleteShader(m_fragmentShader);
+    }
+    glDeleteProgram(m_program);
+    GLState::releaseProgram(m_program);
+}
+
+void Shader::setBinaryCacheDirectory(const std::string& directory)
+{
+    s_binaryCacheDirectory = directory;
+}
+
+bool Shader::isReady() const
+{
+    if(!m_pending)
     {
-        replaceGlxContextVersion(vsSrc);
-        replaceGlxContextVersion(fsSrc);
+        return true;
     }
-    catch (const GenericException& e)
+    if(!isParallelCompileSupported())
     {
-        std::cerr << "An Exception has occurred: " << e.what() << std::endl;
+        // Without the extension finish() will just block until the driver is done
+        return true;
     }
-#endif
 
-    cfg::uint32 vertexShader {createShader(ShaderType::VERTEX_SHADER, vsSrc)};
-    cfg::uint32 fragmentShader {createShader(ShaderType::FRAGMENT_SHADER, fsSrc)};
+    cfg::int32 completed {0};
+    glGetProgramiv(m_program, CURLY_GL_COMPLETION_STATUS_KHR, &completed);
+    return completed;
+}
 
-    m_program = glCreateProgram();
-    glAttachShader(m_program, vertexShader);
-    glAttachShader(m_program, fragmentShader);
-    glLinkProgram(m_program);
+void Shader::finish()
+{
+    CURLY_PROFILE_SCOPE("Shader::finish");
+    if(!m_pending)
+    {
+        return;
+    }
+
+    checkErrors(m_vertexShader, false);
+    checkErrors(m_fragmentShader, false);
+    if(checkErrors(m_program, true))
+    {
+        storeProgramBinary(m_programKey);
+    }
 
-    checkErrors(m_program, true);
+    glDetachShader(m_program, m_vertexShader);
+    glDetachShader(m_program, m_fragmentShader);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_fragmentShader);
+    m_vertexShader = m_fragmentShader = 0;
+    m_pending = false;
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    reflectUniforms();
+    bindUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+    bindUniformBlock("LightsBlock", LIGHTS_BLOCK_BINDING);
 }
 
-Shader::Shader(const std::string& vsSrc, const std::string& fsSrc)
+bool Shader::isParallelCompileSupported()
 {
-    cfg::uint32 vertexShader {createShader(ShaderType::VERTEX_SHADER, vsSrc)};
-    cfg::uint32 fragmentShader {createShader(ShaderType::FRAGMENT_SHADER, fsSrc)};
+    static const bool supported {[]() -> bool {
+        cfg::int32 extensionCount {0};
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for(cfg::int32 i = 0; i < extensionCount; ++i)
+        {
+            const char* extension {reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))};
+            if(std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 || std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }()};
+    return supported;
+}
 
-    m_program = glCreateProgram();
-    glAttachShader(m_program, vertexShader);
-    glAttachShader(m_program, fragmentShader);
-    glLinkProgram(m_program);
+void Shader::use() const
+{
+    GLState::useProgram(m_program);
+}
 
-    checkErrors(m_program, true);
+cfg::uint32 Shader::getProgram() const
+{
+    return m_program;
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+cfg::int32 Shader::getUniformLocation(const std::string& name) const
+{
+    auto it {m_uniformLocations.find(hashUniformName(name.c_str(), name.size()))};
+    return (it != m_uniformLocations.end()) ? it->second : -1;
 }
 
-Shader::~Shader()
+cfg::int32 Shader::getUniformLocation(const UniformId id) const
 {
-    glDeleteProgram(m_program);
+    auto it {m_uniformLocations.find(id.getHash())};
+    return (it != m_uniformLocations.end()) ? it->second : -1;
 }
 
-void Shader::use() const
+void Shader::bindUniformBlock(const std::string& blockName, const cfg::uint32 bindingPoint)
 {
-    glUseProgram(m_program);
+    const cfg::uint32 blockIndex {glGetUniformBlockIndex(m_program, blockName.c_str())};
+    if(blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(m_program, blockIndex, bindingPoint);
+    }
 }
 
 void Shader::setBool(const std::string& name, bool v0)
 {
-    glUniform1i(glGetUniformLocation(m_program, name.c_str()), (int)v0);
+    setBool(getUniformLocation(name), v0);
+}
+
+void Shader::setBool(const UniformId id, bool v0)
+{
+    setBool(getUniformLocation(id), v0);
+}
+
+void Shader::setBool(const cfg::int32 location, bool v0)
+{
+    glUniform1i(location, (int)v0);
 }
 
 void Shader::setInt(const std::string& name, int v0)
 {
-    glUniform1i(glGetUniformLocation(m_program, name.c_str()), v0);
+    setInt(getUniformLocation(name), v0);
+}
+
+void Shader::setInt(const UniformId id, int v0)
+{
+    setInt(getUniformLocation(id), v0);
+}
+
+void Shader::setInt(const cfg::int32 location, int v0)
+{
+    glUniform1i(location, v0);
 }
 
 void Shader::setFloat(const std::string& name, float v0)
 {
-    glUniform1f(glGetUniformLocation(m_program, name.c_str()), v0);
+    setFloat(getUniformLocation(name), v0);
+}
+
+void Shader::setFloat(const UniformId id, float v0)
+{
+    setFloat(getUniformLocation(id), v0);
+}
+
+void Shader::setFloat(const cfg::int32 location, float v0)
+{
+    glUniform1f(location, v0);
 }
 
 void Shader::setVec2(const std::string& name, float v0, float v1)
 {
-    glUniform2f(glGetUniformLocation(m_program, name.c_str()), v0, v1);
+    setVec2(getUniformLocation(name), v0, v1);
+}
+
+void Shader::setVec2(const UniformId id, float v0, float v1)
+{
+    setVec2(getUniformLocation(id), v0, v1);
+}
+
+void Shader::setVec2(const cfg::int32 location, float v0, float v1)
+{
+    glUniform2f(location, v0, v1);
 }
 
 void Shader::setVec3(const std::string& name, float v0, float v1, float v2)
 {
-    glUniform3f(glGetUniformLocation(m_program, name.c_str()), v0, v1, v2);
+    setVec3(getUniformLocation(name), v0, v1, v2);
+}
+
+void Shader::setVec3(const UniformId id, float v0, float v1, float v2)
+{
+    setVec3(getUniformLocation(id), v0, v1, v2);
+}
+
+void Shader::setVec3(const cfg::int32 location, float v0, float v1, float v2)
+{
+    glUniform3f(location, v0, v1, v2);
 }
 
 void Shader::setVec4(const std::string& name, float v0, float v1, float v2, float v3)
 {
-    glUniform4f(glGetUniformLocation(m_program, name.c_str()), v0, v1, v2, v3);
+    setVec4(getUniformLocation(name), v0, v1, v2, v3);
+}
+
+void Shader::setVec4(const UniformId id, float v0, float v1, float v2, float v3)
+{
+    setVec4(getUniformLocation(id), v0, v1, v2, v3);
+}
+
+void Shader::setVec4(const cfg::int32 location, float v0, float v1, float v2, float v3)
+{
+    glUniform4f(location, v0, v1, v2, v3);
 }
 
 void Shader::setVec2(const std::string& name, const math::Vec2& v)
 {
-    glUniform2f(glGetUniformLocation(m_program, name.c_str()), v.x, v.y);
+    setVec2(getUniformLocation(name), v);
+}
+
+void Shader::setVec2(const UniformId id, const math::Vec2& v)
+{
+    setVec2(getUniformLocation(id), v);
+}
+
+void Shader::setVec2(const cfg::int32 location, const math::Vec2& v)
+{
+    glUniform2f(location, v.x, v.y);
 }
 
 void Shader::setVec3(const std::string& name, const math::Vec3& v)
 {
-    glUniform3f(glGetUniformLocation(m_program, name.c_str()), v.x, v.y, v.z);
+    setVec3(getUniformLocation(name), v);
+}
+
+void Shader::setVec3(const UniformId id, const math::Vec3& v)
+{
+    setVec3(getUniformLocation(id), v);
+}
+
+void Shader::setVec3(const cfg::int32 location, const math::Vec3& v)
+{
+    glUniform3f(location, v.x, v.y, v.z);
 }
 
 void Shader::setVec4(const std::string& name, const math::Vec4& v)
 {
-    glUniform4f(glGetUniformLocation(m_program, name.c_str()), v.x, v.y, v.z, v.w);
+    setVec4(getUniformLocation(name), v);
+}
+
+void Shader::setVec4(const UniformId id, const math::Vec4& v)
+{
+    setVec4(getUniformLocation(id), v);
+}
+
+void Shader::setVec4(const cfg::int32 location, const math::Vec4& v)
+{
+    glUniform4f(location, v.x, v.y, v.z, v.w);
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& m0)
 {
-    glUniformMatrix3fv(glGetUniformLocation(m_program, name.c_str()), 1, GL_FALSE, glm::value_ptr(m0));
+    setMat3(getUniformLocation(name), m0);
+}
+
+void Shader::setMat3(const UniformId id, const glm::mat3& m0)
+{
+    setMat3(getUniformLocation(id), m0);
+}
+
+void Shader::setMat3(const cfg::int32 location, const glm::mat3& m0)
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(m0));
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& m0)
 {
-    glUniformMatrix4fv(glGetUniformLocation(m_program, name.c_str()), 1, GL_FALSE, glm::value_ptr(m0));
+    setMat4(getUniformLocation(name), m0);
+}
+
+void Shader::setMat4(const UniformId id, const glm::mat4& m0)
+{
+    setMat4(getUniformLocation(id), m0);
+}
+
+void Shader::setMat4(const cfg::int32 location, const glm::mat4& m0)
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m0));
+}
+
+void Shader::createProgram(const std::string& vsSrc, const std::string& fsSrc, const bool deferred)
+{
+    CURLY_PROFILE_SCOPE("Shader::createProgram");
+    m_programKey = hashProgram(vsSrc, fsSrc);
+
+    m_program = glCreateProgram();
+    if(loadProgramBinary(m_programKey))
+    {
+        reflectUniforms();
+        bindUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+        bindUniformBlock("LightsBlock", LIGHTS_BLOCK_BINDING);
+        return;
+    }
+
+    // Compile and link are only submitted here, the status is queried in finish()
+    // so the driver can work on many programs at once
+    m_vertexShader = createShader(ShaderType::VERTEX_SHADER, vsSrc);
+    m_fragmentShader = createShader(ShaderType::FRAGMENT_SHADER, fsSrc);
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_fragmentShader);
+    if(!s_binaryCacheDirectory.empty())
+    {
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(m_program);
+    m_pending = true;
+
+    if(!deferred)
+    {
+        finish();
+    }
 }
 
 cfg::uint32 Shader::createShader(const ShaderType type, const std::string& src)
@@ -177,8 +387,6 @@ cfg::uint32 Shader::createShader(const ShaderType type, const std::string& src)
     glShaderSource(shader, 1, &shaderSrc, nullptr);
     glCompileShader(shader);
 
-    checkErrors(shader, false);
-
     return shader;
 }
 
@@ -203,7 +411,7 @@ std::string Shader::loadShaderFromFile(const ShaderType type, const std::string&
     return shaderStrStream.str();
 }
 
-void Shader::checkErrors(const cfg::uint32 target, const bool isProgram)
+bool Shader::checkErrors(const cfg::uint32 target, const bool isProgram)
 {
     cfg::int32 success;
     char infolog[512];
@@ -226,6 +434,181 @@ void Shader::checkErrors(const cfg::uint32 target, const bool isProgram)
             std::cerr << "ERROR in Shader: Compilation Failed\n" << infolog << std::endl;
         }
     }
+    return success;
+}
+
+void Shader::reflectUniforms()
+{
+    m_uniformLocations.clear();
+
+    cfg::int32 uniformCount {0};
+    cfg::int32 maxNameLength {0};
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(maxNameLength), '\0');
+    const auto registerName = [this](const std::string& uniformName, const cfg::int32 location) -> void {
+        const cfg::uint32 hash {hashUniformName(uniformName.c_str(), uniformName.size())};
+        auto it {m_uniformLocations.find(hash)};
+        if((it != m_uniformLocations.end()) && (it->second != location))
+        {
+            std::cerr << "WARNING in Shader: Uniform name hash collision on " << uniformName << std::endl;
+        }
+        m_uniformLocations[hash] = location;
+    };
+
+    for(cfg::int32 i = 0; i < uniformCount; ++i)
+    {
+        GLsizei length {0};
+        GLint size {0};
+        GLenum type {0};
+        glGetActiveUniform(m_program, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data());
+
+        const std::string uniformName {name.data(), static_cast<size_t>(length)};
+        const cfg::int32 location {glGetUniformLocation(m_program, uniformName.c_str())};
+        if(location < 0)
+        {
+            // Members of uniform blocks have no location
+            continue;
+        }
+        registerName(uniformName, location);
+
+        // Arrays of basic types are reported once as "name[0]", register every element and the bare name too
+        // Element locations aren't guaranteed to be consecutive, so each one is queried
+        const size_t subscriptIdx {uniformName.rfind("[0]")};
+        if((subscriptIdx != std::string::npos) && (subscriptIdx + 3 == uniformName.size()))
+        {
+            const std::string baseName {uniformName.substr(0, subscriptIdx)};
+            registerName(baseName, location);
+            for(GLint element = 1; element < size; ++element)
+            {
+                const std::string elementName {baseName + "[" + std::to_string(element) + "]"};
+                const cfg::int32 elementLocation {glGetUniformLocation(m_program, elementName.c_str())};
+                if(elementLocation >= 0)
+                {
+                    registerName(elementName, elementLocation);
+                }
+            }
+        }
+    }
+}
+
+cfg::uint64 Shader::hashProgram(const std::string& vsSrc, const std::string& fsSrc)
+{
+    // Binaries are only valid for the driver that produced them
+    static const std::string driverSignature {
+        std::string {reinterpret_cast<const char*>(glGetString(GL_VENDOR))} + "|" +
+        std::string {reinterpret_cast<const char*>(glGetString(GL_RENDERER))} + "|" +
+        std::string {reinterpret_cast<const char*>(glGetString(GL_VERSION))}
+    };
+
+    cfg::uint64 hash {14695981039346656037ull};
+    const auto hashString = [&hash](const std::string& str) -> void {
+        for(const char c : str)
+        {
+            hash ^= static_cast<cfg::uint8>(c);
+            hash *= 1099511628211ull;
+        }
+        // Separator so that moving text between strings changes the hash
+        hash ^= 0xFF;
+        hash *= 1099511628211ull;
+    };
+    hashString(driverSignature);
+    hashString(vsSrc);
+    hashString(fsSrc);
+
+    return hash;
+}
+
+std::string Shader::getBinaryCachePath(const cfg::uint64 programKey)
+{
+    std::stringstream pathStream;
+    pathStream << s_binaryCacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << programKey << ".bin";
+    return pathStream.str();
+}
+
+bool Shader::loadProgramBinary(const cfg::uint64 programKey)
+{
+    if(s_binaryCacheDirectory.empty())
+    {
+        return false;
+    }
+
+    cfg::int32 formatCount {0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if(formatCount <= 0)
+    {
+        return false;
+    }
+
+    std::ifstream binaryFile {getBinaryCachePath(programKey), std::ios::binary};
+    if(!binaryFile)
+    {
+        return false;
+    }
+
+    ProgramBinaryHeader header {};
+    binaryFile.read(reinterpret_cast<char*>(&header), sizeof(ProgramBinaryHeader));
+    if(!binaryFile || (header.magic != CURLY_PROGRAM_BINARY_MAGIC) || (header.key != programKey))
+    {
+        return false;
+    }
+
+    // The length comes from disk, a truncated or corrupt cache file must not size the read
+    const std::streamoff headerEnd {binaryFile.tellg()};
+    binaryFile.seekg(0, std::ios::end);
+    const std::streamoff remaining {binaryFile.tellg() - headerEnd};
+    binaryFile.seekg(headerEnd, std::ios::beg);
+    if(!binaryFile || (header.length == 0) || (static_cast<std::streamoff>(header.length) != remaining))
+    {
+        std::cerr << "WARNING in Shader: Discarding corrupt program binary cache, compiling instead" << std::endl;
+        return false;
+    }
+
+    std::vector<char> binary(header.length);
+    binaryFile.read(binary.data(), header.length);
+    if(!binaryFile || (binaryFile.gcount() != static_cast<std::streamsize>(header.length)))
+    {
+        return false;
+    }
+
+    glProgramBinary(m_program, header.format, binary.data(), static_cast<GLsizei>(header.length));
+
+    // The driver may reject a binary even if the key matches (e.g. after an update), then we just compile
+    cfg::int32 success {0};
+    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    return success;
+}
+
+void Shader::storeProgramBinary(const cfg::uint64 programKey)
+{
+    if(s_binaryCacheDirectory.empty())
+    {
+        return;
+    }
+
+    cfg::int32 length {0};
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0)
+    {
+        return;
+    }
+
+    ProgramBinaryHeader header {CURLY_PROGRAM_BINARY_MAGIC, 0, static_cast<cfg::uint32>(length), programKey};
+    std::vector<char> binary(header.length);
+    glGetProgramBinary(m_program, length, nullptr, &header.format, binary.data());
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(s_binaryCacheDirectory, errorCode);
+
+    std::ofstream binaryFile {getBinaryCachePath(programKey), std::ios::binary | std::ios::trunc};
+    if(!binaryFile)
+    {
+        std::cerr << "WARNING in Shader: Couldn't write program binary cache at " << s_binaryCacheDirectory << std::endl;
+        return;
+    }
+    binaryFile.write(reinterpret_cast<const char*>(&header), sizeof(ProgramBinaryHeader));
+    binaryFile.write(binary.data(), header.length);
 }
 
 } // namespace gfx
@@ -0,0 +1,87 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/shaderLibrary.hpp>
+
+#include <algorithm>
+
+namespace gfx
+{
+ShaderLibrary::ShaderLibrary()
+    : m_variants {},
+      m_pending  {}
+{
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+}
+
+cfg::uint64 ShaderLibrary::request(const std::string& name, const ShaderDefines& defines)
+{
+    const cfg::uint64 variantKey {ShaderPreprocessor::getVariantKey(name, defines)};
+    if(m_variants.find(variantKey) == m_variants.end())
+    {
+        m_variants[variantKey] = std::make_unique<Shader>(name, defines, true);
+        m_pending.push_back(variantKey);
+    }
+    return variantKey;
+}
+
+cfg::uint32 ShaderLibrary::poll()
+{
+    auto stillPending = std::remove_if(m_pending.begin(), m_pending.end(), [this](const cfg::uint64 variantKey) {
+        Shader& shader {*m_variants[variantKey]};
+        if(shader.isReady())
+        {
+            shader.finish();
+            return true;
+        }
+        return false;
+    });
+    m_pending.erase(stillPending, m_pending.end());
+
+    return static_cast<cfg::uint32>(m_pending.size());
+}
+
+void ShaderLibrary::finishAll()
+{
+    for(const cfg::uint64 variantKey : m_pending)
+    {
+        m_variants[variantKey]->finish();
+    }
+    m_pending.clear();
+}
+
+Shader* ShaderLibrary::get(const cfg::uint64 variantKey)
+{
+    auto it {m_variants.find(variantKey)};
+    if((it == m_variants.end()) || !it->second->isReady())
+    {
+        return nullptr;
+    }
+    it->second->finish();
+    return it->second.get();
+}
+
+} // namespace gfx
@@ -0,0 +1,181 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/shaderPreprocessor.hpp>
+
+#include <exception/graphics/graphicsException.hpp>
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+namespace gfx
+{
+ShaderPreprocessor::ShaderPreprocessor(const std::string& t_includeDirectory)
+    : m_includeDirectory {t_includeDirectory},
+      m_includedFiles    {}
+{
+}
+
+ShaderPreprocessor::~ShaderPreprocessor()
+{
+}
+
+std::string ShaderPreprocessor::process(const std::string& src, const ShaderDefines& defines)
+{
+    m_includedFiles.clear();
+    std::string processedSrc {resolveIncludes(src, 0)};
+
+#if defined(C__CURLY_FORCE_GLX_CTX_VERSION)
+    try
+    {
+        replaceVersion(processedSrc, C__CURLY_GLX_CTX_VERSION_MAJOR, C__CURLY_GLX_CTX_VERSION_MINOR);
+    }
+    catch(const exc::GenericException& e)
+    {
+        std::cerr << "An Exception has occurred: " << e.what() << std::endl;
+    }
+#endif
+
+    injectDefines(processedSrc, defines);
+    return processedSrc;
+}
+
+cfg::uint64 ShaderPreprocessor::getVariantKey(const std::string& name, const ShaderDefines& defines)
+{
+    cfg::uint64 hash {14695981039346656037ull};
+    const auto hashString = [&hash](const std::string& str) -> void {
+        for(const char c : str)
+        {
+            hash ^= static_cast<cfg::uint8>(c);
+            hash *= 1099511628211ull;
+        }
+        hash ^= 0xFF;
+        hash *= 1099511628211ull;
+    };
+
+    hashString(name);
+    for(const auto& [defineName, defineValue] : defines)
+    {
+        hashString(defineName);
+        hashString(defineValue);
+    }
+    return hash;
+}
+
+std::string ShaderPreprocessor::resolveIncludes(const std::string& src, const cfg::uint32 depth)
+{
+    if(depth > CURLY_MAX_INCLUDE_DEPTH)
+    {
+        std::cerr << "ERROR in Shader: #include nested too deep" << std::endl;
+        return {};
+    }
+
+    std::stringstream srcStream {src};
+    std::string resolvedSrc;
+    std::string line;
+    while(std::getline(srcStream, line))
+    {
+        size_t directiveIdx {line.find_first_not_of(" \t")};
+        if((directiveIdx == std::string::npos) || (line.compare(directiveIdx, 8, "#include") != 0))
+        {
+            resolvedSrc += line;
+            resolvedSrc += '\n';
+            continue;
+        }
+
+        const size_t pathStartIdx {line.find_first_of("\"<", directiveIdx + 8)};
+        const size_t pathEndIdx {(pathStartIdx != std::string::npos) ? line.find_first_of("\">", pathStartIdx + 1) : std::string::npos};
+        if(pathEndIdx == std::string::npos)
+        {
+            std::cerr << "ERROR in Shader: Malformed #include directive\n" << line << std::endl;
+            continue;
+        }
+
+        const std::string path {m_includeDirectory + line.substr(pathStartIdx + 1, pathEndIdx - pathStartIdx - 1)};
+        if(!m_includedFiles.insert(path).second)
+        {
+            continue;
+        }
+
+        std::ifstream includeFile {path};
+        if(!includeFile)
+        {
+            std::cerr << "Error while loading shader include:\n" << path << std::endl;
+            continue;
+        }
+        std::stringstream includeStream;
+        includeStream << includeFile.rdbuf();
+
+        resolvedSrc += resolveIncludes(includeStream.str(), depth + 1);
+    }
+
+    return resolvedSrc;
+}
+
+void ShaderPreprocessor::injectDefines(std::string& src, const ShaderDefines& defines)
+{
+    std::string defineBlock;
+    for(const auto& [defineName, defineValue] : defines)
+    {
+        defineBlock += "#define " + defineName + " " + defineValue + "\n";
+    }
+
+    // #version must stay as the first directive of the source
+    size_t insertIdx {0};
+    const size_t versionDeclIdx {src.find("#version")};
+    if(versionDeclIdx != std::string::npos)
+    {
+        const size_t lineEndIdx {src.find('\n', versionDeclIdx)};
+        insertIdx = (lineEndIdx != std::string::npos) ? lineEndIdx + 1 : src.size();
+    }
+    src.insert(insertIdx, defineBlock);
+}
+
+void ShaderPreprocessor::replaceVersion(std::string& src, const int major, const int minor)
+{
+    const size_t versionDeclIdx = src.find("#version");
+    if(versionDeclIdx == std::string::npos)
+    {
+        throw exc::ShaderException();
+    }
+    size_t versionDefStartIdx = versionDeclIdx + 8;
+    while((versionDefStartIdx < src.size()) && !std::isdigit(src[versionDefStartIdx]))
+    {
+        ++versionDefStartIdx;
+    }
+    size_t versionDefEndIdx = versionDefStartIdx + 1;
+    while((versionDefEndIdx < src.size()) && std::isdigit(src[versionDefEndIdx]))
+    {
+        ++versionDefEndIdx;
+    }
+    if((versionDefStartIdx >= src.size()) || (versionDefEndIdx >= src.size()))
+    {
+        throw exc::GraphicsException();
+    }
+    std::string versionStr = std::to_string(major) + std::to_string(minor) + std::string("0");
+    src.replace(versionDefStartIdx, versionDefEndIdx - versionDefStartIdx, versionStr);
+}
+
+} // namespace gfx
@@ -0,0 +1,220 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/streamBuffer.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <iostream>
+#include <cstring>
+
+namespace gfx
+{
+StreamBuffer::StreamBuffer(const cfg::uint64 t_regionSize, const bool t_allowPersistent)
+    : m_buffer     {0},
+      m_regionSize {t_regionSize},
+      m_region     {0},
+      m_head       {0},
+      m_stalls     {0},
+      m_persistent {t_allowPersistent && isPersistentMappingSupported()},
+      m_mapped     {nullptr},
+      m_fences     {}
+{
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    if(m_persistent)
+    {
+        const GLbitfield flags {GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+        glBufferStorage(GL_COPY_WRITE_BUFFER, m_regionSize * CURLY_STREAM_BUFFER_REGIONS, nullptr, flags);
+        m_mapped = static_cast<cfg::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_regionSize * CURLY_STREAM_BUFFER_REGIONS, flags));
+        if(m_mapped == nullptr)
+        {
+            std::cerr << "Failed to map Stream Buffer persistently, falling back to orphaning" << std::endl;
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            m_persistent = false;
+        }
+    }
+    if(!m_persistent)
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for(void* fence : m_fences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(static_cast<GLsync>(fence));
+        }
+    }
+    if(m_mapped != nullptr)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void StreamBuffer::beginFrame()
+{
+    if(!m_persistent)
+    {
+        // Orphaning hands the old storage to the driver, which keeps it alive while in use
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_head = 0;
+        return;
+    }
+
+    // A region without a fence hasn't closed a frame yet, it keeps collecting writes
+    if(m_fences[m_region] == nullptr)
+    {
+        return;
+    }
+
+    m_region = (m_region + 1) % CURLY_STREAM_BUFFER_REGIONS;
+    m_head = m_region * m_regionSize;
+
+    GLsync fence {static_cast<GLsync>(m_fences[m_region])};
+    if(fence == nullptr)
+    {
+        return;
+    }
+
+    GLenum result {glClientWaitSync(fence, 0, 0)};
+    if(result == GL_TIMEOUT_EXPIRED)
+    {
+        ++m_stalls;
+        do
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        while(result == GL_TIMEOUT_EXPIRED);
+    }
+    if(result == GL_WAIT_FAILED)
+    {
+        std::cerr << "Failed to wait on a Stream Buffer fence" << std::endl;
+    }
+
+    glDeleteSync(fence);
+    m_fences[m_region] = nullptr;
+}
+
+void StreamBuffer::endFrame()
+{
+    if(m_persistent && (m_fences[m_region] == nullptr))
+    {
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+cfg::uint64 StreamBuffer::write(const void* data, const cfg::uint64 size, const cfg::uint64 alignment)
+{
+    const cfg::uint64 regionStart {m_persistent ? m_region * m_regionSize : 0};
+    const cfg::uint64 offset {alignment > 1 ? (m_head + alignment - 1) / alignment * alignment : m_head};
+    if(offset + size > regionStart + m_regionSize)
+    {
+        std::cerr << "Stream Buffer region is full, can't write " << size << " bytes" << std::endl;
+        return CURLY_STREAM_BUFFER_INVALID_OFFSET;
+    }
+
+    if(m_persistent)
+    {
+        std::memcpy(m_mapped + offset, data, size);
+    }
+    else
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    m_head = offset + size;
+
+    return offset;
+}
+
+void StreamBuffer::bindRange(const cfg::uint32 target, const cfg::uint32 index, const cfg::uint64 offset, const cfg::uint64 size) const
+{
+    glBindBufferRange(target, index, m_buffer, offset, size);
+}
+
+cfg::uint32 StreamBuffer::getBuffer() const
+{
+    return m_buffer;
+}
+
+bool StreamBuffer::isPersistent() const
+{
+    return m_persistent;
+}
+
+cfg::uint64 StreamBuffer::getStallCount() const
+{
+    return m_stalls;
+}
+
+bool StreamBuffer::isPersistentMappingSupported()
+{
+    static const bool supported {[]() -> bool {
+        if(GLAD_GL_VERSION_4_4 != 0)
+        {
+            return true;
+        }
+        // The extension exposes glBufferStorage under its core name, the window manager loads it
+        if(glad_glBufferStorage == nullptr)
+        {
+            return false;
+        }
+        cfg::int32 extensionCount {0};
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for(cfg::int32 i = 0; i < extensionCount; ++i)
+        {
+            const char* extension {reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))};
+            if(std::strcmp(extension, "GL_ARB_buffer_storage") == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }()};
+    return supported;
+}
+
+cfg::uint64 StreamBuffer::getUniformAlignment()
+{
+    static const cfg::uint64 alignment {[]() -> cfg::uint64 {
+        cfg::int32 value {0};
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+        return value > 0 ? static_cast<cfg::uint64>(value) : 256;
+    }()};
+    return alignment;
+}
+
+} // namespace gfx
@@ -0,0 +1,238 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <graphics/uniformBlock.hpp>
+
+#include <external/glm/gtc/type_ptr.hpp>
+
+#include "../core/GL/gl.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace gfx
+{
+Std140Writer::Std140Writer()
+    : m_buffer {}
+{
+}
+
+Std140Writer::~Std140Writer()
+{
+}
+
+void Std140Writer::write(const float v0)
+{
+    append(&v0, 4u, 4u);
+}
+
+void Std140Writer::write(const cfg::int32 v0)
+{
+    append(&v0, 4u, 4u);
+}
+
+void Std140Writer::write(const cfg::uint32 v0)
+{
+    append(&v0, 4u, 4u);
+}
+
+void Std140Writer::write(const bool v0)
+{
+    write(static_cast<cfg::uint32>(v0));
+}
+
+void Std140Writer::write(const glm::vec2& v)
+{
+    append(glm::value_ptr(v), 8u, 8u);
+}
+
+void Std140Writer::write(const glm::vec3& v)
+{
+    append(glm::value_ptr(v), 12u, 16u);
+}
+
+void Std140Writer::write(const glm::vec4& v)
+{
+    append(glm::value_ptr(v), 16u, 16u);
+}
+
+void Std140Writer::write(const glm::mat3& m0)
+{
+    // Matrices are stored as arrays of column vectors, each one with a vec4 stride
+    for(cfg::uint32 i = 0; i < 3; ++i)
+    {
+        append(glm::value_ptr(m0[i]), 12u, 16u);
+    }
+    align(16u);
+}
+
+void Std140Writer::write(const glm::mat4& m0)
+{
+    append(glm::value_ptr(m0), 64u, 16u);
+}
+
+void Std140Writer::beginStruct()
+{
+    align(16u);
+}
+
+void Std140Writer::endStruct()
+{
+    align(16u);
+}
+
+const cfg::byte* Std140Writer::data() const
+{
+    return m_buffer.data();
+}
+
+cfg::uint32 Std140Writer::size() const
+{
+    return static_cast<cfg::uint32>(m_buffer.size());
+}
+
+void Std140Writer::clear()
+{
+    m_buffer.clear();
+}
+
+void Std140Writer::align(const cfg::uint32 alignment)
+{
+    const size_t alignedSize {(m_buffer.size() + alignment - 1) & ~static_cast<size_t>(alignment - 1)};
+    m_buffer.resize(alignedSize, 0);
+}
+
+void Std140Writer::append(const void* src, const cfg::uint32 bytes, const cfg::uint32 alignment)
+{
+    align(alignment);
+    const size_t offset {m_buffer.size()};
+    m_buffer.resize(offset + bytes);
+    std::memcpy(m_buffer.data() + offset, src, bytes);
+}
+
+UniformBlock::UniformBlock(const cfg::uint32 t_bindingPoint, const cfg::uint32 t_size)
+    : m_UBO          {0},
+      m_size         {t_size},
+      m_bindingPoint {t_bindingPoint},
+      m_writer       {}
+{
+    glGenBuffers(1, &m_UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+    glBufferData(GL_UNIFORM_BUFFER, m_size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    bind();
+}
+
+UniformBlock::~UniformBlock()
+{
+    glDeleteBuffers(1, &m_UBO);
+}
+
+void UniformBlock::update(const void* data, const cfg::uint32 size, const cfg::uint32 offset)
+{
+    if(offset + size > m_size)
+    {
+        // Only the bytes in front of the update survive from the old storage, the rest is overwritten
+        cfg::uint32 grownUBO {0};
+        glGenBuffers(1, &grownUBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grownUBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, offset + size, nullptr, GL_DYNAMIC_DRAW);
+        const cfg::uint32 kept {std::min(m_size, offset)};
+        if(kept > 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_UBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, kept);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &m_UBO);
+        m_UBO = grownUBO;
+        m_size = offset + size;
+        bind();
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBlock::update(const Std140Writer& writer)
+{
+    update(writer.data(), writer.size());
+}
+
+void UniformBlock::bind() const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_UBO);
+}
+
+cfg::uint32 UniformBlock::getBindingPoint() const
+{
+    return m_bindingPoint;
+}
+
+void writeStd140(Std140Writer& writer, const CameraData& camera)
+{
+    writer.write(camera.view);
+    writer.write(camera.projection);
+    writer.write(camera.viewPos);
+    writer.endStruct();
+}
+
+void writeStd140(Std140Writer& writer, const DirLightData& light)
+{
+    writer.beginStruct();
+    writer.write(light.direction);
+    writer.write(light.ambient);
+    writer.write(light.diffuse);
+    writer.write(light.specular);
+    writer.endStruct();
+}
+
+void writeStd140(Std140Writer& writer, const PointLightData& light)
+{
+    writer.beginStruct();
+    writer.write(light.position);
+    writer.write(light.ambient);
+    writer.write(light.diffuse);
+    writer.write(light.specular);
+    writer.write(light.constant);
+    writer.write(light.linear);
+    writer.write(light.quadratic);
+    writer.endStruct();
+}
+
+void writeStd140(Std140Writer& writer, const LightsData& lights)
+{
+    writer.write(lights.lightColor);
+    writeStd140(writer, lights.dirLight);
+    writer.write(lights.nrPointLights);
+    for(cfg::uint32 i = 0; i < CURLY_MAX_POINT_LIGHTS; ++i)
+    {
+        writeStd140(writer, lights.pointLights[i]);
+    }
+    writer.endStruct();
+}
+
+} // namespace gfx
@@ -0,0 +1,117 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/clock.hpp>
+
+#if defined(CURLY_CLOCK_TSC_SUPPORT) && !defined(_MSC_VER)
+    #include <cpuid.h>
+#endif
+
+#include "timerPlatform.hpp"
+
+#define CURLY_CLOCK_CALIBRATION_TIME 5000000ll
+#define CURLY_CLOCK_MIN_TSC_RATE     100000000.0
+#define CURLY_CLOCK_MAX_TSC_RATE     10000000000.0
+
+namespace sys
+{
+namespace
+{
+bool hasInvariantTsc()
+{
+#if defined(CURLY_CLOCK_TSC_SUPPORT)
+    #if defined(_MSC_VER)
+    int regs[4] {};
+    __cpuid(regs, 0x80000000);
+    if(static_cast<unsigned int>(regs[0]) < 0x80000007u)
+    {
+        return false;
+    }
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+    #else
+    unsigned int eax {}, ebx {}, ecx {}, edx {};
+    if(!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+    #endif
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+bool Clock::s_tscEnabled {false};
+cfg::uint64 Clock::s_baseTicks {0};
+cfg::nanoT Clock::s_baseNanoseconds {0};
+double Clock::s_nanosecondsPerTick {1.0};
+
+// Calibrate before main so every consumer sees a single tick domain
+static const bool s_clockCalibrated {Clock::calibrate()};
+
+bool Clock::calibrate()
+{
+    const cfg::nanoT startNanoseconds {plat::getTime().asNanoseconds()};
+#if defined(CURLY_CLOCK_TSC_SUPPORT)
+    if(hasInvariantTsc())
+    {
+        // Bracket each TSC read between two platform reads to bound the pairing error
+        const cfg::uint64 startTicks {__rdtsc()};
+        const cfg::nanoT startCheck {plat::getTime().asNanoseconds()};
+
+        cfg::nanoT endNanoseconds {startCheck};
+        while(endNanoseconds - startNanoseconds < CURLY_CLOCK_CALIBRATION_TIME)
+        {
+            endNanoseconds = plat::getTime().asNanoseconds();
+        }
+        const cfg::uint64 endTicks {__rdtsc()};
+        const cfg::nanoT endCheck {plat::getTime().asNanoseconds()};
+
+        const double elapsedNanoseconds {0.5 * static_cast<double>((endNanoseconds + endCheck) - (startNanoseconds + startCheck))};
+        const double ticksPerSecond {static_cast<double>(endTicks - startTicks) * 1000000000.0 / elapsedNanoseconds};
+        if(ticksPerSecond >= CURLY_CLOCK_MIN_TSC_RATE && ticksPerSecond <= CURLY_CLOCK_MAX_TSC_RATE)
+        {
+            s_baseTicks          = endTicks;
+            s_baseNanoseconds    = endCheck;
+            s_nanosecondsPerTick = 1000000000.0 / ticksPerSecond;
+            s_tscEnabled         = true;
+            return true;
+        }
+    }
+#endif
+    s_baseTicks          = static_cast<cfg::uint64>(startNanoseconds);
+    s_baseNanoseconds    = startNanoseconds;
+    s_nanosecondsPerTick = 1.0;
+    s_tscEnabled         = false;
+    return false;
+}
+
+cfg::uint64 Clock::getPlatformTicks()
+{
+    return static_cast<cfg::uint64>(plat::getTime().asNanoseconds());
+}
+
+} // namespace sys
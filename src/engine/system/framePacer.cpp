@@ -0,0 +1,227 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/framePacer.hpp>
+#include <system/clock.hpp>
+
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <limits>
+
+#define CURLY_PACER_SLEEP_QUANTUM 1000000
+#define CURLY_PACER_SLEEP_WINDOW 1000u
+
+namespace sys
+{
+FramePacer::FramePacer(const PresentMode t_presentMode, const float t_targetFps, const bool t_lowLatency)
+    : m_presentMode        {t_presentMode},
+      m_presentModeVersion {1},
+      m_targetFps          {0.0f},
+      m_frameDuration      {0},
+      m_lowLatency         {t_lowLatency},
+      m_refreshRate        {0.0f},
+      m_deadline           {0},
+      m_lastFrame          {0},
+      m_sleepMean          {CURLY_PACER_SLEEP_QUANTUM * 1.25},
+      m_sleepM2            {0.0},
+      m_sleepCount         {0}
+{
+    setTargetFps(t_targetFps);
+    resetStats();
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void FramePacer::setPresentMode(const PresentMode presentMode)
+{
+    if(presentMode != m_presentMode)
+    {
+        m_presentMode = presentMode;
+        ++m_presentModeVersion;
+    }
+}
+
+void FramePacer::setTargetFps(const float targetFps)
+{
+    m_targetFps = targetFps > 0.0f ? targetFps : 0.0f;
+    m_frameDuration = m_targetFps > 0.0f ? static_cast<cfg::int64>(1e9 / m_targetFps) : 0;
+    m_deadline = 0;
+}
+
+void FramePacer::setLowLatency(const bool lowLatency)
+{
+    m_lowLatency = lowLatency;
+    m_deadline = 0;
+}
+
+void FramePacer::setRefreshRate(const float refreshRate)
+{
+    m_refreshRate = refreshRate > 0.0f ? refreshRate : 0.0f;
+}
+
+PresentMode FramePacer::getPresentMode() const
+{
+    return m_presentMode;
+}
+
+cfg::uint32 FramePacer::getPresentModeVersion() const
+{
+    return m_presentModeVersion;
+}
+
+float FramePacer::getTargetFps() const
+{
+    return m_targetFps;
+}
+
+bool FramePacer::isLowLatency() const
+{
+    return m_lowLatency;
+}
+
+float FramePacer::getRefreshRate() const
+{
+    return m_refreshRate;
+}
+
+void FramePacer::beginFrame()
+{
+    if(m_lowLatency)
+    {
+        pace();
+    }
+}
+
+void FramePacer::endFrame()
+{
+    if(!m_lowLatency)
+    {
+        pace();
+    }
+}
+
+FramePacingStats FramePacer::getStats() const
+{
+    FramePacingStats stats {};
+    stats.frameCount = m_frameCount;
+    stats.missedFrames = m_missedFrames;
+    stats.targetMs = static_cast<float>(m_frameDuration * 1e-6);
+    stats.sleepEstimateMs = static_cast<float>(m_sleepMean * 1e-6);
+    if(m_frameCount > 0)
+    {
+        stats.averageMs = static_cast<float>(m_frameMean * 1e-6);
+        stats.minMs = static_cast<float>(m_frameMin * 1e-6);
+        stats.maxMs = static_cast<float>(m_frameMax * 1e-6);
+        stats.jitterMs = static_cast<float>(std::sqrt(m_frameM2 / m_frameCount) * 1e-6);
+    }
+    return stats;
+}
+
+void FramePacer::resetStats()
+{
+    m_frameCount = 0;
+    m_missedFrames = 0;
+    m_frameMean = 0.0;
+    m_frameM2 = 0.0;
+    m_frameMin = std::numeric_limits<cfg::int64>::max();
+    m_frameMax = 0;
+    m_lastFrame = 0;
+}
+
+void FramePacer::pace()
+{
+    if(m_frameDuration > 0)
+    {
+        const cfg::int64 now {getNanoseconds()};
+        if((m_deadline == 0) || (now > m_deadline + m_frameDuration))
+        {
+            // First frame, or more than a whole frame late: resync instead of bursting to catch up
+            if(m_deadline != 0)
+            {
+                ++m_missedFrames;
+            }
+            m_deadline = now;
+        }
+        else
+        {
+            waitUntil(m_deadline);
+        }
+        m_deadline += m_frameDuration;
+    }
+
+    recordFrame(getNanoseconds());
+}
+
+void FramePacer::waitUntil(const cfg::int64 deadline)
+{
+    cfg::int64 now {getNanoseconds()};
+    while(deadline - now > m_sleepMean + std::sqrt(m_sleepM2 / (m_sleepCount > 1 ? m_sleepCount - 1 : 1)))
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(CURLY_PACER_SLEEP_QUANTUM));
+        const cfg::int64 after {getNanoseconds()};
+
+        // Welford over the observed sleep lengths, restarted now and then to follow the system load
+        if(m_sleepCount >= CURLY_PACER_SLEEP_WINDOW)
+        {
+            m_sleepCount = 0;
+            m_sleepM2 = 0.0;
+        }
+        const double observed {static_cast<double>(after - now)};
+        ++m_sleepCount;
+        const double delta {observed - m_sleepMean};
+        m_sleepMean += delta / m_sleepCount;
+        m_sleepM2 += delta * (observed - m_sleepMean);
+
+        now = after;
+    }
+
+    while(getNanoseconds() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::recordFrame(const cfg::int64 now)
+{
+    if(m_lastFrame != 0)
+    {
+        const cfg::int64 frameTime {now - m_lastFrame};
+        ++m_frameCount;
+        const double delta {frameTime - m_frameMean};
+        m_frameMean += delta / m_frameCount;
+        m_frameM2 += delta * (frameTime - m_frameMean);
+        m_frameMin = frameTime < m_frameMin ? frameTime : m_frameMin;
+        m_frameMax = frameTime > m_frameMax ? frameTime : m_frameMax;
+    }
+    m_lastFrame = now;
+}
+
+cfg::int64 FramePacer::getNanoseconds()
+{
+    return Clock::now().asNanoseconds();
+}
+
+} // namespace sys
@@ -0,0 +1,349 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/frameStats.hpp>
+
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#define CURLY_FRAME_STATS_MEDIAN_REFRESH 16u
+#define CURLY_FRAME_STATS_HITCH_FACTOR   2
+
+namespace sys
+{
+namespace
+{
+float toMilliseconds(const cfg::nanoT t_time)
+{
+    return static_cast<float>(static_cast<double>(t_time) / 1000000.0);
+}
+
+void writeTimeStats(std::ostream& t_stream, const FrameTimeStats& t_stats)
+{
+    t_stream << "{\"samples\": " << t_stats.sampleCount
+             << ", \"meanMs\": " << t_stats.meanMs
+             << ", \"p50Ms\": "  << t_stats.p50Ms
+             << ", \"p95Ms\": "  << t_stats.p95Ms
+             << ", \"p99Ms\": "  << t_stats.p99Ms
+             << ", \"maxMs\": "  << t_stats.maxMs << "}";
+}
+
+void writeHistogram(std::ostream& t_stream, const FrameHistogram& t_histogram)
+{
+    t_stream << "[";
+    bool first {true};
+    for(cfg::uint32 i = 0; i < CURLY_FRAME_HISTOGRAM_BUCKETS; ++i)
+    {
+        const cfg::uint64 count {t_histogram.getBucketCount(i)};
+        if(count == 0)
+        {
+            continue;
+        }
+        t_stream << (first ? "" : ", ") << "{\"upToUs\": " << FrameHistogram::getBucketUpperBound(i) << ", \"count\": " << count << "}";
+        first = false;
+    }
+    t_stream << "]";
+}
+
+} // namespace
+
+FrameHistogram::FrameHistogram()
+    : m_buckets {std::vector<cfg::uint64>(CURLY_FRAME_HISTOGRAM_BUCKETS, 0)},
+      m_count   {0},
+      m_total   {0},
+      m_max     {0}
+{
+}
+
+void FrameHistogram::record(const cfg::nanoT t_time)
+{
+    const cfg::nanoT time {std::max<cfg::nanoT>(t_time, 0)};
+    ++m_buckets[getBucketIndex(static_cast<cfg::uint64>(time / 1000))];
+    ++m_count;
+    m_total += time;
+    m_max = std::max(m_max, time);
+}
+
+void FrameHistogram::reset()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_total = 0;
+    m_max   = 0;
+}
+
+cfg::nanoT FrameHistogram::getPercentile(const double t_fraction) const
+{
+    if(m_count == 0)
+    {
+        return 0;
+    }
+
+    const double fraction {std::clamp(t_fraction, 0.0, 1.0)};
+    const cfg::uint64 rank {std::max<cfg::uint64>(1, static_cast<cfg::uint64>(std::ceil(fraction * static_cast<double>(m_count))))};
+    cfg::uint64 cumulative {0};
+    for(cfg::uint32 i = 0; i < CURLY_FRAME_HISTOGRAM_BUCKETS; ++i)
+    {
+        cumulative += m_buckets[i];
+        if(cumulative >= rank)
+        {
+            // Report the highest value of the bucket but never more than what was recorded
+            const cfg::nanoT upperBound {static_cast<cfg::nanoT>(getBucketUpperBound(i)) * 1000 + 999};
+            return std::min(upperBound, m_max);
+        }
+    }
+    return m_max;
+}
+
+FrameTimeStats FrameHistogram::getStats() const
+{
+    FrameTimeStats stats {};
+    stats.sampleCount = m_count;
+    if(m_count > 0)
+    {
+        stats.meanMs = toMilliseconds(m_total / static_cast<cfg::nanoT>(m_count));
+        stats.p50Ms  = toMilliseconds(getPercentile(0.50));
+        stats.p95Ms  = toMilliseconds(getPercentile(0.95));
+        stats.p99Ms  = toMilliseconds(getPercentile(0.99));
+        stats.maxMs  = toMilliseconds(m_max);
+    }
+    return stats;
+}
+
+cfg::uint64 FrameHistogram::getBucketCount(const cfg::uint32 t_bucket) const
+{
+    return t_bucket < CURLY_FRAME_HISTOGRAM_BUCKETS ? m_buckets[t_bucket] : 0;
+}
+
+cfg::uint64 FrameHistogram::getBucketUpperBound(const cfg::uint32 t_bucket)
+{
+    constexpr cfg::uint32 halfCount {CURLY_FRAME_HISTOGRAM_SUB_BUCKETS / 2u};
+    if(t_bucket < CURLY_FRAME_HISTOGRAM_SUB_BUCKETS)
+    {
+        return t_bucket;
+    }
+    const cfg::uint32 shift {(t_bucket - CURLY_FRAME_HISTOGRAM_SUB_BUCKETS) / halfCount + 1u};
+    const cfg::uint64 subBucket {(t_bucket - CURLY_FRAME_HISTOGRAM_SUB_BUCKETS) % halfCount + halfCount};
+    return ((subBucket + 1u) << shift) - 1u;
+}
+
+cfg::uint32 FrameHistogram::getBucketIndex(const cfg::uint64 t_micros)
+{
+    constexpr cfg::uint32 halfCount {CURLY_FRAME_HISTOGRAM_SUB_BUCKETS / 2u};
+    if(t_micros < CURLY_FRAME_HISTOGRAM_SUB_BUCKETS)
+    {
+        return static_cast<cfg::uint32>(t_micros);
+    }
+    // Keep the most significant bits: the top one selects the magnitude, the rest the sub bucket
+    const cfg::uint32 shift {static_cast<cfg::uint32>(std::bit_width(t_micros)) - CURLY_FRAME_HISTOGRAM_SUB_BITS};
+    if(shift > CURLY_FRAME_HISTOGRAM_MAX_SHIFT)
+    {
+        return CURLY_FRAME_HISTOGRAM_BUCKETS - 1u;
+    }
+    return CURLY_FRAME_HISTOGRAM_SUB_BUCKETS + (shift - 1u) * halfCount + static_cast<cfg::uint32>((t_micros >> shift) - halfCount);
+}
+
+FrameStats::FrameStats(const cfg::uint32 t_capacity)
+    : m_samples        {std::vector<FrameSample>(std::max(t_capacity, 1u))},
+      m_frameCount     {0},
+      m_hitchCount     {0},
+      m_cpuHistogram   {},
+      m_gpuHistogram   {},
+      m_hitchThreshold {0},
+      m_medianEstimate {0}
+{
+}
+
+FrameStats::~FrameStats()
+{
+}
+
+cfg::uint64 FrameStats::recordFrame(const cfg::nanoT t_cpuTime)
+{
+    const cfg::uint64 frameIndex {m_frameCount++};
+    FrameSample& sample {m_samples[frameIndex % m_samples.size()]};
+    sample.frameIndex = frameIndex;
+    sample.cpuTime    = t_cpuTime;
+    sample.gpuTime    = CURLY_FRAME_STATS_UNKNOWN_TIME;
+    sample.hitch      = isHitch(t_cpuTime);
+    if(sample.hitch)
+    {
+        ++m_hitchCount;
+    }
+
+    m_cpuHistogram.record(t_cpuTime);
+    if(m_frameCount % CURLY_FRAME_STATS_MEDIAN_REFRESH == 0)
+    {
+        m_medianEstimate = m_cpuHistogram.getPercentile(0.5);
+    }
+    return frameIndex;
+}
+
+void FrameStats::recordGpuTime(const cfg::uint64 t_frameIndex, const cfg::nanoT t_gpuTime)
+{
+    if(t_frameIndex >= m_frameCount || m_frameCount - t_frameIndex > m_samples.size())
+    {
+        return;
+    }
+
+    FrameSample& sample {m_samples[t_frameIndex % m_samples.size()]};
+    if(sample.gpuTime != CURLY_FRAME_STATS_UNKNOWN_TIME)
+    {
+        return;
+    }
+    sample.gpuTime = t_gpuTime;
+    m_gpuHistogram.record(t_gpuTime);
+    if(!sample.hitch && isHitch(t_gpuTime))
+    {
+        sample.hitch = true;
+        ++m_hitchCount;
+    }
+}
+
+void FrameStats::reset()
+{
+    m_frameCount     = 0;
+    m_hitchCount     = 0;
+    m_medianEstimate = 0;
+    m_cpuHistogram.reset();
+    m_gpuHistogram.reset();
+}
+
+void FrameStats::setHitchThreshold(const cfg::nanoT t_threshold)
+{
+    m_hitchThreshold = std::max<cfg::nanoT>(t_threshold, 0);
+}
+
+cfg::nanoT FrameStats::getHitchThreshold() const
+{
+    return m_hitchThreshold;
+}
+
+FrameStatsSummary FrameStats::getSummary() const
+{
+    FrameStatsSummary summary {};
+    summary.frameCount = m_frameCount;
+    summary.hitchCount = m_hitchCount;
+    summary.cpu        = m_cpuHistogram.getStats();
+    summary.gpu        = m_gpuHistogram.getStats();
+    return summary;
+}
+
+std::vector<FrameSample> FrameStats::getSamples() const
+{
+    const cfg::uint64 count {std::min<cfg::uint64>(m_frameCount, m_samples.size())};
+    std::vector<FrameSample> samples;
+    samples.reserve(count);
+    for(cfg::uint64 frameIndex = m_frameCount - count; frameIndex < m_frameCount; ++frameIndex)
+    {
+        samples.push_back(m_samples[frameIndex % m_samples.size()]);
+    }
+    return samples;
+}
+
+cfg::uint64 FrameStats::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+cfg::uint64 FrameStats::getHitchCount() const
+{
+    return m_hitchCount;
+}
+
+bool FrameStats::exportCSV(const std::string& t_path) const
+{
+    std::ofstream file {t_path};
+    if(!file)
+    {
+        std::cerr << "Couldn't open " << t_path << " to export frame stats" << std::endl;
+        return false;
+    }
+
+    file << "frame,cpu_ms,gpu_ms,hitch\n";
+    for(const FrameSample& sample : getSamples())
+    {
+        file << sample.frameIndex << ',' << toMilliseconds(sample.cpuTime) << ',';
+        if(sample.gpuTime != CURLY_FRAME_STATS_UNKNOWN_TIME)
+        {
+            file << toMilliseconds(sample.gpuTime);
+        }
+        file << ',' << (sample.hitch ? 1 : 0) << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool FrameStats::exportJSON(const std::string& t_path) const
+{
+    std::ofstream file {t_path};
+    if(!file)
+    {
+        std::cerr << "Couldn't open " << t_path << " to export frame stats" << std::endl;
+        return false;
+    }
+
+    const FrameStatsSummary summary {getSummary()};
+    file << "{\n  \"frameCount\": " << summary.frameCount << ",\n  \"hitchCount\": " << summary.hitchCount << ",\n";
+    file << "  \"hitchThresholdMs\": " << toMilliseconds(m_hitchThreshold > 0 ? m_hitchThreshold : m_medianEstimate * CURLY_FRAME_STATS_HITCH_FACTOR) << ",\n";
+    file << "  \"cpu\": ";
+    writeTimeStats(file, summary.cpu);
+    file << ",\n  \"gpu\": ";
+    writeTimeStats(file, summary.gpu);
+    file << ",\n  \"cpuHistogram\": ";
+    writeHistogram(file, m_cpuHistogram);
+    file << ",\n  \"gpuHistogram\": ";
+    writeHistogram(file, m_gpuHistogram);
+    file << ",\n  \"frames\": [";
+
+    bool first {true};
+    for(const FrameSample& sample : getSamples())
+    {
+        file << (first ? "\n    " : ",\n    ") << "{\"frame\": " << sample.frameIndex << ", \"cpuMs\": " << toMilliseconds(sample.cpuTime) << ", \"gpuMs\": ";
+        if(sample.gpuTime != CURLY_FRAME_STATS_UNKNOWN_TIME)
+        {
+            file << toMilliseconds(sample.gpuTime);
+        }
+        else
+        {
+            file << "null";
+        }
+        file << ", \"hitch\": " << (sample.hitch ? "true" : "false") << "}";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+bool FrameStats::isHitch(const cfg::nanoT t_time) const
+{
+    if(m_hitchThreshold > 0)
+    {
+        return t_time > m_hitchThreshold;
+    }
+    return m_medianEstimate > 0 && t_time > m_medianEstimate * CURLY_FRAME_STATS_HITCH_FACTOR;
+}
+
+} // namespace sys
@@ -0,0 +1,192 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/gameLoop.hpp>
+#include <system/clock.hpp>
+#include <system/profiler.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+namespace sys
+{
+GameLoop::GameLoop(const float t_updateRate, const cfg::uint32 t_maxSteps)
+    : m_step         {0},
+      m_accumulator  {0},
+      m_snapResidual {0},
+      m_lastTime     {Clock::now().asNanoseconds()},
+      m_maxSteps     {std::max(t_maxSteps, 1u)},
+      m_timeScale    {1.0f},
+      m_alpha        {0.0f},
+      m_framePacer   {nullptr},
+      m_stats        {}
+{
+    setUpdateRate(t_updateRate);
+}
+
+GameLoop::~GameLoop()
+{
+}
+
+void GameLoop::setUpdateRate(const float t_updateRate)
+{
+    const float updateRate {t_updateRate > 0.0f ? t_updateRate : CURLY_GAME_LOOP_DEFAULT_RATE};
+    m_step = static_cast<cfg::nanoT>(1000000000.0 / static_cast<double>(updateRate));
+}
+
+void GameLoop::setMaxSteps(const cfg::uint32 t_maxSteps)
+{
+    m_maxSteps = std::max(t_maxSteps, 1u);
+}
+
+void GameLoop::setTimeScale(const float t_timeScale)
+{
+    m_timeScale = std::max(t_timeScale, 0.0f);
+}
+
+void GameLoop::setFramePacer(const FramePacer& t_framePacer)
+{
+    m_framePacer = &t_framePacer;
+}
+
+void GameLoop::restart()
+{
+    m_lastTime     = Clock::now().asNanoseconds();
+    m_accumulator  = 0;
+    m_snapResidual = 0;
+    m_alpha        = 0.0f;
+    m_stats        = {};
+}
+
+cfg::uint32 GameLoop::advance(const std::function<void(const cfg::secT)>& t_update)
+{
+    const cfg::nanoT now {Clock::now().asNanoseconds()};
+    // A debugger break or a loading hitch must not be simulated in one go
+    const cfg::nanoT frameTime {snapFrameTime(std::min<cfg::nanoT>(now - m_lastTime, CURLY_GAME_LOOP_MAX_FRAME_TIME))};
+    m_lastTime = now;
+    m_accumulator += static_cast<cfg::nanoT>(static_cast<double>(frameTime) * static_cast<double>(m_timeScale));
+
+    const cfg::secT fixedDeltaTime {getFixedDeltaTime()};
+    cfg::uint32 steps {0};
+    while(m_accumulator >= m_step && steps < m_maxSteps)
+    {
+        t_update(fixedDeltaTime);
+        m_accumulator -= m_step;
+        ++steps;
+    }
+
+    if(m_accumulator >= m_step)
+    {
+        const cfg::nanoT dropped {m_accumulator / m_step};
+        m_accumulator -= dropped * m_step;
+        m_stats.droppedSteps += static_cast<cfg::uint64>(dropped);
+        ++m_stats.cappedFrames;
+    }
+
+    m_alpha = static_cast<float>(static_cast<double>(m_accumulator) / static_cast<double>(m_step));
+    m_stats.stepCount += steps;
+    ++m_stats.frameCount;
+    return steps;
+}
+
+void GameLoop::run(const GameLoopCallbacks& t_callbacks)
+{
+    restart();
+    while(!t_callbacks.beginFrame || t_callbacks.beginFrame())
+    {
+        {
+            CURLY_PROFILE_SCOPE("GameLoop::update");
+            advance(t_callbacks.update ? t_callbacks.update : [](const cfg::secT) {});
+        }
+        if(t_callbacks.render)
+        {
+            CURLY_PROFILE_SCOPE("GameLoop::render");
+            t_callbacks.render(m_alpha);
+        }
+        if(t_callbacks.endFrame)
+        {
+            t_callbacks.endFrame();
+        }
+    }
+}
+
+float GameLoop::getAlpha() const
+{
+    return m_alpha;
+}
+
+cfg::secT GameLoop::getFixedDeltaTime() const
+{
+    return nanoseconds(m_step).asSeconds();
+}
+
+float GameLoop::getUpdateRate() const
+{
+    return static_cast<float>(1000000000.0 / static_cast<double>(m_step));
+}
+
+GameLoopStats GameLoop::getStats() const
+{
+    return m_stats;
+}
+
+cfg::nanoT GameLoop::snapFrameTime(const cfg::nanoT t_frameTime)
+{
+    const double period {getSnapPeriod()};
+    // Whatever earlier snaps added or removed is paid back here
+    const cfg::nanoT frameTime {t_frameTime + m_snapResidual};
+    if(period <= 0.0)
+    {
+        m_snapResidual = 0;
+        return frameTime;
+    }
+
+    const double periods {std::round(static_cast<double>(frameTime) / period)};
+    const cfg::nanoT snapped {static_cast<cfg::nanoT>(periods * period)};
+    if(periods >= 1.0 && std::abs(frameTime - snapped) <= CURLY_GAME_LOOP_SNAP_TOLERANCE)
+    {
+        m_snapResidual = frameTime - snapped;
+        return snapped;
+    }
+    m_snapResidual = 0;
+    return frameTime;
+}
+
+double GameLoop::getSnapPeriod() const
+{
+    if(m_framePacer == nullptr)
+    {
+        return 0.0;
+    }
+    if(m_framePacer->getTargetFps() > 0.0f)
+    {
+        return 1000000000.0 / static_cast<double>(m_framePacer->getTargetFps());
+    }
+    if(m_framePacer->getPresentMode() != PRESENT_IMMEDIATE && m_framePacer->getRefreshRate() > 0.0f)
+    {
+        return 1000000000.0 / static_cast<double>(m_framePacer->getRefreshRate());
+    }
+    return 0.0;
+}
+
+} // namespace sys
@@ -0,0 +1,230 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define CURLY_PERF_RDPMC_SUPPORT
+#endif
+
+#include "../perfCountersPlatform.hpp"
+
+namespace sys
+{
+namespace plat
+{
+struct PerfCounterGroup
+{
+    int fds[PERF_COUNTER_COUNT];
+    perf_event_mmap_page* pages[PERF_COUNTER_COUNT];
+    // Position of each counter in the group read, in opening order
+    cfg::uint32 slots[PERF_COUNTER_COUNT];
+    cfg::uint32 openCount;
+    int leader;
+    bool rdpmc;
+};
+
+namespace
+{
+constexpr cfg::uint64 s_perfConfigs[PERF_COUNTER_COUNT]
+{
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+int perfEventOpen(perf_event_attr& t_attr, const int t_groupFd)
+{
+    // Calling thread on any cpu
+    return static_cast<int>(syscall(SYS_perf_event_open, &t_attr, 0, -1, t_groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+#if defined(CURLY_PERF_RDPMC_SUPPORT)
+bool readRdpmc(const perf_event_mmap_page* t_page, cfg::uint64& t_value)
+{
+    // Seqlock protocol from linux/perf_event.h
+    cfg::uint32 sequence {};
+    do
+    {
+        sequence = t_page->lock;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        const cfg::uint32 index {t_page->index};
+        if(!t_page->cap_user_rdpmc || index == 0)
+        {
+            return false;
+        }
+        cfg::int64 count {static_cast<cfg::int64>(__rdpmc(static_cast<int>(index - 1)))};
+        const cfg::uint32 width {t_page->pmc_width};
+        count = static_cast<cfg::int64>(static_cast<cfg::uint64>(count) << (64 - width)) >> (64 - width);
+        t_value = static_cast<cfg::uint64>(t_page->offset + count);
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    }
+    while(t_page->lock != sequence);
+    return true;
+}
+#endif
+
+} // namespace
+
+PerfCounterGroup* openPerfCounters()
+{
+    PerfCounterGroup* group {new PerfCounterGroup {}};
+    group->leader    = -1;
+    group->openCount = 0;
+    group->rdpmc     = false;
+
+    const long pageSize {sysconf(_SC_PAGESIZE)};
+    for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        group->fds[i]   = -1;
+        group->pages[i] = nullptr;
+
+        perf_event_attr attr {};
+        attr.size           = sizeof(perf_event_attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = s_perfConfigs[i];
+        attr.disabled       = (group->leader < 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP;
+
+        // A counter the PMU does not have is skipped, the rest of the group still works
+        const int fd {perfEventOpen(attr, group->leader)};
+        if(fd < 0)
+        {
+            continue;
+        }
+        if(group->leader < 0)
+        {
+            group->leader = fd;
+        }
+        group->fds[i]   = fd;
+        group->slots[i] = group->openCount++;
+
+        void* page {mmap(nullptr, static_cast<size_t>(pageSize), PROT_READ, MAP_SHARED, fd, 0)};
+        group->pages[i] = (page != MAP_FAILED) ? static_cast<perf_event_mmap_page*>(page) : nullptr;
+    }
+
+    if(group->leader < 0)
+    {
+        delete group;
+        return nullptr;
+    }
+
+    ioctl(group->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+#if defined(CURLY_PERF_RDPMC_SUPPORT)
+    group->rdpmc = true;
+    for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        cfg::uint64 value {};
+        if(group->fds[i] >= 0 && (group->pages[i] == nullptr || !readRdpmc(group->pages[i], value)))
+        {
+            group->rdpmc = false;
+        }
+    }
+#endif
+    return group;
+}
+
+void closePerfCounters(PerfCounterGroup* t_group)
+{
+    if(t_group == nullptr)
+    {
+        return;
+    }
+
+    const long pageSize {sysconf(_SC_PAGESIZE)};
+    for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if(t_group->pages[i] != nullptr)
+        {
+            munmap(t_group->pages[i], static_cast<size_t>(pageSize));
+        }
+    }
+    // Followers go first, the leader owns the group
+    for(cfg::uint32 i = PERF_COUNTER_COUNT; i-- > 0;)
+    {
+        if(t_group->fds[i] >= 0)
+        {
+            close(t_group->fds[i]);
+        }
+    }
+    delete t_group;
+}
+
+bool isPerfCounterOpen(const PerfCounterGroup* t_group, const PerfCounter t_counter)
+{
+    return t_group != nullptr && t_counter < PERF_COUNTER_COUNT && t_group->fds[t_counter] >= 0;
+}
+
+bool readPerfCounters(PerfCounterGroup* t_group, PerfCounterSample& t_sample)
+{
+    if(t_group == nullptr)
+    {
+        return false;
+    }
+
+#if defined(CURLY_PERF_RDPMC_SUPPORT)
+    if(t_group->rdpmc)
+    {
+        bool valid {true};
+        for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+        {
+            t_sample.values[i] = 0;
+            if(t_group->fds[i] >= 0)
+            {
+                valid = readRdpmc(t_group->pages[i], t_sample.values[i]) && valid;
+            }
+        }
+        if(valid)
+        {
+            return true;
+        }
+    }
+#endif
+
+    // { nr, values[nr] } with PERF_FORMAT_GROUP
+    cfg::uint64 buffer[PERF_COUNTER_COUNT + 1] {};
+    const ssize_t size {::read(t_group->leader, buffer, sizeof(cfg::uint64) * (t_group->openCount + 1))};
+    if(size < static_cast<ssize_t>(sizeof(cfg::uint64)) || buffer[0] != t_group->openCount)
+    {
+        return false;
+    }
+    for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        t_sample.values[i] = (t_group->fds[i] >= 0) ? buffer[1 + t_group->slots[i]] : 0;
+    }
+    return true;
+}
+
+} // namespace plat
+
+} // namespace sys
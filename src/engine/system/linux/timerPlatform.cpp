@@ -25,7 +25,7 @@
 
 #include "../timerPlatform.hpp"
 
-namespace gil
+namespace sys
 {
 namespace plat
 {
@@ -37,13 +37,10 @@ namespace plat
 Time getTime()
 {
     timespec ts {};
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    uint64 tick {};
-    tick  = ts.tv_nsec / 1000;
-    tick += ts.tv_sec * 1000000;
-    return rawTimeBuilder(tick);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return nanoseconds(static_cast<cfg::nanoT>(ts.tv_sec) * 1000000000ll + static_cast<cfg::nanoT>(ts.tv_nsec));
 }
 
 } // namespace plat
 
-} // namespace gil
+} // namespace sys
@@ -0,0 +1,182 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/perfCounters.hpp>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "perfCountersPlatform.hpp"
+
+namespace sys
+{
+namespace
+{
+struct ZoneAggregate
+{
+    cfg::uint64 calls;
+    PerfCounterSample totals;
+    cfg::uint64 frameCalls;
+    PerfCounterSample frameTotals;
+};
+
+struct PerfCountersState
+{
+    std::mutex mutex;
+    // Keyed by content, a name built at runtime or repeated across translation units is one zone
+    std::unordered_map<std::string, ZoneAggregate> zones;
+    std::vector<PerfZoneStats> lastFrame;
+};
+
+PerfCountersState& getState()
+{
+    static PerfCountersState state;
+    return state;
+}
+
+/**
+ * @brief Owns the counter group of one thread and closes it when the thread exits
+ * 
+ */
+struct ThreadCounters
+{
+    ThreadCounters()
+        : group {plat::openPerfCounters()}
+    {
+    }
+
+    ~ThreadCounters()
+    {
+        plat::closePerfCounters(group);
+    }
+
+    plat::PerfCounterGroup* group;
+};
+
+plat::PerfCounterGroup* getThreadGroup()
+{
+    thread_local ThreadCounters s_threadCounters;
+    return s_threadCounters.group;
+}
+
+double getRatio(const cfg::uint64 t_numerator, const cfg::uint64 t_denominator, const double t_scale)
+{
+    return t_denominator > 0 ? static_cast<double>(t_numerator) * t_scale / static_cast<double>(t_denominator) : 0.0;
+}
+
+} // namespace
+
+bool PerfCounters::isAvailable()
+{
+    return getThreadGroup() != nullptr;
+}
+
+bool PerfCounters::isCounterAvailable(const PerfCounter t_counter)
+{
+    return plat::isPerfCounterOpen(getThreadGroup(), t_counter);
+}
+
+bool PerfCounters::read(PerfCounterSample& t_sample)
+{
+    return plat::readPerfCounters(getThreadGroup(), t_sample);
+}
+
+void PerfCounters::recordZone(const char* t_name, const PerfCounterSample& t_begin, const PerfCounterSample& t_end)
+{
+    PerfCountersState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    ZoneAggregate& zone {state.zones[t_name]};
+    ++zone.calls;
+    ++zone.frameCalls;
+    for(cfg::uint32 i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        const cfg::uint64 delta {t_end.values[i] - t_begin.values[i]};
+        zone.totals.values[i] += delta;
+        zone.frameTotals.values[i] += delta;
+    }
+}
+
+void PerfCounters::endFrame()
+{
+    PerfCountersState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    state.lastFrame.clear();
+    for(auto& [name, zone] : state.zones)
+    {
+        if(zone.frameCalls > 0)
+        {
+            state.lastFrame.push_back({name.c_str(), zone.frameCalls, zone.frameTotals});
+        }
+        zone.frameCalls  = 0;
+        zone.frameTotals = {};
+    }
+}
+
+void PerfCounters::reset()
+{
+    PerfCountersState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    state.zones.clear();
+    state.lastFrame.clear();
+}
+
+std::vector<PerfZoneStats> PerfCounters::getZoneStats()
+{
+    PerfCountersState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    std::vector<PerfZoneStats> stats;
+    stats.reserve(state.zones.size());
+    for(const auto& [name, zone] : state.zones)
+    {
+        stats.push_back({name.c_str(), zone.calls, zone.totals});
+    }
+    return stats;
+}
+
+std::vector<PerfZoneStats> PerfCounters::getLastFrameStats()
+{
+    PerfCountersState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    return state.lastFrame;
+}
+
+double PerfCounters::getIPC(const PerfZoneStats& t_stats)
+{
+    return getRatio(t_stats.totals.values[PERF_INSTRUCTIONS], t_stats.totals.values[PERF_CYCLES], 1.0);
+}
+
+double PerfCounters::getCacheMPKI(const PerfZoneStats& t_stats)
+{
+    return getRatio(t_stats.totals.values[PERF_CACHE_MISSES], t_stats.totals.values[PERF_INSTRUCTIONS], 1000.0);
+}
+
+double PerfCounters::getBranchMPKI(const PerfZoneStats& t_stats)
+{
+    return getRatio(t_stats.totals.values[PERF_BRANCH_MISSES], t_stats.totals.values[PERF_INSTRUCTIONS], 1000.0);
+}
+
+} // namespace sys
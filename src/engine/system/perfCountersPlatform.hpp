@@ -0,0 +1,74 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#pragma once
+
+#include <core/config.hpp>
+#include <core/common.hpp>
+
+#include <system/perfCounters.hpp>
+
+namespace sys
+{
+namespace plat
+{
+/**
+ * @brief Opaque counter group of a single thread
+ * 
+ */
+struct PerfCounterGroup;
+
+/**
+ * @brief Open the counters for the calling thread
+ * 
+ * @return PerfCounterGroup* nullptr when no counter is available
+ */
+CURLY_API PerfCounterGroup* openPerfCounters();
+/**
+ * @brief Close a counter group
+ * 
+ * @param t_group 
+ */
+CURLY_API void closePerfCounters(PerfCounterGroup* t_group);
+/**
+ * @brief Check whether a counter of the group could be opened
+ * 
+ * @param t_group 
+ * @param t_counter 
+ * @return true 
+ * @return false 
+ */
+CURLY_API bool isPerfCounterOpen(const PerfCounterGroup* t_group, const PerfCounter t_counter);
+/**
+ * @brief Read every counter of the group, it must be called from the thread that opened it
+ * 
+ * @param t_group 
+ * @param t_sample 
+ * @return true 
+ * @return false 
+ */
+CURLY_API bool readPerfCounters(PerfCounterGroup* t_group, PerfCounterSample& t_sample);
+
+} // namespace plat
+
+} // namespace sys
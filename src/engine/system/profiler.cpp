@@ -0,0 +1,354 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/profiler.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+#include <iostream>
+
+namespace sys
+{
+namespace
+{
+struct ProfileSlot
+{
+    // Odd while event 'i' is being written (2i + 1), even once it is published (2i + 2)
+    std::atomic<cfg::uint64> sequence;
+    std::atomic<const char*> name;
+    std::atomic<cfg::uint64> begin;
+    std::atomic<cfg::uint64> end;
+};
+
+struct ThreadRing
+{
+    explicit ThreadRing(const cfg::uint32 t_index)
+        : slots {std::make_unique<ProfileSlot[]>(CURLY_PROFILER_THREAD_CAPACITY)},
+          head  {0},
+          tail  {0},
+          index {t_index}
+    {
+    }
+
+    std::unique_ptr<ProfileSlot[]> slots;
+    std::atomic<cfg::uint64> head;
+    cfg::uint64 tail;
+    cfg::uint32 index;
+};
+
+struct ProfilerState
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::vector<ThreadRing*> freeRings;
+    std::vector<std::string> trackNames;
+    std::vector<ProfileRecord> records;
+    cfg::uint64 recordCapacity {CURLY_PROFILER_RECORD_CAPACITY};
+    cfg::uint64 pendingDropped {0};
+    std::atomic<bool> enabled {true};
+};
+
+ProfilerState& getState()
+{
+    // Function local so zones recorded during static initialization are safe
+    static ProfilerState state;
+    return state;
+}
+
+void trimRecords(ProfilerState& t_state)
+{
+    // Trimming in batches keeps the erase amortized over many pushes
+    const cfg::uint64 capacity {t_state.recordCapacity};
+    if((capacity > 0) && (t_state.records.size() > capacity + capacity / 4u))
+    {
+        t_state.records.erase(t_state.records.begin(), t_state.records.end() - static_cast<std::ptrdiff_t>(capacity));
+    }
+}
+
+cfg::uint32 addTrack(ProfilerState& t_state, const std::string* t_name)
+{
+    const cfg::uint32 index {static_cast<cfg::uint32>(t_state.trackNames.size())};
+    t_state.trackNames.push_back(t_name != nullptr ? *t_name : "Thread " + std::to_string(index));
+    return index;
+}
+
+// Called with the state locked
+cfg::uint64 collectRing(ProfilerState& t_state, ThreadRing& t_ring)
+{
+    const cfg::uint64 head {t_ring.head.load(std::memory_order_acquire)};
+    cfg::uint64 first {t_ring.tail};
+    cfg::uint64 dropped {0};
+    // The producer may already be rewriting the slot of 'head', which is also the slot of head - capacity
+    if(head + 1u > first + CURLY_PROFILER_THREAD_CAPACITY)
+    {
+        dropped += head + 1u - CURLY_PROFILER_THREAD_CAPACITY - first;
+        first = head + 1u - CURLY_PROFILER_THREAD_CAPACITY;
+    }
+
+    for(cfg::uint64 i = first; i < head; ++i)
+    {
+        const ProfileSlot& slot {t_ring.slots[i & (CURLY_PROFILER_THREAD_CAPACITY - 1u)]};
+        const cfg::uint64 published {2u * i + 2u};
+        if(slot.sequence.load(std::memory_order_acquire) != published)
+        {
+            ++dropped;
+            continue;
+        }
+        const ProfileEvent event {slot.name.load(std::memory_order_relaxed),
+                                  slot.begin.load(std::memory_order_relaxed),
+                                  slot.end.load(std::memory_order_relaxed)};
+        // A producer that lapped us while we copied has bumped the sequence, the copy may be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != published)
+        {
+            ++dropped;
+            continue;
+        }
+        t_state.records.push_back({event, t_ring.index});
+    }
+    t_ring.tail = head;
+    trimRecords(t_state);
+    return dropped;
+}
+
+ThreadRing* acquireRing(const std::string* t_name)
+{
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    if(!state.freeRings.empty())
+    {
+        // Rings were drained when their thread exited, prefer one whose track already has the right name
+        auto reusable {std::find_if(state.freeRings.begin(), state.freeRings.end(), [&state, t_name](const ThreadRing* t_ring)
+        {
+            const std::string& trackName {state.trackNames[t_ring->index]};
+            return (t_name != nullptr) ? trackName == *t_name : trackName == "Thread " + std::to_string(t_ring->index);
+        })};
+        if(reusable == state.freeRings.end())
+        {
+            reusable = state.freeRings.end() - 1;
+            (*reusable)->index = addTrack(state, t_name);
+        }
+        ThreadRing* ring {*reusable};
+        state.freeRings.erase(reusable);
+        return ring;
+    }
+    state.rings.push_back(std::make_unique<ThreadRing>(addTrack(state, t_name)));
+    return state.rings.back().get();
+}
+
+struct ThreadRingOwner
+{
+    ~ThreadRingOwner()
+    {
+        if(ring == nullptr)
+        {
+            return;
+        }
+        // Drain before handing the ring over, so the next thread never inherits these events
+        ProfilerState& state {getState()};
+        std::lock_guard<std::mutex> lock {state.mutex};
+        state.pendingDropped += collectRing(state, *ring);
+        state.freeRings.push_back(ring);
+    }
+
+    ThreadRing* ring {nullptr};
+};
+
+ThreadRingOwner& getThreadRingOwner()
+{
+    // Short lived threads hand their ring back on exit, so the ring count follows the peak thread count
+    thread_local ThreadRingOwner s_threadRingOwner;
+    return s_threadRingOwner;
+}
+
+void writeEscaped(std::ostream& t_stream, const char* t_text)
+{
+    for(const char* c = t_text; *c != '\0'; ++c)
+    {
+        if(*c == '"' || *c == '\\')
+        {
+            t_stream << '\\';
+        }
+        t_stream << *c;
+    }
+}
+
+} // namespace
+
+void Profiler::record(const char* t_name, const cfg::uint64 t_begin, const cfg::uint64 t_end)
+{
+    if(!getState().enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    ThreadRingOwner& owner {getThreadRingOwner()};
+    if(owner.ring == nullptr)
+    {
+        owner.ring = acquireRing(nullptr);
+    }
+    ThreadRing& ring {*owner.ring};
+    const cfg::uint64 head {ring.head.load(std::memory_order_relaxed)};
+    ProfileSlot& slot {ring.slots[head & (CURLY_PROFILER_THREAD_CAPACITY - 1u)]};
+    // Claim the slot before touching it, a collector reading it concurrently sees the odd sequence
+    slot.sequence.store(2u * head + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(t_name, std::memory_order_relaxed);
+    slot.begin.store(t_begin, std::memory_order_relaxed);
+    slot.end.store(t_end, std::memory_order_relaxed);
+    slot.sequence.store(2u * head + 2u, std::memory_order_release);
+    ring.head.store(head + 1u, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& t_name)
+{
+    ThreadRingOwner& owner {getThreadRingOwner()};
+    if(owner.ring == nullptr)
+    {
+        owner.ring = acquireRing(&t_name);
+        return;
+    }
+
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    if(state.trackNames[owner.ring->index] == t_name)
+    {
+        return;
+    }
+    // Track names never change, events recorded so far keep the name they were recorded under
+    state.pendingDropped += collectRing(state, *owner.ring);
+    owner.ring->index = addTrack(state, &t_name);
+}
+
+cfg::uint32 Profiler::createTrack(const std::string& t_name)
+{
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    return addTrack(state, &t_name);
+}
+
+void Profiler::recordOnTrack(const cfg::uint32 t_track, const char* t_name, const cfg::uint64 t_begin, const cfg::uint64 t_end)
+{
+    ProfilerState& state {getState()};
+    if(!state.enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock {state.mutex};
+    state.records.push_back({{t_name, t_begin, t_end}, t_track});
+    trimRecords(state);
+}
+
+void Profiler::setEnabled(const bool t_enabled)
+{
+    getState().enabled.store(t_enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled()
+{
+    return getState().enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setRecordCapacity(const cfg::uint64 t_capacity)
+{
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    state.recordCapacity = t_capacity;
+    if((t_capacity > 0) && (state.records.size() > t_capacity))
+    {
+        state.records.erase(state.records.begin(), state.records.end() - static_cast<std::ptrdiff_t>(t_capacity));
+    }
+}
+
+cfg::uint64 Profiler::collect()
+{
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    cfg::uint64 dropped {state.pendingDropped};
+    state.pendingDropped = 0;
+    for(const std::unique_ptr<ThreadRing>& ring : state.rings)
+    {
+        dropped += collectRing(state, *ring);
+    }
+    return dropped;
+}
+
+const std::vector<ProfileRecord>& Profiler::getRecords()
+{
+    return getState().records;
+}
+
+void Profiler::clear()
+{
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+    state.records.clear();
+}
+
+bool Profiler::writeChromeTrace(const std::string& t_path)
+{
+    const cfg::uint64 dropped {collect()};
+    if(dropped > 0)
+    {
+        std::cerr << "Profiler dropped " << dropped << " events, collect more often" << std::endl;
+    }
+
+    std::ofstream file {t_path};
+    if(!file)
+    {
+        std::cerr << "Couldn't open " << t_path << " to write the profiler trace" << std::endl;
+        return false;
+    }
+
+    ProfilerState& state {getState()};
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first {true};
+    for(cfg::uint32 track = 0; track < state.trackNames.size(); ++track)
+    {
+        file << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << track << ", \"args\": {\"name\": \"";
+        writeEscaped(file, state.trackNames[track].c_str());
+        file << "\"}}";
+        first = false;
+    }
+    for(const ProfileRecord& record : state.records)
+    {
+        const double timestamp {static_cast<double>(Clock::ticksToTime(record.event.begin).asNanoseconds()) / 1000.0};
+        const double duration {static_cast<double>(Clock::ticksToNanoseconds(static_cast<cfg::int64>(record.event.end - record.event.begin))) / 1000.0};
+        file << (first ? "\n" : ",\n") << "{\"name\": \"";
+        writeEscaped(file, record.event.name);
+        file << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << record.thread << ", \"ts\": " << timestamp << ", \"dur\": " << duration << "}";
+        first = false;
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace sys
@@ -22,24 +22,25 @@
  ********************************************************************************/
 
 #include <system/timer.hpp>
+#include <system/clock.hpp>
+#include <system/perfCounters.hpp>
 
-#include <chrono>
 #include <iostream>
 
-#include "timerPlatform.hpp"
-
 namespace sys
 {
 Timer::Timer(const bool t_debugMode, const float t_period)
-    : m_start           {plat::getTime().getRawTimeCount()},
-      m_currentStart    {plat::getTime().getRawTimeCount()},
-      m_lastTime        {plat::getTime().getRawTimeCount()},
+    : m_start           {Clock::now().getRawTimeCount()},
+      m_currentStart    {m_start},
+      m_lastTime        {m_start},
       m_deltaTime       {0.0f},
       m_currentTime     {0.0f},
       m_totalFrames     {0},
       m_framesPerSecond {0},
       m_period          {t_period},
-      m_debugMode       {t_debugMode}
+      m_debugMode       {t_debugMode},
+      m_frameStats      {},
+      m_timerWheel      {}
 {
 }
 
@@ -49,25 +50,34 @@ Timer::~Timer()
 
 void Timer::tick()
 {
-    m_currentTime = procCurrentElapsedTime();
-    m_deltaTime = procDeltaTime();
+    const Time now {Clock::now()};
+    const cfg::nanoT frameTime {now.getRawTimeCount() - m_lastTime};
+    m_frameStats.recordFrame(frameTime);
+#if defined(C__CURLY_PROFILER)
+    PerfCounters::endFrame();
+#endif
+    m_currentTime = procCurrentElapsedTime(now);
+    m_deltaTime = procDeltaTime(now);
+    m_timerWheel.advance(nanoseconds(frameTime));
     ++m_framesPerSecond;
     ++m_totalFrames;
     if(m_currentTime >= m_period)
     {
         if(m_debugMode)
         {
-            std::cout << m_framesPerSecond << " fps" << std::endl;
+            const FrameStatsSummary summary {m_frameStats.getSummary()};
+            std::cout << m_framesPerSecond << " fps, p99 " << summary.cpu.p99Ms << " ms, " << summary.hitchCount << " hitches" << std::endl;
         }
-        m_currentStart    = plat::getTime().getRawTimeCount();
+        m_currentStart    = now.getRawTimeCount();
         m_framesPerSecond = 0;
     }
 }
 
 void Timer::restart()
 {
-    m_lastTime = m_currentStart = m_start = plat::getTime().getRawTimeCount();
+    m_lastTime = m_currentStart = m_start = Clock::now().getRawTimeCount();
     m_framesPerSecond = m_totalFrames = 0;
+    m_frameStats.reset();
 }
 
 cfg::secT Timer::getDeltaTime()
@@ -85,24 +95,31 @@ cfg::uint32 Timer::getFramesPerSecond()
     return m_framesPerSecond;
 }
 
-cfg::secT Timer::procDeltaTime()
+FrameStats& Timer::getFrameStats()
+{
+    return m_frameStats;
+}
+
+TimerWheel& Timer::getTimerWheel()
+{
+    return m_timerWheel;
+}
+
+cfg::secT Timer::procDeltaTime(const Time& t_now)
 {
-    Time currentTime {plat::getTime()};
-    cfg::secT deltaTime {(currentTime - rawTimeBuilder(m_lastTime)).asSeconds()};
-    m_lastTime = currentTime.getRawTimeCount();
+    cfg::secT deltaTime {(t_now - rawTimeBuilder(m_lastTime)).asSeconds()};
+    m_lastTime = t_now.getRawTimeCount();
     return deltaTime;
 }
 
-cfg::secT Timer::procTotalElapsedTime()
+cfg::secT Timer::procTotalElapsedTime(const Time& t_now)
 {
-    Time currentTime {plat::getTime()};
-    return (currentTime - rawTimeBuilder(m_start)).asSeconds();
+    return (t_now - rawTimeBuilder(m_start)).asSeconds();
 }
 
-cfg::secT Timer::procCurrentElapsedTime()
+cfg::secT Timer::procCurrentElapsedTime(const Time& t_now)
 {
-    Time currentTime {plat::getTime()};
-    return (currentTime - rawTimeBuilder(m_currentStart)).asSeconds();
+    return (t_now - rawTimeBuilder(m_currentStart)).asSeconds();
 }
 
 } // namespace sys
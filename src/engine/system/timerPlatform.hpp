@@ -33,7 +33,8 @@ namespace sys
 namespace plat
 {
 /**
- * @brief Get the current Time
+ * @brief Get the current Time from the platform monotonic clock
+ * (CLOCK_MONOTONIC_RAW on linux, QueryPerformanceCounter on win32)
  * 
  * @return Time 
  */
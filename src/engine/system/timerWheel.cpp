@@ -0,0 +1,293 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <system/timerWheel.hpp>
+
+#include <algorithm>
+
+#define CURLY_TIMER_WHEEL_NIL 0xFFFFFFFFu
+
+namespace sys
+{
+TimerWheel::TimerWheel(const Time& t_resolution)
+    : m_nodes        {},
+      m_freeNodes    {},
+      m_slots        {std::vector<cfg::uint32>(CURLY_TIMER_WHEEL_LEVELS * CURLY_TIMER_WHEEL_SLOTS, CURLY_TIMER_WHEEL_NIL)},
+      m_resolution   {std::max<cfg::nanoT>(t_resolution.asNanoseconds(), 1)},
+      m_remainder    {0},
+      m_now          {0},
+      m_pendingCount {0}
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+TimerHandle TimerWheel::schedule(const Time& t_delay, Callback t_callback, const Time& t_period)
+{
+    cfg::uint32 index {};
+    if(!m_freeNodes.empty())
+    {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<cfg::uint32>(m_nodes.size());
+        m_nodes.push_back({});
+        m_nodes.back().generation = 1;
+    }
+
+    // Round up so a timer never fires early, and at least on the next tick
+    const cfg::nanoT delay {std::max<cfg::nanoT>(t_delay.asNanoseconds(), 0)};
+    const cfg::nanoT period {std::max<cfg::nanoT>(t_period.asNanoseconds(), 0)};
+    const cfg::uint64 delayTicks {std::max<cfg::uint64>(static_cast<cfg::uint64>((delay + m_resolution - 1) / m_resolution), 1u)};
+    const cfg::uint64 periodTicks {period > 0 ? std::max<cfg::uint64>(static_cast<cfg::uint64>((period + m_resolution - 1) / m_resolution), 1u) : 0u};
+
+    TimerNode& node {m_nodes[index]};
+    node.callback = std::move(t_callback);
+    node.expires  = m_now + delayTicks;
+    node.period   = periodTicks;
+    node.state    = TIMER_PENDING;
+    insert(index);
+    ++m_pendingCount;
+
+    return (static_cast<TimerHandle>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(const TimerHandle t_handle)
+{
+    TimerNode* node {getNode(t_handle)};
+    if(node == nullptr)
+    {
+        return false;
+    }
+
+    const cfg::uint32 index {static_cast<cfg::uint32>(t_handle & 0xFFFFFFFFu)};
+    switch(node->state)
+    {
+        case TIMER_PENDING:
+            unlink(index);
+            release(index);
+            --m_pendingCount;
+            return true;
+
+        case TIMER_FIRING:
+            // Released once its callback returns, a repeating timer just stops
+            node->state = TIMER_CANCELLED;
+            return node->period > 0;
+
+        default:
+            return false;
+    }
+}
+
+bool TimerWheel::isPending(const TimerHandle t_handle) const
+{
+    const TimerNode* node {const_cast<TimerWheel*>(this)->getNode(t_handle)};
+    if(node == nullptr)
+    {
+        return false;
+    }
+    return (node->state == TIMER_PENDING) || (node->state == TIMER_FIRING && node->period > 0);
+}
+
+cfg::uint32 TimerWheel::advance(const Time& t_elapsed)
+{
+    const cfg::nanoT total {m_remainder + std::max<cfg::nanoT>(t_elapsed.asNanoseconds(), 0)};
+    cfg::uint64 ticks {static_cast<cfg::uint64>(total / m_resolution)};
+    m_remainder = total % m_resolution;
+
+    cfg::uint32 fired {0};
+    while(ticks > 0)
+    {
+        if(m_pendingCount == 0)
+        {
+            // Nothing can come due, jump straight to the end
+            m_now += ticks;
+            break;
+        }
+        fired += tick();
+        --ticks;
+    }
+    return fired;
+}
+
+void TimerWheel::clear()
+{
+    for(cfg::uint32 i = 0; i < m_nodes.size(); ++i)
+    {
+        if(m_nodes[i].state == TIMER_PENDING)
+        {
+            release(i);
+        }
+        else if(m_nodes[i].state == TIMER_FIRING)
+        {
+            m_nodes[i].state = TIMER_CANCELLED;
+        }
+    }
+    std::fill(m_slots.begin(), m_slots.end(), CURLY_TIMER_WHEEL_NIL);
+    m_pendingCount = 0;
+}
+
+Time TimerWheel::getCurrentTime() const
+{
+    return nanoseconds(static_cast<cfg::nanoT>(m_now) * m_resolution + m_remainder);
+}
+
+cfg::uint64 TimerWheel::getPendingCount() const
+{
+    return m_pendingCount;
+}
+
+TimerWheel::TimerNode* TimerWheel::getNode(const TimerHandle t_handle)
+{
+    const cfg::uint64 index {t_handle & 0xFFFFFFFFu};
+    const cfg::uint32 generation {static_cast<cfg::uint32>(t_handle >> 32)};
+    if(index >= m_nodes.size() || m_nodes[index].generation != generation || m_nodes[index].state == TIMER_FREE)
+    {
+        return nullptr;
+    }
+    return &m_nodes[index];
+}
+
+void TimerWheel::insert(const cfg::uint32 t_index)
+{
+    constexpr cfg::uint64 maxDelta {(1ull << (CURLY_TIMER_WHEEL_LEVELS * CURLY_TIMER_WHEEL_SLOT_BITS)) - 1u};
+
+    TimerNode& node {m_nodes[t_index]};
+    const cfg::uint64 delta {node.expires > m_now ? node.expires - m_now : 0u};
+    // Timers past the last level wait in it and are placed again when it cascades
+    const cfg::uint64 placement {m_now + std::min(delta, maxDelta)};
+
+    cfg::uint32 level {0};
+    while(level + 1 < CURLY_TIMER_WHEEL_LEVELS && delta >= (1ull << ((level + 1) * CURLY_TIMER_WHEEL_SLOT_BITS)))
+    {
+        ++level;
+    }
+    const cfg::uint32 slot {level * CURLY_TIMER_WHEEL_SLOTS + static_cast<cfg::uint32>((placement >> (level * CURLY_TIMER_WHEEL_SLOT_BITS)) & (CURLY_TIMER_WHEEL_SLOTS - 1u))};
+
+    node.slot = slot;
+    node.prev = CURLY_TIMER_WHEEL_NIL;
+    node.next = m_slots[slot];
+    if(node.next != CURLY_TIMER_WHEEL_NIL)
+    {
+        m_nodes[node.next].prev = t_index;
+    }
+    m_slots[slot] = t_index;
+}
+
+void TimerWheel::unlink(const cfg::uint32 t_index)
+{
+    TimerNode& node {m_nodes[t_index]};
+    if(node.prev != CURLY_TIMER_WHEEL_NIL)
+    {
+        m_nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        m_slots[node.slot] = node.next;
+    }
+    if(node.next != CURLY_TIMER_WHEEL_NIL)
+    {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = CURLY_TIMER_WHEEL_NIL;
+}
+
+void TimerWheel::release(const cfg::uint32 t_index)
+{
+    TimerNode& node {m_nodes[t_index]};
+    node.callback = nullptr;
+    node.state    = TIMER_FREE;
+    // Old handles stop matching, 0 is skipped so no handle equals CURLY_INVALID_TIMER
+    node.generation = (node.generation == 0xFFFFFFFFu) ? 1u : node.generation + 1u;
+    m_freeNodes.push_back(t_index);
+}
+
+void TimerWheel::cascade(const cfg::uint32 t_level)
+{
+    const cfg::uint32 slot {t_level * CURLY_TIMER_WHEEL_SLOTS + static_cast<cfg::uint32>((m_now >> (t_level * CURLY_TIMER_WHEEL_SLOT_BITS)) & (CURLY_TIMER_WHEEL_SLOTS - 1u))};
+    cfg::uint32 index {m_slots[slot]};
+    m_slots[slot] = CURLY_TIMER_WHEEL_NIL;
+    while(index != CURLY_TIMER_WHEEL_NIL)
+    {
+        const cfg::uint32 next {m_nodes[index].next};
+        insert(index);
+        index = next;
+    }
+}
+
+cfg::uint32 TimerWheel::tick()
+{
+    ++m_now;
+
+    // When a level wraps, the next slot of the level above is spread over the levels below
+    for(cfg::uint32 level = 1; level < CURLY_TIMER_WHEEL_LEVELS; ++level)
+    {
+        if(((m_now >> ((level - 1) * CURLY_TIMER_WHEEL_SLOT_BITS)) & (CURLY_TIMER_WHEEL_SLOTS - 1u)) != 0)
+        {
+            break;
+        }
+        cascade(level);
+    }
+
+    cfg::uint32 fired {0};
+    const cfg::uint32 slot {static_cast<cfg::uint32>(m_now & (CURLY_TIMER_WHEEL_SLOTS - 1u))};
+    while(m_slots[slot] != CURLY_TIMER_WHEEL_NIL)
+    {
+        const cfg::uint32 index {m_slots[slot]};
+        unlink(index);
+        if(m_nodes[index].expires > m_now)
+        {
+            // Parked in the last level beyond its range, not due yet
+            insert(index);
+            continue;
+        }
+
+        // The callback may schedule timers and grow the pool, so the node is reached by index afterwards
+        m_nodes[index].state = TIMER_FIRING;
+        Callback callback {std::move(m_nodes[index].callback)};
+        --m_pendingCount;
+        callback();
+        ++fired;
+
+        TimerNode& node {m_nodes[index]};
+        if(node.state == TIMER_FIRING && node.period > 0)
+        {
+            node.callback = std::move(callback);
+            node.expires  = m_now + node.period;
+            node.state    = TIMER_PENDING;
+            insert(index);
+            ++m_pendingCount;
+        }
+        else
+        {
+            release(index);
+        }
+    }
+    return fired;
+}
+
+} // namespace sys
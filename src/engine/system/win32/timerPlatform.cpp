@@ -25,12 +25,6 @@
 
 #include "../timerPlatform.hpp"
 
-#ifdef _WIN64
-    #define CURLY_GET_TICK_COUNT GetTickCount64
-#else
-    #define CURLY_GET_TICK_COUNT GetTickCount
-#endif
-
 namespace sys
 {
 namespace plat
@@ -42,7 +36,19 @@ namespace plat
  */
 Time getTime()
 {
-    return rawTimeBuilder(CURLY_GET_TICK_COUNT() * 1000ull);
+    static const cfg::int64 frequency {[]()
+    {
+        LARGE_INTEGER value {};
+        QueryPerformanceFrequency(&value);
+        return static_cast<cfg::int64>(value.QuadPart);
+    }()};
+
+    LARGE_INTEGER counter {};
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion so the multiplication can not overflow
+    const cfg::int64 ticks {static_cast<cfg::int64>(counter.QuadPart)};
+    return nanoseconds((ticks / frequency) * 1000000000ll + ((ticks % frequency) * 1000000000ll) / frequency);
 }
 
 } // namespace plat
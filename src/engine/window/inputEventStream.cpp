@@ -0,0 +1,133 @@
+/********************************************************************************
+ *                                                                              *
+ * Curly Engine                                                                 *
+ * Copyright (c) 2021-2024 Adrian Bedregal                                      *
+ *                                                                              *
+ * This software is provided 'as-is', without any express or implied            *
+ * warranty. In no event will the authors be held liable for any damages        *
+ * arising from the use of this software.                                       *
+ *                                                                              *
+ * Permission is granted to anyone to use this software for any purpose,        *
+ * including commercial applications, and to alter it and redistribute it       *
+ * freely, subject to the following restrictions:                               *
+ *                                                                              *
+ * 1. The origin of this software must not be misrepresented; you must not      *
+ *    claim that you wrote the original software. If you use this software      *
+ *    in a product, an acknowledgment in the product documentation would be     *
+ *    appreciated but is not required.                                          *
+ * 2. Altered source versions must be plainly marked as such, and must not be   *
+ *    misrepresented as being the original software.                            *
+ * 3. This notice may not be removed or altered from any source distribution.   *
+ *                                                                              *
+ ********************************************************************************/
+
+#include <window/inputEventStream.hpp>
+
+#include <system/clock.hpp>
+
+#include <algorithm>
+
+namespace wnd
+{
+NativeInputClock::NativeInputClock()
+    : m_offset         {0},
+      m_lastTime       {0},
+      m_nativeTime     {0},
+      m_lastNativeTime {0},
+      m_started        {false}
+{
+}
+
+sys::Time NativeInputClock::toTime(const cfg::uint32 t_nativeTime)
+{
+    const cfg::nanoT now {sys::Clock::now().asNanoseconds()};
+    if(!m_started)
+    {
+        m_nativeTime = t_nativeTime;
+        m_offset = now - static_cast<cfg::nanoT>(m_nativeTime) * 1000000;
+        m_lastTime = 0;
+        m_started = true;
+    }
+    else
+    {
+        // A signed delta unwraps the 32 bit counter and tolerates slightly out of order stamps
+        m_nativeTime += static_cast<cfg::int64>(static_cast<cfg::int32>(t_nativeTime - m_lastNativeTime));
+    }
+    m_lastNativeTime = t_nativeTime;
+
+    const cfg::nanoT nativeNs {static_cast<cfg::nanoT>(m_nativeTime) * 1000000};
+    m_offset = std::min(m_offset, now - nativeNs);
+    const cfg::nanoT time {std::max(std::min(nativeNs + m_offset, now), m_lastTime)};
+    m_lastTime = time;
+    return sys::nanoseconds(time);
+}
+
+InputEventStream::InputEventStream(const cfg::uint32 t_capacity)
+    : m_pending    {},
+      m_current    {},
+      m_frameTime  {},
+      m_totalCount {0}
+{
+    m_pending.reserve(t_capacity);
+    m_current.reserve(t_capacity);
+}
+
+InputEventStream::~InputEventStream()
+{
+}
+
+void InputEventStream::push(const TimedInputEvent& t_event)
+{
+    m_pending.push_back(t_event);
+}
+
+void InputEventStream::tick()
+{
+    m_current.swap(m_pending);
+    m_pending.clear();
+    m_totalCount += m_current.size();
+    m_frameTime = sys::Clock::now();
+}
+
+void InputEventStream::clear()
+{
+    m_pending.clear();
+    m_current.clear();
+}
+
+const std::vector<TimedInputEvent>& InputEventStream::getEvents() const
+{
+    return m_current;
+}
+
+InputEventStream::const_iterator InputEventStream::begin() const
+{
+    return m_current.begin();
+}
+
+InputEventStream::const_iterator InputEventStream::end() const
+{
+    return m_current.end();
+}
+
+cfg::uint32 InputEventStream::size() const
+{
+    return static_cast<cfg::uint32>(m_current.size());
+}
+
+bool InputEventStream::empty() const
+{
+    return m_current.empty();
+}
+
+sys::Time InputEventStream::getFrameTime() const
+{
+    return m_frameTime;
+}
+
+cfg::uint64 InputEventStream::getTotalCount() const
+{
+    return m_totalCount;
+}
+
+} // namespace wnd
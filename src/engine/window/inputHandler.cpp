@@ -23,112 +23,211 @@
 
 #include <window/inputHandler.hpp>
 
+#include <algorithm>
+
 namespace wnd
 {
+namespace
+{
+cfg::uint32 getBitIndex(const InputCode code)
+{
+    // Out of range codes land on the last word, which is never set
+    return std::min<cfg::uint32>(static_cast<cfg::uint32>(code), CURLY_INPUT_WORD_COUNT * 64u);
+}
+
+bool testBit(const InputBits& bits, const InputCode code)
+{
+    const cfg::uint32 index {getBitIndex(code)};
+    return (bits.words[index >> 6] >> (index & 63u)) & 1u;
+}
+
+void setBit(InputBits& bits, const InputCode code, const bool value)
+{
+    const cfg::uint32 index {getBitIndex(code)};
+    const cfg::uint64 mask {1ull << (index & 63u)};
+    bits.words[index >> 6] = value ? (bits.words[index >> 6] | mask) : (bits.words[index >> 6] & ~mask);
+}
+
+bool isAnySet(const InputBits& bits)
+{
+    cfg::uint64 any {0};
+    for(cfg::uint32 i = 0; i < CURLY_INPUT_WORD_COUNT; ++i)
+    {
+        any |= bits.words[i];
+    }
+    return any != 0;
+}
+
+InputBits makeMask(std::initializer_list<InputCode> codes)
+{
+    InputBits mask {};
+    for(const InputCode code : codes)
+    {
+        if(static_cast<cfg::uint32>(code) < CURLY_INPUT_CODE_COUNT)
+        {
+            setBit(mask, code, true);
+        }
+    }
+    return mask;
+}
+
+} // namespace
+
 InputHandler::InputHandler()
-    : m_keys         {new Map<InputCode, KeyInfo>},
-      m_mouseButtons {new Map<InputCode, MouseInfo>},
-      m_currentTime  {0}
+    : m_eventStream  {},
+      m_mousePos     {},
+      m_keys         {},
+      m_mouseButtons {}
 {
 }
 
 InputHandler::~InputHandler()
 {
-    delete m_keys;
-    delete m_mouseButtons;
 }
 
 void InputHandler::tick()
 {
-    ++m_currentTime;
+    m_eventStream.tick();
+    for(const TimedInputEvent& event : m_eventStream)
+    {
+        applyEvent(event);
+    }
+    tickState(m_keys);
+    tickState(m_mouseButtons);
+}
+
+bool InputHandler::onKeyDown(InputCode key) const
+{
+    return testBit(m_keys.down, key);
 }
 
-void InputHandler::initKey(InputCode key)
+bool InputHandler::onKeyTriggered(InputCode key) const
 {
-    (*m_keys)[key].event = InputEvent::KEY_RELEASED;
-    (*m_keys)[key].time = m_currentTime - 1;
+    return testBit(m_keys.pressed, key);
 }
 
-bool InputHandler::onKeyDown(InputCode key)
+bool InputHandler::onKeyUp(InputCode key) const
 {
-    if(m_keys->find(key) == m_keys->end())//if(!m_keys.contains(key))
-        initKey(key);
-    return ((*m_keys)[key].event == InputEvent::KEY_PRESSED);
+    return !testBit(m_keys.down, key);
 }
 
-bool InputHandler::onKeyTriggered(InputCode key)
+bool InputHandler::onKeyReleased(InputCode key) const
 {
-    return onKeyDown(key) && ((*m_keys)[key].time == m_currentTime);
+    return testBit(m_keys.released, key);
 }
 
-bool InputHandler::onKeyUp(InputCode key)
+bool InputHandler::onClick(InputCode button) const
 {
-    if(m_keys->find(key) == m_keys->end())//if(!m_keys.contains(key))
-        initKey(key);
-    return ((*m_keys)[key].event == InputEvent::KEY_RELEASED);
+    return testBit(m_mouseButtons.pressed, button);
 }
 
-bool InputHandler::onKeyReleased(InputCode key)
+bool InputHandler::onRelease(InputCode button) const
 {
-    return onKeyUp(key) && ((*m_keys)[key].time == m_currentTime);
+    return testBit(m_mouseButtons.released, button);
 }
 
-void InputHandler::updateKeyEvent(InputCode key, InputEvent event)
+bool InputHandler::onButtonDown(InputCode button) const
 {
-    if((*m_keys)[key].event != event)
-    {
-        (*m_keys)[key].event = event;
-        (*m_keys)[key].time = m_currentTime;
-    }
+    return testBit(m_mouseButtons.down, button);
+}
+
+bool InputHandler::onButtonUp(InputCode button) const
+{
+    return !testBit(m_mouseButtons.down, button);
+}
+
+bool InputHandler::onAnyKeyDown() const
+{
+    return isAnySet(m_keys.down);
+}
+
+bool InputHandler::onAnyKeyTriggered() const
+{
+    return isAnySet(m_keys.pressed);
 }
 
-void InputHandler::initButton(InputCode button)
+bool InputHandler::onChordDown(std::initializer_list<InputCode> keys) const
 {
-    (*m_mouseButtons)[button].event = InputEvent::BUTTON_RELEASED;
-    (*m_mouseButtons)[button].time = m_currentTime - 1;
+    const InputBits mask {makeMask(keys)};
+    cfg::uint64 missing {0};
+    for(cfg::uint32 i = 0; i < CURLY_INPUT_WORD_COUNT; ++i)
+    {
+        missing |= mask.words[i] & ~m_keys.down.words[i];
+    }
+    return isAnySet(mask) && (missing == 0);
 }
 
-bool InputHandler::onClick(InputCode button)
+bool InputHandler::onChordTriggered(std::initializer_list<InputCode> keys) const
 {
-    return onButtonDown(button) && ((*m_mouseButtons)[button].time == m_currentTime);
+    const InputBits mask {makeMask(keys)};
+    cfg::uint64 missing {0};
+    cfg::uint64 pressed {0};
+    for(cfg::uint32 i = 0; i < CURLY_INPUT_WORD_COUNT; ++i)
+    {
+        missing |= mask.words[i] & ~m_keys.down.words[i];
+        pressed |= mask.words[i] & m_keys.pressed.words[i];
+    }
+    return (pressed != 0) && (missing == 0);
 }
 
-bool InputHandler::onRelease(InputCode button)
+math::Vec2i InputHandler::getMousePos() const
 {
-    return onButtonUp(button) && ((*m_mouseButtons)[button].time == m_currentTime);
+    return m_mousePos;
 }
 
-bool InputHandler::onButtonDown(InputCode button)
+const InputEventStream& InputHandler::getEventStream() const
 {
-    if(m_mouseButtons->find(button) == m_mouseButtons->end())//if(!m_mouseButtons.contains(button))
-        initButton(button);
-    return ((*m_mouseButtons)[button].event == InputEvent::BUTTON_PRESSED);
+    return m_eventStream;
 }
 
-bool InputHandler::onButtonUp(InputCode button)
+void InputHandler::pushEvent(const TimedInputEvent& event)
 {
-    if(m_mouseButtons->find(button) == m_mouseButtons->end())//if(!m_mouseButtons.contains(button))
-        initButton(button);
-    return ((*m_mouseButtons)[button].event == InputEvent::BUTTON_RELEASED);
+    m_eventStream.push(event);
 }
 
-void InputHandler::updateMouseEvent(InputCode button, InputEvent event)
+void InputHandler::applyEvent(const TimedInputEvent& event)
 {
-    if((*m_mouseButtons)[button].event != event)
+    switch(event.event)
     {
-        (*m_mouseButtons)[button].event = event;
-        (*m_mouseButtons)[button].time = m_currentTime;
+        case KEY_PRESSED:
+        case KEY_RELEASED:
+            updateState(m_keys, event.code, event.event == KEY_PRESSED);
+            break;
+
+        case BUTTON_PRESSED:
+        case BUTTON_RELEASED:
+            updateState(m_mouseButtons, event.code, event.event == BUTTON_PRESSED);
+            break;
+
+        case MOUSE_MOVE:
+            m_mousePos = event.pos;
+            break;
+
+        default:
+            break;
     }
 }
 
-void InputHandler::updateMousePosition(math::Vec2i position)
+void InputHandler::updateState(InputState& state, InputCode code, bool down)
 {
-    m_mousePos = position;
+    if(static_cast<cfg::uint32>(code) >= CURLY_INPUT_CODE_COUNT || testBit(state.down, code) == down)
+    {
+        return;
+    }
+    setBit(state.down, code, down);
+    setBit(down ? state.pressEvents : state.releaseEvents, code, true);
 }
 
-math::Vec2i InputHandler::getMousePos()
+void InputHandler::tickState(InputState& state)
 {
-    return m_mousePos;
+    // A press and a release within one frame show up in both masks, so taps are never lost
+    for(cfg::uint32 i = 0; i < CURLY_INPUT_WORD_COUNT; ++i)
+    {
+        state.pressed.words[i]       = state.pressEvents.words[i];
+        state.released.words[i]      = state.releaseEvents.words[i];
+        state.pressEvents.words[i]   = 0;
+        state.releaseEvents.words[i] = 0;
+    }
 }
 
 } // namespace wnd
@@ -23,6 +23,9 @@
 
 #include "windowManagerPlatform.hpp"
 
+#include <system/clock.hpp>
+#include <system/profiler.hpp>
+
 #include <cstring>
 #include <iostream>
 
@@ -53,6 +56,7 @@ const int WindowManager::s_glxAttribs[ATTRIB_LIST_SIZE]
 int WindowManager::s_keyCodesMap[NUM_KEYS_SIZE] {};
 int WindowManager::s_keyPhysicStates[NUM_KEYS_SIZE] {};
 int WindowManager::s_mouseButtonsMap[NUM_BUTTONS_SIZE] {};
+NativeInputClock WindowManager::s_inputClock {};
 
 XEvent WindowManager::s_event {};
 XkbDescPtr WindowManager::s_kbDesc {nullptr};
@@ -64,6 +68,7 @@ int WindowManager::s_fbCount {0};
 GLXFBConfig* WindowManager::s_fbConfigs {nullptr};
 
 bool WindowManager::s_vSyncCompat {true};
+bool WindowManager::s_adaptiveVSyncCompat {false};
 bool WindowManager::s_attribCtxCompat {true};
 int WindowManager::s_glxCtxVersionMajorCompat {4};
 int WindowManager::s_glxCtxVersionMinorCompat {6};
@@ -73,11 +78,14 @@ PFNGLXCREATECONTEXTATTRIBSARBPROC WindowManager::glXCreateContextAttribsARB {nul
 bool WindowManager::glXSwapIntervalEXTMode {false};
 PFNGLXSWAPINTERVALPROC1 WindowManager::glXSwapInterval1 {nullptr};
 PFNGLXSWAPINTERVALPROC2 WindowManager::glXSwapInterval2 {nullptr};
+PFNGLXGETMSCRATEOMLPROC WindowManager::glXGetMscRateOML {nullptr};
 
 WindowManager* WindowManager::createInstance()
 {
     if(!s_wmInstanceCount)
     {
+        // Xlib must be thread-safe before the display is opened, the render thread swaps on it
+        XInitThreads();
         s_display = XOpenDisplay(nullptr);
         s_screen = DefaultScreenOfDisplay(s_display);
         s_screenID = DefaultScreen(s_display);
@@ -197,6 +205,7 @@ void WindowManager::setEventCallbackFunction(IWindow* t_windowCallbackInstance,
 
 void WindowManager::pollEvents()
 {
+    CURLY_PROFILE_SCOPE("WindowManager::pollEvents");
     if(s_activeSessions)
     {
         XPending(s_display);
@@ -214,23 +223,62 @@ void WindowManager::pollEvents()
 
 void WindowManager::swapBuffers()
 {
+    CURLY_PROFILE_SCOPE("WindowManager::swapBuffers");
     if(m_active)
     {
-        if(s_vSyncCompat)
-        {
-            if(glXSwapIntervalEXTMode)
-            {
-                glXSwapInterval1(glXGetCurrentDisplay(), glXGetCurrentDrawable(), 1);
-            }
-            else
-            {
-                glXSwapInterval2(1);
-            }
-        }
         glXSwapBuffers(s_display, m_windowHandle);
     }
 }
 
+void WindowManager::makeContextCurrent()
+{
+    if(m_active)
+    {
+        glXMakeCurrent(s_display, m_windowHandle, m_context);
+    }
+}
+
+void WindowManager::releaseContext()
+{
+    glXMakeCurrent(s_display, None, nullptr);
+}
+
+void WindowManager::setSwapInterval(const int interval)
+{
+    if(!s_vSyncCompat)
+    {
+        return;
+    }
+
+    // Negative intervals mean adaptive sync, which needs the tear extension
+    const int effectiveInterval {(interval < 0 && !s_adaptiveVSyncCompat) ? -interval : interval};
+    if(glXSwapIntervalEXTMode)
+    {
+        glXSwapInterval1(s_display, m_windowHandle, effectiveInterval);
+    }
+    else
+    {
+        glXSwapInterval2(effectiveInterval < 0 ? -effectiveInterval : effectiveInterval);
+    }
+}
+
+float WindowManager::getRefreshRate()
+{
+    if(glXGetMscRateOML == nullptr)
+    {
+        return 0.0f;
+    }
+
+    // The media stream counter advances once per vertical retrace, its rate is the refresh rate
+    int32_t numerator {0};
+    int32_t denominator {0};
+    if(!glXGetMscRateOML(s_display, m_windowHandle, &numerator, &denominator) || denominator <= 0)
+    {
+        return 0.0f;
+    }
+    return static_cast<float>(numerator) / static_cast<float>(denominator);
+}
+
 WindowManager::WindowManager(const cfg::uint32 t_index)
     : m_active      {false},
       m_index       {t_index}
@@ -276,6 +324,14 @@ void WindowManager::createContext()
 	glXMakeCurrent(s_display, m_windowHandle, m_context);
 
     gladLoadGL();
+    // GL_ARB_buffer_storage uses the core entry point name, which the loader only fetches on 4.4 contexts
+    if(glad_glBufferStorage == nullptr)
+    {
+        glad_glBufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(glXGetProcAddressARB(reinterpret_cast<const GLubyte*>("glBufferStorage")));
+    }
+
+    // V-Sync stays the default until a frame pacer asks for something else
+    setSwapInterval(1);
 
     std::cout << "Context Created" << std::endl;
 }
@@ -527,7 +583,13 @@ void WindowManager::loadGLExtensions()
         glXSwapIntervalEXTMode = true;
         glXSwapInterval1 = (PFNGLXSWAPINTERVALPROC1)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalEXT");
         std::cout << "EXT Swap Control supported\n\n";
+        s_adaptiveVSyncCompat = isExtensionSupported(glxExtensions, "GLX_EXT_swap_control_tear");
 	}
+
+    if(isExtensionSupported(glxExtensions, "GLX_OML_sync_control"))
+    {
+        glXGetMscRateOML = (PFNGLXGETMSCRATEOMLPROC)glXGetProcAddressARB((const GLubyte*)"glXGetMscRateOML");
+    }
 }
 
 GLXFBConfig WindowManager::chooseBestFBC()
@@ -616,6 +678,13 @@ bool WindowManager::isExtensionSupported(const char* extList, const char* extens
 	return false;
 }
 
+void WindowManager::stampParams(WindowParams& params, const cfg::uint32 nativeTime)
+{
+    // Events synthesized by us carry no native stamp, they happen now
+    params.nativeTime = nativeTime;
+    params.time = nativeTime != 0 ? s_inputClock.toTime(nativeTime) : sys::Clock::now();
+}
+
 void WindowManager::CurlyProc()
 {
     switch(s_event.type)
@@ -650,6 +719,7 @@ void WindowManager::CurlyProc()
                         s_keyPhysicStates[i] = 0;
                         KeyboardParams params;
                         params.code = static_cast<InputCode>(s_keyCodesMap[i]);
+                        stampParams(params, 0);
                         windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_RELEASED, &params);
                     }
                 }
@@ -662,6 +732,7 @@ void WindowManager::CurlyProc()
                 MouseParams params;
                 params.pos.x = s_event.xmotion.x;
                 params.pos.y = s_event.xmotion.y;
+                stampParams(params, static_cast<cfg::uint32>(s_event.xmotion.time));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, MOUSE_MOVE, &params);
             }
             break;
@@ -671,6 +742,7 @@ void WindowManager::CurlyProc()
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[s_event.xany.window]];
                 KeyboardParams params;
                 params.code = static_cast<InputCode>(s_keyCodesMap[s_event.xkey.keycode]);
+                stampParams(params, static_cast<cfg::uint32>(s_event.xkey.time));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_PRESSED, &params);
                 s_keyPhysicStates[s_event.xkey.keycode] = 1;
             }
@@ -682,6 +754,7 @@ void WindowManager::CurlyProc()
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[s_event.xany.window]];
                 KeyboardParams params;
                 params.code = static_cast<InputCode>(s_keyCodesMap[s_event.xkey.keycode]);
+                stampParams(params, static_cast<cfg::uint32>(s_event.xkey.time));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_RELEASED, &params);
             }
             break;
@@ -691,6 +764,7 @@ void WindowManager::CurlyProc()
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[s_event.xany.window]];
                 MouseParams params;
                 params.code = static_cast<InputCode>(s_mouseButtonsMap[s_event.xbutton.button]);
+                stampParams(params, static_cast<cfg::uint32>(s_event.xbutton.time));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_PRESSED, &params);
             }
             break;
@@ -700,6 +774,7 @@ void WindowManager::CurlyProc()
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[s_event.xany.window]];
                 MouseParams params;
                 params.code = static_cast<InputCode>(s_mouseButtonsMap[s_event.xbutton.button]);
+                stampParams(params, static_cast<cfg::uint32>(s_event.xbutton.time));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &params);
             }
             break;
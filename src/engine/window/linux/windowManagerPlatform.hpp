@@ -37,6 +37,7 @@
 
 #include <window/compatUtils.hpp>
 #include <window/inputEvents.hpp>
+#include <window/inputEventStream.hpp>
 #include "window/windowParams.hpp"
 #include <window/inputBindings.hpp>
 #include <window/customization.hpp>
@@ -83,6 +84,12 @@ public:
     void pollEvents();
     void swapBuffers();
 
+    void makeContextCurrent();
+    void releaseContext();
+
+    void setSwapInterval(const int interval);
+    float getRefreshRate();
+
 private:
     bool m_active;
 
@@ -126,6 +133,7 @@ private:
     static int s_keyCodesMap[NUM_KEYS_SIZE];
     static int s_keyPhysicStates[NUM_KEYS_SIZE];
     static int s_mouseButtonsMap[NUM_BUTTONS_SIZE];
+    static NativeInputClock s_inputClock;
 
     static XEvent s_event;
     static XkbDescPtr s_kbDesc;
@@ -137,6 +145,7 @@ private:
     static GLXFBConfig* s_fbConfigs;
 
     static bool s_vSyncCompat;
+    static bool s_adaptiveVSyncCompat;
     static bool s_attribCtxCompat;
     static int s_glxCtxVersionMajorCompat;
     static int s_glxCtxVersionMinorCompat;
@@ -146,6 +155,7 @@ private:
     static bool glXSwapIntervalEXTMode;
     static PFNGLXSWAPINTERVALPROC1 glXSwapInterval1;
     static PFNGLXSWAPINTERVALPROC2 glXSwapInterval2;
+    static PFNGLXGETMSCRATEOMLPROC glXGetMscRateOML;
 
     static void internalSetGlxContextVersion(const int major, const int minor);
 
@@ -159,6 +169,7 @@ private:
 
     static bool isExtensionSupported(const char* extList, const char* extension);
 
+    static void stampParams(WindowParams& params, const cfg::uint32 nativeTime);
     static void CurlyProc();
 
     /* Deleted Constructors and assignment */
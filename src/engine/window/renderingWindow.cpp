@@ -34,7 +34,9 @@
 namespace wnd
 {
 RenderingWindow::RenderingWindow(const cfg::uint32 t_width, const cfg::uint32 t_height, const char* t_title, WindowStyle t_style, InputHandler* t_inputHandler)
-    : IWindow     {t_width, t_height, t_title, t_style, t_inputHandler}
+    : IWindow              {t_width, t_height, t_title, t_style, t_inputHandler},
+      m_framePacer         {nullptr},
+      m_presentModeVersion {0}
 {
     m_windowManager = WindowManager::createInstance();
     m_windowManager->setEventCallbackFunction(this, eventCallback);
@@ -86,14 +88,66 @@ void RenderingWindow::setInputHandler(InputHandler& t_inputHandler)
 
 void RenderingWindow::pollEvents()
 {
+    if(m_framePacer != nullptr)
+        m_framePacer->beginFrame();
+    m_windowManager->pollEvents();
+    // The edge masks cover every event polled since the previous frame
     if(m_inputHandler != nullptr)
         m_inputHandler->tick();
-    m_windowManager->pollEvents();
 }
 
 void RenderingWindow::swapBuffers()
 {
+    if(m_framePacer == nullptr)
+    {
+        m_windowManager->swapBuffers();
+        return;
+    }
+
+    // The swap interval is context state, it only has to be set when the mode changes
+    if(m_presentModeVersion != m_framePacer->getPresentModeVersion())
+    {
+        switch(m_framePacer->getPresentMode())
+        {
+            case sys::PRESENT_IMMEDIATE:
+                m_windowManager->setSwapInterval(0);
+                break;
+
+            case sys::PRESENT_VSYNC:
+                m_windowManager->setSwapInterval(1);
+                break;
+
+            case sys::PRESENT_ADAPTIVE_VSYNC:
+                m_windowManager->setSwapInterval(-1);
+                break;
+        }
+        m_presentModeVersion = m_framePacer->getPresentModeVersion();
+        m_framePacer->setRefreshRate(m_windowManager->getRefreshRate());
+    }
+
+    m_framePacer->endFrame();
     m_windowManager->swapBuffers();
+    if(m_framePacer->isLowLatency())
+    {
+        // Draining the queue keeps the driver from buffering frames ahead of the display
+        glFinish();
+    }
+}
+
+void RenderingWindow::setFramePacer(sys::FramePacer& t_framePacer)
+{
+    m_framePacer = &t_framePacer;
+    m_presentModeVersion = 0;
+}
+
+void RenderingWindow::makeContextCurrent()
+{
+    m_windowManager->makeContextCurrent();
+}
+
+void RenderingWindow::releaseContext()
+{
+    m_windowManager->releaseContext();
 }
 
 float RenderingWindow::getAspectRatio() const
@@ -129,31 +183,33 @@ void RenderingWindow::eventCallback(IWindow* window, InputEvent event, WindowPar
     RenderingWindow* rWindow{ static_cast<RenderingWindow*>(window) };
     if(rWindow->m_inputHandler != nullptr)
     {
+        TimedInputEvent timedEvent {event, UNKNOWN_INPUT_CODE, {}, params->time, params->nativeTime};
         switch(event)
         {
             case KEY_PRESSED:
             case KEY_RELEASED:
                 {
-                    rWindow->m_inputHandler->updateKeyEvent(static_cast<KeyboardParams*>(params)->code, event);
+                    timedEvent.code = static_cast<KeyboardParams*>(params)->code;
                 }
                 break;
 
             case BUTTON_PRESSED:
             case BUTTON_RELEASED:
                 {
-                    rWindow->m_inputHandler->updateMouseEvent(static_cast<MouseParams*>(params)->code, event);
+                    timedEvent.code = static_cast<MouseParams*>(params)->code;
                 }
                 break;
 
             case MOUSE_MOVE:
                 {
-                    rWindow->m_inputHandler->updateMousePosition(static_cast<MouseParams*>(params)->pos);
+                    timedEvent.pos = static_cast<MouseParams*>(params)->pos;
                 }
                 break;
 
             default:
-                break;
+                return;
         }
+        rWindow->m_inputHandler->pushEvent(timedEvent);
     }
 }
 
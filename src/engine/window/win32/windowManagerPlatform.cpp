@@ -23,6 +23,9 @@
 
 #include "windowManagerPlatform.hpp"
 
+#include <system/clock.hpp>
+#include <system/profiler.hpp>
+
 #include <window/inputBindings.hpp>
 
 #include <iostream>
@@ -54,12 +57,14 @@ const int WindowManager::s_attribs[ATTRIB_LIST_SIZE]
 
 int WindowManager::s_mouseTrackCount {0};
 int WindowManager::s_keyPhysicStates[NUM_KEYS_SIZE] {};
+NativeInputClock WindowManager::s_inputClock {};
 
 MSG WindowManager::s_msg {};
 HMODULE WindowManager::s_ogl32Module {nullptr};
 HINSTANCE WindowManager::s_procInstanceHandle {nullptr};
 
 bool WindowManager::s_vSyncCompat {true};
+bool WindowManager::s_adaptiveVSyncCompat {false};
 bool WindowManager::s_attribCtxCompat {true};
 bool WindowManager::s_pixelFormatCompat {true};
 
@@ -196,6 +201,7 @@ void WindowManager::setEventCallbackFunction(IWindow* t_windowCallbackInstance,
 
 void WindowManager::pollEvents()
 {
+    CURLY_PROFILE_SCOPE("WindowManager::pollEvents");
     if(PeekMessageW(&s_msg, nullptr, 0, 0, PM_REMOVE))
     {
         TranslateMessage(&s_msg);
@@ -205,16 +211,55 @@ void WindowManager::pollEvents()
 
 void WindowManager::swapBuffers()
 {
+    CURLY_PROFILE_SCOPE("WindowManager::swapBuffers");
     if(m_active)
     {
-        if(s_vSyncCompat)
-        {
-            wglSwapIntervalEXT(1);
-        }
         wglSwapLayerBuffers(m_deviceContextHandle, WGL_SWAP_MAIN_PLANE);
     }
 }
 
+void WindowManager::makeContextCurrent()
+{
+    if(m_active)
+    {
+        wglMakeCurrent(m_deviceContextHandle, m_glRenderingContextHandle);
+    }
+}
+
+void WindowManager::releaseContext()
+{
+    wglMakeCurrent(nullptr, nullptr);
+}
+
+void WindowManager::setSwapInterval(const int interval)
+{
+    if(s_vSyncCompat)
+    {
+        // Negative intervals mean adaptive sync, which needs the tear extension
+        wglSwapIntervalEXT((interval < 0 && !s_adaptiveVSyncCompat) ? -interval : interval);
+    }
+}
+
+float WindowManager::getRefreshRate()
+{
+    // Presents sync to the monitor the window is on, not to the primary one
+    MONITORINFOEXA monitorInfo {};
+    monitorInfo.cbSize = sizeof(MONITORINFOEXA);
+    if(!GetMonitorInfoA(MonitorFromWindow(m_windowHandle, MONITOR_DEFAULTTONEAREST), &monitorInfo))
+    {
+        return 0.0f;
+    }
+
+    DEVMODEA mode {};
+    mode.dmSize = sizeof(DEVMODEA);
+    // 0 and 1 stand for the hardware default rate, which is unknown
+    if(!EnumDisplaySettingsA(monitorInfo.szDevice, ENUM_CURRENT_SETTINGS, &mode) || mode.dmDisplayFrequency <= 1)
+    {
+        return 0.0f;
+    }
+    return static_cast<float>(mode.dmDisplayFrequency);
+}
+
 WindowManager::WindowManager(const cfg::uint32 t_index)
     : m_active                   {false},
       m_index                    {t_index},
@@ -374,6 +419,7 @@ void WindowManager::loadGLExtensions()
     {
         wglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC)wglGetProcAddress("wglSwapIntervalEXT");
         wglGetSwapIntervalEXT = (PFNWGLGETSWAPINTERVALEXTPROC)wglGetProcAddress("wglGetSwapIntervalEXT");
+        s_adaptiveVSyncCompat = isExtensionSupported(wglExtensions, "WGL_EXT_swap_control_tear");
     }
 
     wglMakeCurrent(ddc, nullptr);
@@ -454,6 +500,13 @@ void* WindowManager::CurlyGetProcAddress(const char* name)
     return gpa;
 }
 
+void WindowManager::stampParams(WindowParams& params, const cfg::uint32 nativeTime)
+{
+    // Events synthesized by us carry no native stamp, they happen now
+    params.nativeTime = nativeTime;
+    params.time = nativeTime != 0 ? s_inputClock.toTime(nativeTime) : sys::Clock::now();
+}
+
 LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch(uMsg)
@@ -500,6 +553,14 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 wglMakeCurrent(hdc, glContext);
 
                 gladLoadGL((GLADloadfunc)CurlyGetProcAddress);
+                // GL_ARB_buffer_storage uses the core entry point name, which the loader only fetches on 4.4 contexts
+                if(glad_glBufferStorage == nullptr)
+                {
+                    glad_glBufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(CurlyGetProcAddress("glBufferStorage"));
+                }
+
+                // V-Sync stays the default until a frame pacer asks for something else
+                windowInstance->setSwapInterval(1);
 
                 memset(s_keyPhysicStates, 0, sizeof(s_keyPhysicStates));
 
@@ -528,6 +589,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 KeyboardParams params;
                 params.code = static_cast<InputCode>(wParam);
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_PRESSED, &params);
                 s_keyPhysicStates[wParam] = 1;
             }
@@ -539,6 +601,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 KeyboardParams params;
                 params.code = static_cast<InputCode>(wParam);
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_RELEASED, &params);
             }
             break;
@@ -553,6 +616,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                         s_keyPhysicStates[i] = 0;
                         KeyboardParams params;
                         params.code = static_cast<InputCode>(i);
+                        stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                         windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, KEY_RELEASED, &params);
                     }
                 }
@@ -560,6 +624,8 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 MouseParams rparam;
                 lparam.code = InputCode::MOUSE_BUTTON_LEFT;
                 rparam.code = InputCode::MOUSE_BUTTON_RIGHT;
+                stampParams(lparam, static_cast<cfg::uint32>(GetMessageTime()));
+                stampParams(rparam, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &lparam);
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &rparam);
             }
@@ -572,6 +638,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_LEFT;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_PRESSED, &params);
             }
             break;
@@ -581,6 +648,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_LEFT;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &params);
                 if(!(--s_mouseTrackCount))
                     ReleaseCapture();
@@ -594,6 +662,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_RIGHT;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_PRESSED, &params);
             }
             break;
@@ -603,6 +672,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_RIGHT;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &params);
                 if(!(--s_mouseTrackCount))
                     ReleaseCapture();
@@ -616,6 +686,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_MIDDLE;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_PRESSED, &params);
             }
             break;
@@ -625,6 +696,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_MIDDLE;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &params);
                 if(!(--s_mouseTrackCount))
                     ReleaseCapture();
@@ -638,6 +710,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_04;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_PRESSED, &params);
             }
             break;
@@ -647,6 +720,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 WindowManager* windowInstance = s_wmInstances[(*s_hwndMap)[hWnd]];
                 MouseParams params;
                 params.code = InputCode::MOUSE_BUTTON_04;
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, BUTTON_RELEASED, &params);
                 if(!(--s_mouseTrackCount))
                     ReleaseCapture();
@@ -659,6 +733,7 @@ LRESULT CALLBACK WindowManager::CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, L
                 MouseParams params;
                 params.pos.x = GET_X_LPARAM(lParam);
                 params.pos.y = GET_Y_LPARAM(lParam);
+                stampParams(params, static_cast<cfg::uint32>(GetMessageTime()));
                 windowInstance->mf_eventCallbackFunction(windowInstance->m_windowCallbackInstance, MOUSE_MOVE, &params);
             }
             break;
@@ -40,6 +40,7 @@
 #define Map std::map
 
 #include <window/inputEvents.hpp>
+#include <window/inputEventStream.hpp>
 #include <window/windowParams.hpp>
 #include <window/customization.hpp>
 
@@ -70,6 +71,12 @@ public:
     void pollEvents();
     void swapBuffers();
 
+    void makeContextCurrent();
+    void releaseContext();
+
+    void setSwapInterval(const int interval);
+    float getRefreshRate();
+
 private:
     bool m_active;
 
@@ -108,12 +115,14 @@ private:
 
     static int s_mouseTrackCount;
     static int s_keyPhysicStates[NUM_KEYS_SIZE];
+    static NativeInputClock s_inputClock;
 
     static MSG s_msg;
     static HMODULE s_ogl32Module;
     static HINSTANCE s_procInstanceHandle;
 
     static bool s_vSyncCompat;
+    static bool s_adaptiveVSyncCompat;
     static bool s_attribCtxCompat;
     static bool s_pixelFormatCompat;
 
@@ -132,6 +141,7 @@ private:
     static PFNWGLGETSWAPINTERVALEXTPROC wglGetSwapIntervalEXT;
 
     static void* CurlyGetProcAddress(const char* name);
+    static void stampParams(WindowParams& params, const cfg::uint32 nativeTime);
     static LRESULT CALLBACK CurlyProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
     /* Deleted Constructors and assignment */